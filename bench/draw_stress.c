@@ -0,0 +1,362 @@
+/**
+ * @file draw_stress.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Stresses the draw job queue with many producer threads and reports
+ * how the throughput scales with the number of threads
+ *
+ * Producers issue a random mix of primitives, text, sprites and image
+ * loads/frees while the main thread consumes their jobs with
+ * gfxDrawUpdateScreen(). Each run lasts a fixed time and is repeated for
+ * 1, 2, 4, ... up to the maximum number of producers.
+ *
+ * By default no window is created, the library runs in split mode without a
+ * viewer, encoding each frame as it would for a viewer process. This needs no
+ * video device and no OpenGL, which the dummy video driver lacks. With -w the
+ * frames are instead rendered into a window.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <SDL2/SDL.h>
+
+#include "gfx_draw.h"
+#include "gfx_utils.h"
+
+#define MAX_PRODUCERS 64
+#define DEFAULT_PRODUCERS 8
+#define DEFAULT_RUN_MS 1000
+
+#define SPRITE_SIZE 16
+#define SPRITE_COLS 4
+#define SPRITE_ROWS 4
+
+/**
+ * @brief Per producer state, padded so that counting operations does not
+ * cause false sharing between producers
+ */
+struct producer {
+    pthread_t thread;
+    unsigned int seed;
+    unsigned long ops;
+    unsigned long errors;
+} __attribute__((aligned(64)));
+
+static struct producer producers[MAX_PRODUCERS];
+static char image_path[64];
+static char socket_path[64];
+static gfx_image_handle_t shared_image = NULL;
+static gfx_spritesheet_handle_t spritesheet = NULL;
+static unsigned char stop = 0;
+
+static unsigned long long _nowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+ * @brief Writes a small image, one coloured square per sprite, to be loaded
+ * and drawn by the producers
+ */
+static int _writeImage(const char *path)
+{
+    SDL_Surface *surface;
+    SDL_Rect rect = { .w = SPRITE_SIZE, .h = SPRITE_SIZE };
+    int ret = -1;
+    int i;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, SPRITE_SIZE * SPRITE_COLS,
+              SPRITE_SIZE * SPRITE_ROWS, 32,
+              SDL_PIXELFORMAT_RGBA8888);
+    if (surface == NULL) {
+        goto err_surface;
+    }
+
+    for (i = 0; i < SPRITE_COLS * SPRITE_ROWS; i++) {
+        rect.x = (i % SPRITE_COLS) * SPRITE_SIZE;
+        rect.y = (i / SPRITE_COLS) * SPRITE_SIZE;
+        SDL_FillRect(surface, &rect,
+                     SDL_MapRGBA(surface->format, 16 * i, 255 - 16 * i, 128,
+                                 255));
+    }
+
+    if (SDL_SaveBMP(surface, path) == 0) {
+        ret = 0;
+    }
+
+    SDL_FreeSurface(surface);
+err_surface:
+    return ret;
+}
+
+static int _drawOne(struct producer *producer)
+{
+    static char *strings[] = { "Stress", "gfxDrawText", "0123456789" };
+    coord_t points[4];
+    gfx_image_handle_t image;
+    unsigned int r = rand_r(&producer->seed);
+    signed short x = r % SCREEN_WIDTH, y = (r >> 10) % SCREEN_HEIGHT;
+    unsigned int colour = r & 0xFFFFFF;
+    int i, ret = 0;
+
+    switch ((r >> 20) % 10) {
+        case 0:
+            return gfxDrawFilledBox(x, y, 20, 10, colour);
+        case 1:
+            return gfxDrawCircle(x, y, 8, colour);
+        case 2:
+            return gfxDrawLine(x, y, y, x, 2, colour);
+        case 3:
+            for (i = 0; i < 4; i++) {
+                points[i].x = x + ((i & 1) ? 12 : 0);
+                points[i].y = y + ((i & 2) ? 12 : 0);
+            }
+            return gfxDrawFilledPoly(points, 4, colour);
+        case 4:
+            return gfxDrawArc(x, y, 12, 0, 270, colour);
+        case 5:
+            return gfxDrawText(strings[r % 3], x, y, colour);
+        case 6:
+            return gfxDrawSprite(spritesheet, r % SPRITE_COLS,
+                                 (r >> 2) % SPRITE_ROWS, x, y);
+        case 7:
+            return gfxDrawLoadedImage(shared_image, x, y);
+        case 8:
+            // The image is freed while its draw job is still queued
+            image = gfxDrawLoadImage(image_path);
+            if (image == NULL) {
+                return -1;
+            }
+            ret = gfxDrawLoadedImage(image, x, y);
+            if (gfxDrawFreeLoadedImage(&image)) {
+                ret = -1;
+            }
+            return ret;
+        default:
+            return gfxDrawSetGlobalXOffset(r % 3);
+    }
+}
+
+static void *_produce(void *arg)
+{
+    struct producer *producer = arg;
+
+    while (!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+        if (_drawOne(producer)) {
+            producer->errors++;
+        }
+        producer->ops++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Runs count producers for run_ms against the calling thread,
+ * which consumes their jobs
+ *
+ * @return Operations per second issued by all producers together, -1 if the
+ * producers could not be started
+ */
+static double _runProducers(unsigned int count, unsigned int run_ms,
+                            unsigned long *frames, unsigned long *errors)
+{
+    unsigned long long start, end, deadline;
+    unsigned long ops = 0;
+    unsigned int i, started;
+
+    __atomic_store_n(&stop, 0, __ATOMIC_RELAXED);
+    *frames = 0;
+    *errors = 0;
+
+    for (started = 0; started < count; started++) {
+        producers[started].seed = started + 1;
+        producers[started].ops = 0;
+        producers[started].errors = 0;
+        if (pthread_create(&producers[started].thread, NULL, _produce,
+                           &producers[started])) {
+            break;
+        }
+    }
+
+    start = _nowNs();
+    deadline = start + run_ms * 1000000ULL;
+
+    if (started == count) {
+        do {
+            if (gfxDrawUpdateScreen()) {
+                (*errors)++;
+            }
+            (*frames)++;
+        } while (_nowNs() < deadline);
+    }
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < started; i++) {
+        pthread_join(producers[i].thread, NULL);
+        ops += producers[i].ops;
+        *errors += producers[i].errors;
+    }
+    end = _nowNs();
+
+    // Jobs queued after the last frame are drawn outside of the measurement
+    gfxDrawUpdateScreen();
+
+    if (started != count) {
+        return -1;
+    }
+
+    return ops * 1e9 / (end - start);
+}
+
+static void _usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-t max_threads] [-d run_ms] [-w]\n"
+            "  -t  Maximum number of producer threads, default %d\n"
+            "  -d  Duration of each run in milliseconds, default %d\n"
+            "  -w  Render into a window instead of encoding frames\n",
+            name, DEFAULT_PRODUCERS, DEFAULT_RUN_MS);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int max_threads = DEFAULT_PRODUCERS;
+    unsigned int run_ms = DEFAULT_RUN_MS;
+    unsigned char windowed = 0;
+    unsigned long frames, errors, total_errors = 0;
+    double ops, base = 0;
+    unsigned int threads;
+    int opt, ret = EXIT_FAILURE;
+
+    while ((opt = getopt(argc, argv, "t:d:wh")) != -1) {
+        switch (opt) {
+            case 't':
+                max_threads = strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                run_ms = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                windowed = 1;
+                break;
+            default:
+                _usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (!max_threads || max_threads > MAX_PRODUCERS || !run_ms) {
+        _usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    snprintf(image_path, sizeof(image_path), "/tmp/draw_stress.%d.bmp",
+             (int)getpid());
+    snprintf(socket_path, sizeof(socket_path), "/tmp/draw_stress.%d.sock",
+             (int)getpid());
+
+    if (!windowed) {
+        gfxDrawSetViewerSocket(socket_path);
+    }
+
+    if (gfxDrawInit(argv[0])) {
+        fprintf(stderr, "gfxDrawInit failed, is RESOURCES_DIRECTORY set to "
+                "the emulator's resources?\n");
+        goto err_init;
+    }
+
+    if (_writeImage(image_path)) {
+        fprintf(stderr, "Failed to write %s: %s\n", image_path,
+                SDL_GetError());
+        goto err_image;
+    }
+
+    shared_image = gfxDrawLoadImage(image_path);
+    if (shared_image == NULL) {
+        goto err_load;
+    }
+
+    spritesheet = gfxDrawLoadSpritesheetFromEntireImageUnpadded(
+                      shared_image, SPRITE_COLS, SPRITE_ROWS);
+    if (spritesheet == NULL) {
+        goto err_spritesheet;
+    }
+
+    printf("%-8s %14s %8s %12s\n", "threads", "ops/s", "speedup",
+           "frames/s");
+
+    for (threads = 1;; threads *= 2) {
+        // The last run always uses the maximum number of producers
+        if (threads > max_threads) {
+            threads = max_threads;
+        }
+
+        ops = _runProducers(threads, run_ms, &frames, &errors);
+        if (ops < 0) {
+            fprintf(stderr, "Failed to start %u producers\n", threads);
+            goto err_run;
+        }
+
+        if (threads == 1) {
+            base = ops;
+        }
+        total_errors += errors;
+
+        printf("%-8u %14.0f %7.2fx %12.1f\n", threads, ops,
+               base ? ops / base : 0, frames * 1000.0 / run_ms);
+
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+#if (GFX_LOCK_PROFILING == 1)
+    gfxUtilLockStatsReport(stdout);
+#endif // GFX_LOCK_PROFILING
+
+    if (total_errors) {
+        fprintf(stderr, "%lu draw calls failed\n", total_errors);
+    }
+    else {
+        ret = EXIT_SUCCESS;
+    }
+
+err_run:
+err_spritesheet:
+    gfxDrawFreeLoadedImage(&shared_image);
+    gfxDrawUpdateScreen();
+err_load:
+    unlink(image_path);
+err_image:
+    gfxDrawExit();
+err_init:
+    if (!windowed) {
+        unlink(socket_path);
+    }
+    return ret;
+}
@@ -0,0 +1,355 @@
+/**
+ * @file freertos.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief The parts of the FreeRTOS kernel used by the library, implemented
+ * on top of pthreads for the benchmarks, see include/FreeRTOS.h
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#define NS_PER_TICK (1000000000L / configTICK_RATE_HZ)
+
+/**
+ * @brief A counter that can be waited on, backs both semaphores and task
+ * notifications
+ */
+struct counter {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+struct task {
+    pthread_t thread;
+    TaskFunction_t code;
+    void *params;
+    struct counter notify;
+};
+
+static __thread struct task *cur_task = NULL;
+static UBaseType_t task_count = 0;
+
+void *pvPortMalloc(size_t size)
+{
+    return malloc(size);
+}
+
+void vPortFree(void *ptr)
+{
+    free(ptr);
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    return 0;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    return 0;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (TickType_t)(now.tv_sec * configTICK_RATE_HZ +
+                        now.tv_nsec / NS_PER_TICK);
+}
+
+static void _initCounter(struct counter *counter, UBaseType_t count,
+                         UBaseType_t max)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&counter->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_init(&counter->lock, NULL);
+    counter->count = count;
+    counter->max = max;
+}
+
+static void _destroyCounter(struct counter *counter)
+{
+    pthread_cond_destroy(&counter->cond);
+    pthread_mutex_destroy(&counter->lock);
+}
+
+/**
+ * @brief Waits up to ticks for the counter to be non-zero
+ *
+ * @param clear Reset the counter to zero instead of decrementing it
+ * @return The counter's value before it was taken, 0 on timeout
+ */
+static UBaseType_t _takeCounter(struct counter *counter, TickType_t ticks,
+                                unsigned char clear)
+{
+    struct timespec deadline;
+    UBaseType_t ret = 0;
+    int err = 0;
+
+    if (ticks != portMAX_DELAY) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += ticks / configTICK_RATE_HZ;
+        deadline.tv_nsec += (ticks % configTICK_RATE_HZ) * NS_PER_TICK;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&counter->lock);
+
+    while (!counter->count && err != ETIMEDOUT && ticks) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&counter->cond, &counter->lock);
+        }
+        else {
+            err = pthread_cond_timedwait(&counter->cond, &counter->lock,
+                                         &deadline);
+        }
+    }
+
+    ret = counter->count;
+    if (ret) {
+        counter->count = clear ? 0 : counter->count - 1;
+    }
+
+    pthread_mutex_unlock(&counter->lock);
+
+    return ret;
+}
+
+static BaseType_t _giveCounter(struct counter *counter)
+{
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&counter->lock);
+    if (counter->count < counter->max) {
+        counter->count++;
+        pthread_cond_signal(&counter->cond);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&counter->lock);
+
+    return ret;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    struct counter *ret = malloc(sizeof(struct counter));
+
+    if (ret) {
+        _initCounter(ret, 1, 1);
+    }
+
+    return ret;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    struct counter *ret = malloc(sizeof(struct counter));
+
+    if (ret) {
+        _initCounter(ret, 0, 1);
+    }
+
+    return ret;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    if (xSemaphore) {
+        _destroyCounter(xSemaphore);
+        free(xSemaphore);
+    }
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore,
+                          TickType_t xBlockTime)
+{
+    return _takeCounter(xSemaphore, xBlockTime, 0) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    return _giveCounter(xSemaphore);
+}
+
+static void _taskCleanup(void *arg)
+{
+    struct task *task = arg;
+
+    _destroyCounter(&task->notify);
+    free(task);
+    __atomic_sub_fetch(&task_count, 1, __ATOMIC_RELAXED);
+}
+
+static void *_taskEntry(void *arg)
+{
+    cur_task = arg;
+
+    pthread_cleanup_push(_taskCleanup, arg);
+    cur_task->code(cur_task->params);
+    pthread_cleanup_pop(1);
+
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName,
+                       configSTACK_DEPTH_TYPE usStackDepth,
+                       void *pvParameters, UBaseType_t uxPriority,
+                       TaskHandle_t *pxCreatedTask)
+{
+    struct task *task;
+
+    (void)pcName;
+    (void)usStackDepth;
+    (void)uxPriority;
+
+    task = calloc(1, sizeof(struct task));
+    if (task == NULL) {
+        goto err_alloc;
+    }
+
+    task->code = pxTaskCode;
+    task->params = pvParameters;
+    _initCounter(&task->notify, 0, (UBaseType_t)UINT32_MAX);
+
+    // The handle must be valid before the task can delete itself
+    if (pxCreatedTask) {
+        *pxCreatedTask = task;
+    }
+
+    __atomic_add_fetch(&task_count, 1, __ATOMIC_RELAXED);
+
+    if (pthread_create(&task->thread, NULL, _taskEntry, task)) {
+        goto err_thread;
+    }
+    pthread_detach(task->thread);
+
+    return pdPASS;
+
+err_thread:
+    __atomic_sub_fetch(&task_count, 1, __ATOMIC_RELAXED);
+    if (pxCreatedTask) {
+        *pxCreatedTask = NULL;
+    }
+    _destroyCounter(&task->notify);
+    free(task);
+err_alloc:
+    return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    struct task *task = xTaskToDelete ? xTaskToDelete : cur_task;
+
+    if (task == NULL) {
+        return;
+    }
+
+    if (task == cur_task) {
+        pthread_exit(NULL);
+    }
+
+    pthread_cancel(task->thread);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return cur_task;
+}
+
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime,
+                     TickType_t xTimeIncrement)
+{
+    struct timespec wake;
+
+    *pxPreviousWakeTime += xTimeIncrement;
+
+    wake.tv_sec = *pxPreviousWakeTime / configTICK_RATE_HZ;
+    wake.tv_nsec = (*pxPreviousWakeTime % configTICK_RATE_HZ) * NS_PER_TICK;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) ==
+           EINTR)
+        ;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit,
+                          TickType_t xTicksToWait)
+{
+    if (cur_task == NULL) {
+        return 0;
+    }
+
+    return (uint32_t)_takeCounter(&cur_task->notify, xTicksToWait,
+                                  xClearCountOnExit == pdTRUE);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify,
+                            BaseType_t *pxHigherPriorityTaskWoken)
+{
+    struct task *task = xTaskToNotify;
+
+    _giveCounter(&task->notify);
+
+    if (pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    return __atomic_load_n(&task_count, __ATOMIC_RELAXED);
+}
+
+// There is no scheduler to report on, tasks have no stacks or run time
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *pxTaskStatusArray,
+                                 UBaseType_t uxArraySize,
+                                 uint32_t *pulTotalRunTime)
+{
+    (void)pxTaskStatusArray;
+    (void)uxArraySize;
+
+    if (pulTotalRunTime) {
+        *pulTotalRunTime = 0;
+    }
+
+    return 0;
+}
+
+void vTaskList(char *pcWriteBuffer)
+{
+    pcWriteBuffer[0] = '\0';
+}
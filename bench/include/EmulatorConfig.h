@@ -0,0 +1,45 @@
+/**
+ * @file EmulatorConfig.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Emulator configuration the benchmarks build the library with
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __BENCH_EMULATOR_CONFIG_H__
+#define __BENCH_EMULATOR_CONFIG_H__
+
+/**
+ * The emulator's resources, only the default font is needed. Set by the
+ * Makefile to the resources of the emulator this library is checked out in.
+ */
+#ifndef RESOURCES_DIRECTORY
+#define RESOURCES_DIRECTORY "../../../resources"
+#endif // RESOURCES_DIRECTORY
+
+/**
+ * Fonts are looked up relative to RESOURCES_DIRECTORY
+ */
+#define FONTS_DIRECTORY "fonts"
+
+/**
+ * Frames are drawn as fast as they can be, the frame rate is what is measured
+ */
+#define configFPS_LIMIT 0
+
+#endif // __BENCH_EMULATOR_CONFIG_H__
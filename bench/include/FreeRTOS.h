@@ -0,0 +1,64 @@
+/**
+ * @file FreeRTOS.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Stand-in for the FreeRTOS kernel's headers, used to build the
+ * benchmarks without the kernel
+ *
+ * The benchmarks drive the library from plain pthreads, without a scheduler.
+ * Only the parts of the kernel's API that the library uses are declared,
+ * freertos.c implements them on top of pthreads.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __BENCH_FREERTOS_H__
+#define __BENCH_FREERTOS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint16_t StackType_t;
+typedef uint16_t configSTACK_DEPTH_TYPE;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 5
+#define configMINIMAL_STACK_SIZE 128
+#define configMAX_TASK_NAME_LEN 16
+
+#define tskIDLE_PRIORITY 0
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portEND_SWITCHING_ISR(xSwitchRequired) ((void)(xSwitchRequired))
+#define pdMS_TO_TICKS(ms) \
+    ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+void *pvPortMalloc(size_t size);
+void vPortFree(void *ptr);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+
+#endif // __BENCH_FREERTOS_H__
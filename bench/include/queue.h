@@ -0,0 +1,33 @@
+/**
+ * @file queue.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Stand-in for the FreeRTOS kernel's queue API, see FreeRTOS.h
+ *
+ * Queues are only used as the handles of semaphores.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#ifndef __BENCH_QUEUE_H__
+#define __BENCH_QUEUE_H__
+
+#include "FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+#endif // __BENCH_QUEUE_H__
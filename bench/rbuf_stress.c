@@ -0,0 +1,463 @@
+/**
+ * @file rbuf_stress.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Stresses the gfxRbuf ring buffers and reports their throughput
+ *
+ * Every scenario runs a number of producer and consumer threads against one
+ * ring buffer, each using one of the ways items can be put into or taken out
+ * of the buffer. Each item carries the producer that put it, its sequence
+ * number within that producer and a checksum of both.
+ *
+ * Consumers check that the items of each producer arrive in order, and a
+ * single consumer also checks that none are skipped. Once all items have
+ * been consumed every item must have been seen exactly once, catching items
+ * that were lost, duplicated or torn.
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gfx_utils.h"
+
+#define MAX_THREADS 16
+#define MAX_BATCH 32
+#define DEFAULT_ITEMS (1 << 20)
+#define DEFAULT_CAPACITY 1024
+
+#define CHECKSUM(PRODUCER, SEQ) \
+    (((uint64_t)(PRODUCER) << 32 | (SEQ)) * 0x9E3779B97F4A7C15ULL)
+
+struct item {
+    uint32_t producer;
+    uint32_t seq;
+    uint64_t checksum;
+};
+
+enum produce_mode {
+    PRODUCE_PUT, // gfxRbufPut()
+    PRODUCE_RESERVE, // gfxRbufReserve() and gfxRbufCommit()
+    PRODUCE_CLAIM, // gfxRbufGetBuffer() and gfxRbufPutBuffer()
+};
+
+enum consume_mode {
+    CONSUME_GET, // gfxRbufGet()
+    CONSUME_BATCH, // gfxRbufGetBatch()
+    CONSUME_PEEK, // gfxRbufPeek() and gfxRbufRelease()
+    CONSUME_PEEK_BUFFER, // gfxRbufPeekBuffer() and gfxRbufReleaseBuffer()
+};
+
+struct scenario {
+    const char *name;
+    unsigned char spsc;
+    unsigned int producers;
+    unsigned int consumers;
+    enum produce_mode produce;
+    enum consume_mode consume;
+};
+
+static const struct scenario scenarios[] = {
+    { "mpmc 4x4 put/get", 0, 4, 4, PRODUCE_PUT, CONSUME_GET },
+    { "spsc 1x1 put/get", 1, 1, 1, PRODUCE_PUT, CONSUME_GET },
+    { "mpmc 4x4 reserve/batch", 0, 4, 4, PRODUCE_RESERVE, CONSUME_BATCH },
+    { "spsc 1x1 reserve/batch", 1, 1, 1, PRODUCE_RESERVE, CONSUME_BATCH },
+    { "mpmc 4x1 claim/peek", 0, 4, 1, PRODUCE_CLAIM, CONSUME_PEEK },
+    { "mpmc 4x1 reserve/peek", 0, 4, 1, PRODUCE_RESERVE, CONSUME_PEEK },
+    { "spsc 1x1 reserve/peek", 1, 1, 1, PRODUCE_RESERVE, CONSUME_PEEK },
+    {
+        "spsc 1x1 claim/peek buffer", 1, 1, 1, PRODUCE_CLAIM,
+        CONSUME_PEEK_BUFFER
+    },
+};
+
+struct worker {
+    pthread_t thread;
+    unsigned int id;
+    const struct scenario *scenario;
+    uint32_t last[MAX_THREADS]; // Sequence number + 1 of the last item seen
+    unsigned long errors;
+};
+
+static struct {
+    rbuf_handle_t rbuf;
+    uint32_t items; // Items per producer
+    unsigned long total; // Items over all producers
+    unsigned long consumed;
+    unsigned char failed; // Stops all workers once any of them failed
+    unsigned char *seen[MAX_THREADS];
+} run;
+
+static unsigned long long _nowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void _fail(struct worker *worker)
+{
+    worker->errors++;
+    __atomic_store_n(&run.failed, 1, __ATOMIC_RELAXED);
+}
+
+static void _fillItem(struct item *item, uint32_t producer, uint32_t seq)
+{
+    item->producer = producer;
+    item->seq = seq;
+    item->checksum = CHECKSUM(producer, seq);
+}
+
+/**
+ * @brief Checks a consumed item and marks it as seen
+ *
+ * @return 0 if the item is valid and in order, -1 otherwise
+ */
+static int _checkItem(struct worker *worker, const struct item *item)
+{
+    unsigned char single = worker->scenario->consumers == 1;
+    uint32_t p = item->producer;
+
+    if (p >= worker->scenario->producers || item->seq >= run.items ||
+        item->checksum != CHECKSUM(p, item->seq)) {
+        fprintf(stderr, "consumer %u: torn item %u/%u\n", worker->id, p,
+                item->seq);
+        return -1;
+    }
+
+    // A producer's items arrive in order, a single consumer sees all of them
+    if (item->seq + 1 <= worker->last[p] ||
+        (single && item->seq != worker->last[p])) {
+        fprintf(stderr, "consumer %u: item %u/%u after %u/%d\n",
+                worker->id, p, item->seq, p, (int)worker->last[p] - 1);
+        return -1;
+    }
+    worker->last[p] = item->seq + 1;
+
+    if (__atomic_fetch_add(&run.seen[p][item->seq], 1, __ATOMIC_RELAXED)) {
+        fprintf(stderr, "consumer %u: duplicate item %u/%u\n", worker->id,
+                p, item->seq);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void _checkSpan(struct worker *worker, const rbuf_span_t *span)
+{
+    size_t i;
+
+    for (i = 0; i < span->count; i++)
+        if (_checkItem(worker, (struct item *)span->data + i)) {
+            _fail(worker);
+        }
+}
+
+static void *_produce(void *arg)
+{
+    struct worker *worker = arg;
+    rbuf_reservation_t reservation;
+    struct item item, *slot;
+    uint32_t seq = 0;
+    size_t count, half, i, j;
+
+    while (seq < run.items &&
+           !__atomic_load_n(&run.failed, __ATOMIC_RELAXED)) {
+        switch (worker->scenario->produce) {
+            case PRODUCE_PUT:
+                _fillItem(&item, worker->id, seq);
+                if (!gfxRbufPut(run.rbuf, &item)) {
+                    seq++;
+                    continue;
+                }
+                break;
+            case PRODUCE_RESERVE:
+                count = run.items - seq;
+                count = gfxRbufReserve(run.rbuf,
+                                       count < MAX_BATCH ? count : MAX_BATCH,
+                                       &reservation);
+                if (!count) {
+                    break;
+                }
+                for (i = 0; i < 2; i++)
+                    for (j = 0; j < reservation.spans[i].count; j++)
+                        _fillItem((struct item *)reservation.spans[i].data + j,
+                                  worker->id, seq++);
+
+                // Commit in two steps to also cover partial commits
+                half = count / 2;
+                if (gfxRbufCommit(run.rbuf, &reservation, half) ||
+                    gfxRbufCommit(run.rbuf, &reservation, count - half)) {
+                    fprintf(stderr, "producer %u: commit failed\n",
+                            worker->id);
+                    _fail(worker);
+                    return NULL;
+                }
+                continue;
+            case PRODUCE_CLAIM:
+                slot = gfxRbufGetBuffer(run.rbuf);
+                if (slot) {
+                    _fillItem(slot, worker->id, seq++);
+                    gfxRbufPutBuffer(run.rbuf, slot);
+                    continue;
+                }
+                break;
+        }
+
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+static void *_consume(void *arg)
+{
+    struct worker *worker = arg;
+    struct item items[MAX_BATCH], *slot;
+    rbuf_span_t spans[2];
+    size_t count, i;
+
+    while (__atomic_load_n(&run.consumed, __ATOMIC_RELAXED) < run.total &&
+           !__atomic_load_n(&run.failed, __ATOMIC_RELAXED)) {
+        count = 0;
+
+        switch (worker->scenario->consume) {
+            case CONSUME_GET:
+                if (!gfxRbufGet(run.rbuf, items)) {
+                    count = 1;
+                }
+                break;
+            case CONSUME_BATCH:
+                count = gfxRbufGetBatch(run.rbuf, items, MAX_BATCH);
+                break;
+            case CONSUME_PEEK:
+                count = gfxRbufPeek(run.rbuf, MAX_BATCH, spans);
+                _checkSpan(worker, &spans[0]);
+                _checkSpan(worker, &spans[1]);
+                if (count && gfxRbufRelease(run.rbuf, count)) {
+                    fprintf(stderr, "consumer %u: release failed\n",
+                            worker->id);
+                    _fail(worker);
+                }
+                break;
+            case CONSUME_PEEK_BUFFER:
+                while (count < MAX_BATCH &&
+                       (slot = gfxRbufPeekBuffer(run.rbuf, count))) {
+                    if (_checkItem(worker, slot)) {
+                        _fail(worker);
+                    }
+                    count++;
+                }
+                if (count && gfxRbufReleaseBuffer(run.rbuf, count)) {
+                    fprintf(stderr, "consumer %u: release failed\n",
+                            worker->id);
+                    _fail(worker);
+                }
+                break;
+        }
+
+        if (worker->scenario->consume == CONSUME_GET ||
+            worker->scenario->consume == CONSUME_BATCH)
+            for (i = 0; i < count; i++)
+                if (_checkItem(worker, &items[i])) {
+                    _fail(worker);
+                }
+
+        if (count) {
+            __atomic_add_fetch(&run.consumed, count, __ATOMIC_RELAXED);
+        }
+        else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Runs a scenario and checks that every item was consumed once
+ *
+ * @return Items per second, -1 if the scenario failed
+ */
+static double _runScenario(const struct scenario *scenario, uint32_t items,
+                           size_t capacity)
+{
+    struct worker producers[MAX_THREADS] = { 0 };
+    struct worker consumers[MAX_THREADS] = { 0 };
+    unsigned long long start, end;
+    unsigned long errors = 0, missing = 0;
+    unsigned int i, started_p, started_c;
+    uint32_t seq;
+    double ret = -1;
+
+    run.rbuf = scenario->spsc ? gfxRbufInitSPSC(sizeof(struct item), capacity)
+               : gfxRbufInit(sizeof(struct item), capacity);
+    if (run.rbuf == NULL) {
+        fprintf(stderr, "Failed to create ring buffer\n");
+        return -1;
+    }
+
+    run.items = items;
+    run.total = (unsigned long)items * scenario->producers;
+    run.consumed = 0;
+    run.failed = 0;
+
+    for (i = 0; i < scenario->producers; i++) {
+        run.seen[i] = calloc(items, 1);
+        if (run.seen[i] == NULL) {
+            goto err_seen;
+        }
+    }
+
+    start = _nowNs();
+
+    for (started_c = 0; started_c < scenario->consumers; started_c++) {
+        consumers[started_c].id = started_c;
+        consumers[started_c].scenario = scenario;
+        if (pthread_create(&consumers[started_c].thread, NULL, _consume,
+                           &consumers[started_c])) {
+            break;
+        }
+    }
+
+    for (started_p = 0; started_p < scenario->producers; started_p++) {
+        producers[started_p].id = started_p;
+        producers[started_p].scenario = scenario;
+        if (pthread_create(&producers[started_p].thread, NULL, _produce,
+                           &producers[started_p])) {
+            break;
+        }
+    }
+
+    // Consumers waiting for items that will never come are stopped
+    if (started_p != scenario->producers ||
+        started_c != scenario->consumers) {
+        __atomic_store_n(&run.failed, 1, __ATOMIC_RELAXED);
+    }
+
+    for (i = 0; i < started_p; i++) {
+        pthread_join(producers[i].thread, NULL);
+        errors += producers[i].errors;
+    }
+
+    for (i = 0; i < started_c; i++) {
+        pthread_join(consumers[i].thread, NULL);
+        errors += consumers[i].errors;
+    }
+
+    end = _nowNs();
+
+    if (started_p != scenario->producers ||
+        started_c != scenario->consumers) {
+        fprintf(stderr, "Failed to start threads\n");
+        goto err_threads;
+    }
+
+    // Workers stop at the first error, the remaining items are never seen
+    if (errors) {
+        goto err_workers;
+    }
+
+    for (i = 0; i < scenario->producers; i++)
+        for (seq = 0; seq < items; seq++)
+            if (run.seen[i][seq] != 1) {
+                missing++;
+            }
+
+    if (missing) {
+        fprintf(stderr, "%lu items not consumed exactly once\n", missing);
+    }
+    else if (!gfxRbufEmpty(run.rbuf)) {
+        fprintf(stderr, "%lu items left in the ring buffer\n",
+                (unsigned long)gfxRbufSize(run.rbuf));
+    }
+    else {
+        ret = run.total * 1e9 / (end - start);
+    }
+
+err_workers:
+err_threads:
+err_seen:
+    for (i = 0; i < scenario->producers; i++) {
+        free(run.seen[i]);
+        run.seen[i] = NULL;
+    }
+    gfxRbufFree(run.rbuf);
+
+    return ret;
+}
+
+static void _usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-n items] [-c capacity]\n"
+            "  -n  Items put by each producer, default %d\n"
+            "  -c  Capacity of the ring buffer, default %d\n",
+            name, DEFAULT_ITEMS, DEFAULT_CAPACITY);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long items = DEFAULT_ITEMS;
+    size_t capacity = DEFAULT_CAPACITY;
+    unsigned int i, failed = 0;
+    double rate;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                items = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                capacity = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                _usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (!items || items > UINT32_MAX || !capacity) {
+        _usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-28s %12s %10s\n", "scenario", "items", "Mitems/s");
+
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        rate = _runScenario(&scenarios[i], items, capacity);
+        if (rate < 0) {
+            printf("%-28s %12s %10s\n", scenarios[i].name, "-", "FAILED");
+            failed++;
+            continue;
+        }
+
+        printf("%-28s %12lu %10.2f\n", scenarios[i].name,
+               items * scenarios[i].producers, rate / 1e6);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -26,6 +26,11 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
+
+#include "gfx_FreeRTOS_utils.h"
+#include "gfx_utils.h"
+#include "gfx_print.h"
 
 #define STATE_LIST_HEADER ("NAME         STATE   PRIORITY  STACK   NUM\n")
 
@@ -51,18 +56,18 @@ void gfxFUtilPrintTaskStateList(void)
 }
 
 #define UTIL_LIST_HEADER ("NAME              RUN TIME  \%\n")
+#define UTIL_LIST_LINE_LEN (configMAX_TASK_NAME_LEN + 40)
+#define EXTRA_TASK_SLACK 4
 
 void gfxFUtilPrintTaskUtils(void)
 {
-    char *buff = (char *)pvPortMalloc(sizeof(char) * 2000);
-    if (buff == NULL) {
-        return;
-    }
-
-    char *buff_head = buff;
-    volatile UBaseType_t num_tasks = uxTaskGetNumberOfTasks(), x;
-    unsigned int ulTotalRunTime;
+    UBaseType_t num_tasks, x;
+    uint32_t ulTotalRunTime;
     float ulStatsAsPercentage;
+    size_t buff_len, used;
+
+    // Tasks created between counting and retrieving them must still fit
+    num_tasks = uxTaskGetNumberOfTasks() + EXTRA_TASK_SLACK;
 
     TaskStatus_t *status_list = (TaskStatus_t *)pvPortMalloc(
                                     sizeof(TaskStatus_t) * (int)num_tasks);
@@ -70,42 +75,464 @@ void gfxFUtilPrintTaskUtils(void)
         goto err_stat_list;
     }
 
-    UBaseType_t ret = uxTaskGetSystemState(
-                          status_list, (const UBaseType_t)num_tasks, &ulTotalRunTime);
-    if (ret != num_tasks) {
+    num_tasks = uxTaskGetSystemState(status_list, num_tasks,
+                                     &ulTotalRunTime);
+    if (!num_tasks) {
+        goto err_inval_status_num;
+    }
+
+    buff_len = strlen(UTIL_LIST_HEADER) + num_tasks * UTIL_LIST_LINE_LEN + 1;
+    char *buff = (char *)pvPortMalloc(sizeof(char) * buff_len);
+    if (buff == NULL) {
         goto err_inval_status_num;
     }
 
     /** ulTotalRunTime /= 100UL; */
 
     if (ulTotalRunTime > 0) {
-        sprintf(buff, "%s", UTIL_LIST_HEADER);
-        buff += strlen(UTIL_LIST_HEADER);
-        for (x = 0; x < num_tasks; x++) {
+        used = snprintf(buff, buff_len, "%s", UTIL_LIST_HEADER);
+        for (x = 0; x < num_tasks && used < buff_len; x++) {
             ulStatsAsPercentage = status_list[x].ulRunTimeCounter /
                                   (float)ulTotalRunTime * 100.0;
 
             if (ulStatsAsPercentage > 0UL) {
-                sprintf(buff, "%-20s %5u  %.2f\n",
-                        status_list[x].pcTaskName,
-                        status_list[x].ulRunTimeCounter,
-                        ulStatsAsPercentage);
+                used += snprintf(buff + used, buff_len - used,
+                                 "%-20s %5u  %.2f\n",
+                                 status_list[x].pcTaskName,
+                                 (unsigned)status_list[x].ulRunTimeCounter,
+                                 ulStatsAsPercentage);
             }
             else {
-                sprintf(buff, "%-20s %5u\n",
-                        status_list[x].pcTaskName,
-                        status_list[x].ulRunTimeCounter);
+                used += snprintf(buff + used, buff_len - used,
+                                 "%-20s %5u\n",
+                                 status_list[x].pcTaskName,
+                                 (unsigned)status_list[x].ulRunTimeCounter);
             }
-
-            buff += strlen((char *)buff);
         }
-        printf("%s\n", buff_head);
+        printf("%s\n", buff);
     }
 
-err_stat_list:
-    vPortFree(buff_head);
+    vPortFree(buff);
 err_inval_status_num:
     vPortFree(status_list);
-
+err_stat_list:
     return;
 }
+
+struct profiler {
+    TaskHandle_t task; // Protected by lock
+    SemaphoreHandle_t lock; // Protects history and latest, never deleted
+    rbuf_handle_t history;
+    unsigned int period_ms;
+    unsigned char have_latest;
+    futil_profile_sample_t latest;
+
+    // Counters from the previous sample that deltas are computed against
+    unsigned int prev_count;
+    unsigned long prev_number[FUTIL_PROFILER_MAX_TASKS];
+    uint32_t prev_counter[FUTIL_PROFILER_MAX_TASKS];
+    unsigned char prev_stack_alarm[FUTIL_PROFILER_MAX_TASKS];
+    unsigned char heap_alarm;
+    uint32_t prev_total;
+
+    // Memory alarm thresholds, protected by lock while running
+    unsigned long stack_threshold;
+    size_t heap_threshold;
+    futil_memory_alarm_cb_t alarm_callback;
+    void *alarm_args;
+
+    TaskStatus_t status_list[FUTIL_PROFILER_MAX_TASKS];
+    futil_profile_sample_t sample;
+};
+
+static struct profiler profiler = { 0 };
+
+// The lock is created once and kept for the module's lifetime, such that it
+// can still be taken by a caller racing with gfxFUtilProfilerStop()
+static SemaphoreHandle_t _profilerLock(void)
+{
+    SemaphoreHandle_t lock = __atomic_load_n(&profiler.lock,
+                             __ATOMIC_ACQUIRE);
+    SemaphoreHandle_t expected = NULL;
+
+    if (lock) {
+        return lock;
+    }
+
+    lock = xSemaphoreCreateMutex();
+    if (lock == NULL) {
+        PRINT_ERROR("Could not create profiler lock");
+        return NULL;
+    }
+
+    if (!__atomic_compare_exchange_n(&profiler.lock, &expected, lock, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        vSemaphoreDelete(lock);
+        lock = expected;
+    }
+
+    return lock;
+}
+
+static int _getPrevIndex(unsigned long task_number)
+{
+    unsigned int i;
+
+    for (i = 0; i < profiler.prev_count; i++)
+        if (profiler.prev_number[i] == task_number) {
+            return i;
+        }
+
+    // Task was created during the interval
+    return -1;
+}
+
+static void _profilerCheckMemory(unsigned char *stack_alarm)
+{
+    futil_memory_alarm_cb_t callback;
+    unsigned long stack_threshold;
+    size_t heap_threshold;
+    void *args;
+    UBaseType_t i;
+
+    xSemaphoreTake(profiler.lock, portMAX_DELAY);
+    callback = profiler.alarm_callback;
+    args = profiler.alarm_args;
+    stack_threshold = profiler.stack_threshold;
+    heap_threshold = profiler.heap_threshold;
+    xSemaphoreGive(profiler.lock);
+
+    // Callbacks are only raised when a margin first drops below its threshold
+    for (i = 0; i < profiler.sample.task_count; i++) {
+        futil_task_load_t *task = &profiler.sample.tasks[i];
+
+        if (task->stack_high_water_mark < stack_threshold) {
+            if (!stack_alarm[i] && callback) {
+                callback(FUTIL_ALARM_STACK, task->name,
+                         task->stack_high_water_mark, args);
+            }
+            stack_alarm[i] = 1;
+        }
+        else {
+            stack_alarm[i] = 0;
+        }
+    }
+
+#if (FUTIL_PROFILER_HEAP_STATS == 1)
+    if (profiler.sample.heap_free < heap_threshold) {
+        if (!profiler.heap_alarm && callback) {
+            callback(FUTIL_ALARM_HEAP, NULL, profiler.sample.heap_free,
+                     args);
+        }
+        profiler.heap_alarm = 1;
+    }
+    else {
+        profiler.heap_alarm = 0;
+    }
+#endif //FUTIL_PROFILER_HEAP_STATS
+}
+
+static void _profilerSample(void)
+{
+    futil_profile_sample_t *sample = &profiler.sample;
+    unsigned char stack_alarm[FUTIL_PROFILER_MAX_TASKS];
+    uint32_t total, total_delta, delta;
+    UBaseType_t count, i;
+    int prev;
+
+    count = uxTaskGetSystemState(profiler.status_list,
+                                 FUTIL_PROFILER_MAX_TASKS, &total);
+    if (!count) {
+        // More tasks than FUTIL_PROFILER_MAX_TASKS
+        PRINT_WARNING("Profiler could not retrieve system state");
+        return;
+    }
+
+    // First sample only sets the baseline
+    if (profiler.prev_total) {
+        total_delta = total - profiler.prev_total;
+
+        sample->timestamp_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        sample->total_run_time = total_delta;
+        sample->task_count = count;
+#if (FUTIL_PROFILER_HEAP_STATS == 1)
+        sample->heap_free = xPortGetFreeHeapSize();
+        sample->heap_min_ever_free = xPortGetMinimumEverFreeHeapSize();
+#endif //FUTIL_PROFILER_HEAP_STATS
+
+        for (i = 0; i < count; i++) {
+            prev = _getPrevIndex(profiler.status_list[i].xTaskNumber);
+            delta = profiler.status_list[i].ulRunTimeCounter -
+                    (prev < 0 ? 0 : profiler.prev_counter[prev]);
+            stack_alarm[i] = prev < 0 ? 0 : profiler.prev_stack_alarm[prev];
+
+            strncpy(sample->tasks[i].name,
+                    profiler.status_list[i].pcTaskName,
+                    FUTIL_PROFILER_TASK_NAME_LEN - 1);
+            sample->tasks[i].name[FUTIL_PROFILER_TASK_NAME_LEN - 1] = '\0';
+            sample->tasks[i].task_number =
+                profiler.status_list[i].xTaskNumber;
+            sample->tasks[i].run_time = delta;
+            sample->tasks[i].cpu_share =
+                total_delta ? delta / (float)total_delta * 100.0 : 0;
+            sample->tasks[i].stack_high_water_mark =
+                profiler.status_list[i].usStackHighWaterMark;
+        }
+
+        _profilerCheckMemory(stack_alarm);
+
+        xSemaphoreTake(profiler.lock, portMAX_DELAY);
+        gfxRbufFPut(profiler.history, sample);
+        memcpy(&profiler.latest, sample, sizeof(futil_profile_sample_t));
+        profiler.have_latest = 1;
+        xSemaphoreGive(profiler.lock);
+    }
+    else {
+        memset(stack_alarm, 0, sizeof(stack_alarm));
+    }
+
+    for (i = 0; i < count; i++) {
+        profiler.prev_number[i] = profiler.status_list[i].xTaskNumber;
+        profiler.prev_counter[i] = profiler.status_list[i].ulRunTimeCounter;
+        profiler.prev_stack_alarm[i] = stack_alarm[i];
+    }
+    profiler.prev_count = count;
+    profiler.prev_total = total;
+}
+
+static void vProfilerTask(void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    (void)pvParameters;
+
+    while (1) {
+        _profilerSample();
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(profiler.period_ms));
+    }
+}
+
+int gfxFUtilProfilerStart(unsigned int period_ms, unsigned int history_len)
+{
+    SemaphoreHandle_t lock;
+
+    if (!period_ms || !history_len) {
+        PRINT_ERROR("Profiler requires a period and history length");
+        goto err_args;
+    }
+
+    lock = _profilerLock();
+    if (lock == NULL) {
+        goto err_lock;
+    }
+
+    // The new task blocks on the lock until the profiler is set up
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+    if (profiler.task) {
+        PRINT_ERROR("Profiler is already running");
+        goto err_running;
+    }
+
+    profiler.period_ms = period_ms;
+    profiler.prev_count = 0;
+    profiler.prev_total = 0;
+    profiler.have_latest = 0;
+    profiler.heap_alarm = 0;
+
+    profiler.history =
+        gfxRbufInit(sizeof(futil_profile_sample_t), history_len);
+    if (profiler.history == NULL) {
+        PRINT_ERROR("Could not allocate profiler history");
+        goto err_history;
+    }
+
+    if (xTaskCreate(vProfilerTask, "Profiler", FUTIL_PROFILER_STACK_SIZE,
+                    NULL, FUTIL_PROFILER_PRIORITY,
+                    &profiler.task) != pdPASS) {
+        PRINT_ERROR("Could not create profiler task");
+        profiler.task = NULL;
+        goto err_task;
+    }
+
+    xSemaphoreGive(lock);
+
+    return 0;
+
+err_task:
+    gfxRbufFree(profiler.history);
+    profiler.history = NULL;
+err_history:
+err_running:
+    xSemaphoreGive(lock);
+err_lock:
+err_args:
+    return -1;
+}
+
+void gfxFUtilProfilerStop(void)
+{
+    SemaphoreHandle_t lock = _profilerLock();
+
+    if (lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+    if (profiler.task == NULL) {
+        goto unlock;
+    }
+
+    // The task would be deleted while holding the lock, eg. from an alarm
+    if (profiler.task == xTaskGetCurrentTaskHandle()) {
+        PRINT_ERROR("Profiler cannot be stopped from its own task");
+        goto unlock;
+    }
+
+    vTaskDelete(profiler.task);
+    profiler.task = NULL;
+    gfxRbufFree(profiler.history);
+    profiler.history = NULL;
+
+unlock:
+    xSemaphoreGive(lock);
+}
+
+void gfxFUtilProfilerSetMemoryAlarm(unsigned long stack_threshold,
+                                    size_t heap_threshold,
+                                    futil_memory_alarm_cb_t callback,
+                                    void *args)
+{
+    SemaphoreHandle_t lock = _profilerLock();
+
+    if (lock) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+    }
+
+    profiler.stack_threshold = stack_threshold;
+    profiler.heap_threshold = heap_threshold;
+    profiler.alarm_callback = callback;
+    profiler.alarm_args = args;
+
+    if (lock) {
+        xSemaphoreGive(lock);
+    }
+}
+
+int gfxFUtilProfilerGetLatest(futil_profile_sample_t *sample)
+{
+    SemaphoreHandle_t lock = _profilerLock();
+    int ret = -1;
+
+    if (lock == NULL || sample == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (profiler.task && profiler.have_latest) {
+        memcpy(sample, &profiler.latest, sizeof(futil_profile_sample_t));
+        ret = 0;
+    }
+    xSemaphoreGive(lock);
+
+    return ret;
+}
+
+static void _writeJSONString(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*str, file);
+    }
+    fputc('"', file);
+}
+
+#define EXPORT_CSV 0
+#define EXPORT_JSON 1
+
+static int _profilerExport(FILE *file, unsigned char format)
+{
+    SemaphoreHandle_t lock = _profilerLock();
+    futil_profile_sample_t *sample;
+    unsigned int i;
+    size_t s;
+
+    if (file == NULL || lock == NULL) {
+        return -1;
+    }
+
+    // Samples are read in place, the profiler task waits until done
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+    if (profiler.task == NULL) {
+        xSemaphoreGive(lock);
+        PRINT_ERROR("Profiler is not running");
+        return -1;
+    }
+
+    if (format == EXPORT_CSV) {
+        fprintf(file, "timestamp_ms,task,run_time,cpu_percent,"
+                "stack_high_water_mark,heap_free,heap_min_ever_free\n");
+    }
+    else {
+        fprintf(file, "[");
+    }
+
+    for (s = 0; (sample = gfxRbufPeekBuffer(profiler.history, s)); s++) {
+        if (format == EXPORT_JSON) {
+            fprintf(file,
+                    "%s\n  {\"timestamp_ms\": %lu, \"total_run_time\": %lu, "
+                    "\"heap_free\": %zu, \"heap_min_ever_free\": %zu, "
+                    "\"tasks\": [",
+                    s ? "," : "", sample->timestamp_ms,
+                    sample->total_run_time, sample->heap_free,
+                    sample->heap_min_ever_free);
+        }
+
+        for (i = 0; i < sample->task_count; i++) {
+            if (format == EXPORT_CSV) {
+                fprintf(file, "%lu,%s,%lu,%.2f,%lu,%zu,%zu\n",
+                        sample->timestamp_ms, sample->tasks[i].name,
+                        sample->tasks[i].run_time,
+                        sample->tasks[i].cpu_share,
+                        sample->tasks[i].stack_high_water_mark,
+                        sample->heap_free, sample->heap_min_ever_free);
+            }
+            else {
+                fprintf(file, "%s{\"name\": ", i ? ", " : "");
+                _writeJSONString(file, sample->tasks[i].name);
+                fprintf(file, ", \"run_time\": %lu, \"cpu_percent\": %.2f, "
+                        "\"stack_high_water_mark\": %lu}",
+                        sample->tasks[i].run_time,
+                        sample->tasks[i].cpu_share,
+                        sample->tasks[i].stack_high_water_mark);
+            }
+        }
+
+        if (format == EXPORT_JSON) {
+            fprintf(file, "]}");
+        }
+    }
+
+    if (format == EXPORT_JSON) {
+        fprintf(file, "\n]\n");
+    }
+
+    xSemaphoreGive(lock);
+
+    return 0;
+}
+
+int gfxFUtilProfilerExportCSV(FILE *file)
+{
+    return _profilerExport(file, EXPORT_CSV);
+}
+
+int gfxFUtilProfilerExportJSON(FILE *file)
+{
+    return _profilerExport(file, EXPORT_JSON);
+}
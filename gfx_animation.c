@@ -0,0 +1,350 @@
+/**
+ * @file gfx_animation.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Animation pools that advance many sequence instances against the
+ * frame clock and draw them as one sprite batch per spritesheet
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include "gfx_draw_internal.h"
+#include "gfx_print.h"
+
+typedef struct animation_pool {
+    unsigned capacity;
+    unsigned count; // Instances occupy slots [0, count)
+
+    // Per slot, kept contiguous by moving the last slot into removed slots
+    int *ids;
+    int *x;
+    int *y;
+    unsigned *start_ms;
+    unsigned *frame_period_ms;
+    unsigned *frames;
+    unsigned *sheet;
+    SDL_Rect **rects;
+
+    unsigned *slots; // Slot of each ID, ids[count..capacity) are free IDs
+
+    // Spritesheets used by the pool's instances
+    unsigned sheet_count;
+    spritesheet_t **sheets;
+    unsigned *sheet_users;
+    unsigned *batch_fill;
+    SDL_Rect **batches;
+} animation_pool_t;
+
+gfx_animation_pool_handle_t gfxDrawAnimationPoolCreate(unsigned capacity)
+{
+    if (capacity == 0) {
+        PRINT_ERROR("Animation pool capacity cannot be zero");
+        goto err;
+    }
+
+    animation_pool_t *ret = calloc(1, sizeof(animation_pool_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Could not allocate animation pool");
+        goto err;
+    }
+
+    // All per slot and per spritesheet arrays share one allocation
+    char *block = calloc(capacity, 3 * sizeof(void *) +
+                         10 * sizeof(unsigned));
+    if (block == NULL) {
+        PRINT_ERROR("Could not allocate animation pool of %u instances",
+                    capacity);
+        goto err_block;
+    }
+
+    ret->capacity = capacity;
+
+    ret->rects = (SDL_Rect **)block;
+    ret->sheets = (spritesheet_t **)(ret->rects + capacity);
+    ret->batches = (SDL_Rect **)(ret->sheets + capacity);
+    ret->ids = (int *)(ret->batches + capacity);
+    ret->x = ret->ids + capacity;
+    ret->y = ret->x + capacity;
+    ret->start_ms = (unsigned *)(ret->y + capacity);
+    ret->frame_period_ms = ret->start_ms + capacity;
+    ret->frames = ret->frame_period_ms + capacity;
+    ret->sheet = ret->frames + capacity;
+    ret->slots = ret->sheet + capacity;
+    ret->sheet_users = ret->slots + capacity;
+    ret->batch_fill = ret->sheet_users + capacity;
+
+    unsigned i;
+
+    for (i = 0; i < capacity; i++) {
+        ret->ids[i] = i;
+    }
+
+    return (gfx_animation_pool_handle_t)ret;
+
+err_block:
+    free(ret);
+err:
+    return NULL;
+}
+
+void gfxDrawAnimationPoolDelete(gfx_animation_pool_handle_t pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    free(((animation_pool_t *)pool)->rects);
+    free(pool);
+}
+
+static int _animationPoolSlot(animation_pool_t *pool, int id)
+{
+    if (pool == NULL) {
+        PRINT_ERROR("Animation pool handle is not valid");
+        return -1;
+    }
+
+    if (id < 0 || (unsigned)id >= pool->capacity ||
+        pool->slots[id] >= pool->count || pool->ids[pool->slots[id]] != id) {
+        PRINT_ERROR("Animation pool instance %d is not valid", id);
+        return -1;
+    }
+
+    return pool->slots[id];
+}
+
+int gfxDrawAnimationPoolAdd(gfx_animation_pool_handle_t pool,
+                            gfx_animation_handle_t animation,
+                            char *sequence_name, unsigned frame_period_ms,
+                            int x, int y)
+{
+    animation_pool_t *p = (animation_pool_t *)pool;
+
+    if (p == NULL) {
+        PRINT_ERROR("Animation pool handle is not valid");
+        goto err;
+    }
+
+    if (animation == NULL || sequence_name == NULL) {
+        PRINT_ERROR("Animation pool requires a valid animation sequence");
+        goto err;
+    }
+
+    if (frame_period_ms == 0) {
+        PRINT_ERROR("Sequence frame period cannot be zero");
+        goto err;
+    }
+
+    if (p->count == p->capacity) {
+        PRINT_ERROR("Animation pool is full (%u instances)", p->capacity);
+        goto err;
+    }
+
+    animated_image_t *anim = (animated_image_t *)animation;
+    spritesheet_sequence_t *seq;
+
+    for (seq = anim->sequences; seq; seq = seq->next)
+        if (!strcmp(seq->name, sequence_name)) {
+            break;
+        }
+
+    if (seq == NULL) {
+        PRINT_ERROR("Could not find sequence '%s'", sequence_name);
+        goto err;
+    }
+
+    // Reuse the spritesheet's entry, or an entry no longer in use
+    unsigned sheet, unused = p->sheet_count;
+
+    for (sheet = 0; sheet < p->sheet_count; sheet++) {
+        if (p->sheets[sheet] == anim->spritesheet) {
+            break;
+        }
+        if (!p->sheet_users[sheet] && unused == p->sheet_count) {
+            unused = sheet;
+        }
+    }
+
+    if (sheet == p->sheet_count) {
+        sheet = unused;
+        if (sheet == p->sheet_count) {
+            p->sheet_count++;
+        }
+        p->sheets[sheet] = anim->spritesheet;
+    }
+    p->sheet_users[sheet]++;
+
+    unsigned slot = p->count++;
+    int id = p->ids[slot];
+
+    p->slots[id] = slot;
+    p->x[slot] = x;
+    p->y[slot] = y;
+    p->start_ms[slot] = gfxDrawFrameClockGetMs();
+    p->frame_period_ms[slot] = frame_period_ms;
+    p->frames[slot] = seq->frames;
+    p->sheet[slot] = sheet;
+    p->rects[slot] = seq->rects;
+
+    return id;
+
+err:
+    return -1;
+}
+
+int gfxDrawAnimationPoolRemove(gfx_animation_pool_handle_t pool, int id)
+{
+    animation_pool_t *p = (animation_pool_t *)pool;
+    int slot = _animationPoolSlot(p, id);
+
+    if (slot == -1) {
+        return -1;
+    }
+
+    unsigned last = --p->count;
+
+    p->sheet_users[p->sheet[slot]]--;
+
+    // Move the last instance into the freed slot to keep slots contiguous
+    p->ids[slot] = p->ids[last];
+    p->slots[p->ids[slot]] = slot;
+    p->x[slot] = p->x[last];
+    p->y[slot] = p->y[last];
+    p->start_ms[slot] = p->start_ms[last];
+    p->frame_period_ms[slot] = p->frame_period_ms[last];
+    p->frames[slot] = p->frames[last];
+    p->sheet[slot] = p->sheet[last];
+    p->rects[slot] = p->rects[last];
+
+    p->ids[last] = id;
+
+    return 0;
+}
+
+int gfxDrawAnimationPoolSetPosition(gfx_animation_pool_handle_t pool, int id,
+                                    int x, int y)
+{
+    animation_pool_t *p = (animation_pool_t *)pool;
+    int slot = _animationPoolSlot(p, id);
+
+    if (slot == -1) {
+        return -1;
+    }
+
+    p->x[slot] = x;
+    p->y[slot] = y;
+
+    return 0;
+}
+
+int gfxDrawAnimationPoolReset(gfx_animation_pool_handle_t pool, int id)
+{
+    animation_pool_t *p = (animation_pool_t *)pool;
+    int slot = _animationPoolSlot(p, id);
+
+    if (slot == -1) {
+        return -1;
+    }
+
+    p->start_ms[slot] = gfxDrawFrameClockGetMs();
+
+    return 0;
+}
+
+static int _pushSpriteBatch(spritesheet_t *sheet, SDL_Rect *rects,
+                            unsigned n)
+{
+    INIT_JOB(job, DRAW_SPRITE_BATCH);
+
+    vGetLoadedImage(sheet->image);
+    job->data->sprite_batch.image = sheet->image;
+    job->data->sprite_batch.rects = rects;
+    job->data->sprite_batch.n = n;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
+
+int gfxDrawAnimationPoolDraw(gfx_animation_pool_handle_t pool)
+{
+    animation_pool_t *p = (animation_pool_t *)pool;
+    unsigned now = gfxDrawFrameClockGetMs();
+    unsigned i;
+
+    if (p == NULL) {
+        PRINT_ERROR("Animation pool handle is not valid");
+        goto err;
+    }
+
+    for (i = 0; i < p->sheet_count; i++) {
+        p->batch_fill[i] = 0;
+        p->batches[i] = NULL;
+        if (!p->sheet_users[i]) {
+            continue;
+        }
+
+        p->batches[i] = malloc(p->sheet_users[i] * 2 * sizeof(SDL_Rect));
+        if (p->batches[i] == NULL) {
+            PRINT_ERROR("Could not allocate sprite batch");
+            goto err_batches;
+        }
+    }
+
+    // Source rects are stored in playback order so the frame is just the
+    // number of elapsed periods wrapped to the sequence length
+    for (i = 0; i < p->count; i++) {
+        unsigned frame = ((now - p->start_ms[i]) / p->frame_period_ms[i]) %
+                         p->frames[i];
+        unsigned sheet = p->sheet[i];
+        SDL_Rect *out = &p->batches[sheet][p->batch_fill[sheet]++ * 2];
+
+        out[0] = p->rects[i][frame];
+        out[1].x = p->x[i];
+        out[1].y = p->y[i];
+        out[1].w = out[0].w;
+        out[1].h = out[0].h;
+    }
+
+    int ret = 0;
+
+    for (i = 0; i < p->sheet_count; i++) {
+        if (p->batches[i] == NULL) {
+            continue;
+        }
+
+        if (_pushSpriteBatch(p->sheets[i], p->batches[i],
+                             p->batch_fill[i])) {
+            PRINT_ERROR("Could not queue sprite batch");
+            free(p->batches[i]);
+            ret = -1;
+        }
+    }
+
+    return ret;
+
+err_batches:
+    while (i--) {
+        free(p->batches[i]);
+    }
+err:
+    return -1;
+}
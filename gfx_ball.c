@@ -116,6 +116,7 @@ ball_t *gfxCreateBall(signed short initial_x, signed short initial_y,
     ret->callback = callback;
     ret->args = args;
     ret->sprite = sprite;
+    ret->clock_timestamp = gfxDrawFrameClockGetMs();
 
     return ret;
 }
@@ -165,6 +166,13 @@ void gfxSetBallLocation(ball_t *ball, signed short x, signed short y)
 
 void gfxUpdateBallPosition(ball_t *ball, unsigned int milli_seconds)
 {
+    unsigned clock_now = gfxDrawFrameClockGetMs();
+
+    if (milli_seconds == GFX_FRAME_CLOCK) {
+        milli_seconds = clock_now - ball->clock_timestamp;
+    }
+    ball->clock_timestamp = clock_now;
+
     float update_interval = milli_seconds / 1000.0;
     ball->f_x += ball->dx * update_interval;
     ball->f_y += ball->dy * update_interval;
@@ -0,0 +1,493 @@
+/**
+ * @file gfx_chart.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Scrolling charts whose samples are decimated into one column per
+ * pixel as the chart is drawn
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include <pthread.h>
+
+#include "gfx_chart.h"
+#include "gfx_draw_internal.h"
+#include "gfx_print.h"
+#include "gfx_utils.h"
+
+typedef struct chart_column {
+    float min;
+    float max;
+} chart_column_t;
+
+struct chart {
+    rbuf_handle_t samples; // Samples not yet decimated into columns
+    unsigned width;
+    unsigned height;
+    unsigned samples_per_column;
+
+    // Decimated history, only touched by the GL thread
+    chart_column_t *columns; // One per pixel column, used as a ring
+    unsigned long column; // Column currently being filled
+    unsigned column_fill; // Samples in the current column
+    unsigned char has_samples;
+    float last; // Most recent sample
+    SDL_Vertex *verts; // Quad per column, positioned by its ring slot
+    int *indices;
+    unsigned colour;
+
+    // Settings, guarded by the lock
+    float min; // Value shown at the bottom of the chart
+    float max; // Value shown at the top of the chart
+    unsigned char rescale; // Range changed, every column must be rebuilt
+    unsigned char axes;
+    unsigned axes_colour;
+    unsigned x_divisions;
+    unsigned y_divisions;
+    unsigned char axes_dirty;
+    SDL_Texture *axes_tex;
+    unsigned generation; // Renderer the axes texture was created on
+    pthread_mutex_t lock;
+};
+
+GFX_LOCK_STATS(chart_lock_stats, "chart.lock");
+
+// Decimates a sample into the column it falls in
+static void _chartAddSample(chart_t *chart, float value)
+{
+    chart_column_t *column = &chart->columns[chart->column % chart->width];
+
+    if (!chart->has_samples) {
+        column->min = column->max = value;
+        chart->has_samples = 1;
+    }
+    else if (chart->column_fill == chart->samples_per_column) {
+        chart->column++;
+        chart->column_fill = 0;
+
+        // Seeded with the previous sample so that neighbouring columns join
+        column = &chart->columns[chart->column % chart->width];
+        column->min = column->max = chart->last;
+    }
+
+    if (value < column->min) {
+        column->min = value;
+    }
+    if (value > column->max) {
+        column->max = value;
+    }
+
+    chart->column_fill++;
+    chart->last = value;
+}
+
+static void _chartColumnVerts(chart_t *chart, unsigned long column)
+{
+    unsigned slot = column % chart->width;
+    chart_column_t *values = &chart->columns[slot];
+    SDL_Vertex *v = &chart->verts[slot * 4];
+    SDL_Color c = { RED_PORTION(chart->colour), GREEN_PORTION(chart->colour),
+                    BLUE_PORTION(chart->colour), ALPHA_SOLID
+                  };
+    float scale = (chart->height - 1) / (chart->max - chart->min);
+    float top = floorf((chart->max - values->max) * scale);
+    float bottom = floorf((chart->max - values->min) * scale) + 1;
+
+    if (top < 0) {
+        top = 0;
+    }
+    if (top > chart->height - 1) {
+        top = chart->height - 1;
+    }
+    if (bottom < 1) {
+        bottom = 1;
+    }
+    if (bottom > chart->height) {
+        bottom = chart->height;
+    }
+
+    v[0] = (SDL_Vertex) {
+        { slot, top }, c, { 0, 0 }
+    };
+    v[1] = (SDL_Vertex) {
+        { slot + 1, top }, c, { 0, 0 }
+    };
+    v[2] = (SDL_Vertex) {
+        { slot, bottom }, c, { 0, 0 }
+    };
+    v[3] = (SDL_Vertex) {
+        { slot + 1, bottom }, c, { 0, 0 }
+    };
+}
+
+static int _bakeChartAxes(chart_t *chart)
+{
+    unsigned i;
+
+    if (chart->axes_tex == NULL) {
+        chart->axes_tex = gfxDrawTrackTexture(SDL_CreateTexture(
+                              renderer, SDL_PIXELFORMAT_RGBA8888,
+                              SDL_TEXTUREACCESS_TARGET, chart->width,
+                              chart->height));
+        if (chart->axes_tex == NULL) {
+            PRINT_SDL_ERROR("Failed to create chart axes texture");
+            return -1;
+        }
+        SDL_SetTextureBlendMode(chart->axes_tex, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Texture *prev_target = SDL_GetRenderTarget(renderer);
+
+    if (SDL_SetRenderTarget(renderer, chart->axes_tex)) {
+        PRINT_SDL_ERROR("Failed to render to chart axes");
+        return -1;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, ZERO_ALPHA);
+    SDL_RenderClear(renderer);
+
+    SDL_SetRenderDrawColor(renderer, RED_PORTION(chart->axes_colour),
+                           GREEN_PORTION(chart->axes_colour),
+                           BLUE_PORTION(chart->axes_colour), ALPHA_SOLID);
+
+    for (i = 1; i < chart->x_divisions; i++) {
+        int x = i * chart->width / chart->x_divisions;
+
+        SDL_RenderDrawLine(renderer, x, 0, x, chart->height - 1);
+    }
+
+    for (i = 1; i < chart->y_divisions; i++) {
+        int y = i * chart->height / chart->y_divisions;
+
+        SDL_RenderDrawLine(renderer, 0, y, chart->width - 1, y);
+    }
+
+    SDL_Rect frame = { 0, 0, chart->width, chart->height };
+
+    SDL_RenderDrawRect(renderer, &frame);
+
+    SDL_SetRenderTarget(renderer, prev_target);
+    chart->axes_dirty = 0;
+
+    return 0;
+}
+
+int gfxChartRender(chart_t *chart, int x, int y, unsigned int colour)
+{
+    rbuf_span_t spans[2];
+    unsigned long first = chart->column, c;
+    size_t i, j, count;
+
+    // Only the samples added since the last draw are decimated
+    count = gfxRbufPeek(chart->samples, gfxRbufCapacity(chart->samples),
+                        spans);
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < spans[i].count; j++) {
+            _chartAddSample(chart, ((float *)spans[i].data)[j]);
+        }
+    gfxRbufRelease(chart->samples, count);
+
+    GFX_MUTEX_LOCK(&chart->lock, chart_lock_stats);
+
+    if (chart->rescale || colour != chart->colour) {
+        chart->rescale = 0;
+        chart->colour = colour;
+        first = 0;
+    }
+    else if (!count) {
+        first = chart->column + 1;
+    }
+
+    // Only columns that changed have their vertices rebuilt
+    if (chart->has_samples && first <= chart->column) {
+        if (chart->column - first >= chart->width) {
+            first = chart->column - chart->width + 1;
+        }
+        for (c = first; c <= chart->column; c++) {
+            _chartColumnVerts(chart, c);
+        }
+    }
+
+    if (chart->axes) {
+        // Axes texture was destroyed along with a previous renderer
+        if (chart->generation != renderer_generation) {
+            chart->axes_tex = NULL;
+            chart->axes_dirty = 1;
+            chart->generation = renderer_generation;
+        }
+
+        if (chart->axes_dirty && _bakeChartAxes(chart)) {
+            GFX_MUTEX_UNLOCK(&chart->lock, chart_lock_stats);
+            return -1;
+        }
+
+        SDL_Rect dst = { x, y, chart->width, chart->height };
+
+        SDL_RenderCopy(renderer, chart->axes_tex, NULL, &dst);
+    }
+
+    GFX_MUTEX_UNLOCK(&chart->lock, chart_lock_stats);
+
+    // The ring of columns is drawn in two runs, the oldest column placed on
+    // the left of the chart by offsetting the viewport
+    unsigned oldest = (chart->column + 1) % chart->width;
+    SDL_Rect viewport = { x - oldest, y, chart->width, chart->height };
+
+    SDL_RenderSetViewport(renderer, &viewport);
+    SDL_RenderGeometry(renderer, NULL, chart->verts, chart->width * 4,
+                       &chart->indices[oldest * 6],
+                       (chart->width - oldest) * 6);
+
+    if (oldest) {
+        viewport.x = x + chart->width - oldest;
+        SDL_RenderSetViewport(renderer, &viewport);
+        SDL_RenderGeometry(renderer, NULL, chart->verts, chart->width * 4,
+                           chart->indices, oldest * 6);
+    }
+
+    SDL_RenderSetViewport(renderer, NULL);
+
+    return 0;
+}
+
+void gfxChartGetSize(chart_t *chart, unsigned int *width,
+                     unsigned int *height)
+{
+    *width = chart->width;
+    *height = chart->height;
+}
+
+void gfxChartFree(chart_t *chart)
+{
+    if (chart->axes_tex && chart->generation == renderer_generation) {
+        gfxDrawDestroyTexture(chart->axes_tex);
+    }
+
+    gfxRbufFree(chart->samples);
+    pthread_mutex_destroy(&chart->lock);
+    free(chart->indices);
+    free(chart->verts);
+    free(chart->columns);
+    free(chart);
+}
+
+gfx_chart_handle_t gfxDrawChartCreate(unsigned int history,
+                                      unsigned int width, unsigned int height,
+                                      float min, float max)
+{
+    unsigned i;
+
+    if (!width || !height || history < width) {
+        PRINT_ERROR("Chart requires a history of at least one sample per "
+                    "pixel column");
+        goto err;
+    }
+
+    if (min >= max) {
+        PRINT_ERROR("Chart range minimum must be less than its maximum");
+        goto err;
+    }
+
+    chart_t *ret = calloc(1, sizeof(chart_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Could not allocate chart");
+        goto err;
+    }
+
+    ret->width = width;
+    ret->height = height;
+    ret->samples_per_column = (history + width - 1) / width;
+    ret->min = min;
+    ret->max = max;
+
+    ret->samples = gfxRbufInitSPSC(sizeof(float), history);
+    if (ret->samples == NULL) {
+        PRINT_ERROR("Could not create chart sample buffer");
+        goto err_samples;
+    }
+
+    ret->columns = calloc(width, sizeof(chart_column_t));
+    if (ret->columns == NULL) {
+        PRINT_ERROR("Could not allocate chart columns");
+        goto err_columns;
+    }
+
+    ret->verts = calloc(width * 4, sizeof(SDL_Vertex));
+    if (ret->verts == NULL) {
+        PRINT_ERROR("Could not allocate chart vertices");
+        goto err_verts;
+    }
+
+    ret->indices = malloc(width * 6 * sizeof(int));
+    if (ret->indices == NULL) {
+        PRINT_ERROR("Could not allocate chart indices");
+        goto err_indices;
+    }
+
+    for (i = 0; i < width; i++) {
+        ret->indices[i * 6] = i * 4;
+        ret->indices[i * 6 + 1] = i * 4 + 1;
+        ret->indices[i * 6 + 2] = i * 4 + 2;
+        ret->indices[i * 6 + 3] = i * 4 + 1;
+        ret->indices[i * 6 + 4] = i * 4 + 3;
+        ret->indices[i * 6 + 5] = i * 4 + 2;
+    }
+
+    if (pthread_mutex_init(&ret->lock, NULL)) {
+        PRINT_ERROR("Could not create chart lock");
+        goto err_lock;
+    }
+
+    ret->generation = renderer_generation;
+
+    return (gfx_chart_handle_t)ret;
+
+err_lock:
+    free(ret->indices);
+err_indices:
+    free(ret->verts);
+err_verts:
+    free(ret->columns);
+err_columns:
+    gfxRbufFree(ret->samples);
+err_samples:
+    free(ret);
+err:
+    return NULL;
+}
+
+int gfxDrawChartDelete(gfx_chart_handle_t chart)
+{
+    if (chart == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_CHART);
+
+    job->data->chart.chart = (chart_t *)chart;
+    job->data->chart.release = 1;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
+
+int gfxDrawChartAddSample(gfx_chart_handle_t chart, float value)
+{
+    if (chart == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return -1;
+    }
+
+    return gfxRbufPut(((chart_t *)chart)->samples, &value);
+}
+
+unsigned int gfxDrawChartAddSamples(gfx_chart_handle_t chart,
+                                    float *values, unsigned int count)
+{
+    if (chart == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return 0;
+    }
+
+    return gfxRbufPutBatch(((chart_t *)chart)->samples, values, count);
+}
+
+int gfxDrawChartSetRange(gfx_chart_handle_t chart, float min, float max)
+{
+    chart_t *c = (chart_t *)chart;
+
+    if (c == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return -1;
+    }
+
+    if (min >= max) {
+        PRINT_ERROR("Chart range minimum must be less than its maximum");
+        return -1;
+    }
+
+    GFX_MUTEX_LOCK(&c->lock, chart_lock_stats);
+    c->min = min;
+    c->max = max;
+    c->rescale = 1;
+    GFX_MUTEX_UNLOCK(&c->lock, chart_lock_stats);
+
+    return 0;
+}
+
+int gfxDrawChartSetAxes(gfx_chart_handle_t chart, unsigned int colour,
+                        unsigned int x_divisions, unsigned int y_divisions)
+{
+    chart_t *c = (chart_t *)chart;
+
+    if (c == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return -1;
+    }
+
+    GFX_MUTEX_LOCK(&c->lock, chart_lock_stats);
+    c->axes = 1;
+    c->axes_colour = colour;
+    c->x_divisions = x_divisions;
+    c->y_divisions = y_divisions;
+    c->axes_dirty = 1;
+    GFX_MUTEX_UNLOCK(&c->lock, chart_lock_stats);
+
+    return 0;
+}
+
+int gfxDrawChartHideAxes(gfx_chart_handle_t chart)
+{
+    chart_t *c = (chart_t *)chart;
+
+    if (c == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return -1;
+    }
+
+    GFX_MUTEX_LOCK(&c->lock, chart_lock_stats);
+    c->axes = 0;
+    GFX_MUTEX_UNLOCK(&c->lock, chart_lock_stats);
+
+    return 0;
+}
+
+int gfxDrawChartDraw(gfx_chart_handle_t chart, int x, int y,
+                     unsigned int colour)
+{
+    if (chart == NULL) {
+        PRINT_ERROR("Chart handle is not valid");
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_CHART);
+
+    job->data->chart.chart = (chart_t *)chart;
+    job->data->chart.x = x;
+    job->data->chart.y = y;
+    job->data->chart.colour = colour;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
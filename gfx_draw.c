@@ -21,7 +21,10 @@
    ----------------------------------------------------------------------
 @endverbatim
  */
+#include <limits.h>
 #include <linux/limits.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
@@ -33,44 +36,40 @@
 #include <pthread.h>
 
 #include "gfx_draw.h"
+#include "gfx_draw_internal.h"
 #include "gfx_font.h"
+#include "gfx_FreeRTOS_utils.h"
+#include "gfx_remote.h"
 #include "gfx_utils.h"
 #include "gfx_print.h"
 
-#define ONE_BYTE 8
-#define TWO_BYTES 16
-#define THREE_BYTES 24
-#define MAX_8_BIT 255
-#define ALPHA_SOLID MAX_8_BIT
-#define FIRST_BYTE 0x000000ff
-#define SECOND_BYTE 0x0000ff00
-#define THIRD_BYTE 0x00ff0000
-#define FOURTH_BYTE 0xff000000
-#define RED_PORTION(COLOUR) (COLOUR & 0xFF0000) >> TWO_BYTES
-#define GREEN_PORTION(COLOUR) (COLOUR & 0x00FF00) >> ONE_BYTE
-#define BLUE_PORTION(COLOUR) (COLOUR & 0x0000FF)
-#define ZERO_ALPHA 0
-
-typedef enum {
-    DRAW_NONE = 0,
-    DRAW_CLEAR,
-    DRAW_ARC,
-    DRAW_ELLIPSE,
-    DRAW_TEXT,
-    DRAW_RECT,
-    DRAW_FILLED_RECT,
-    DRAW_CIRCLE,
-    DRAW_LINE,
-    DRAW_POLY,
-    DRAW_TRIANGLE,
-    DRAW_IMAGE,
-    DRAW_LOADED_IMAGE,
-    DRAW_LOADED_IMAGE_CROP,
-    DRAW_SCALED_IMAGE,
-    DRAW_ARROW,
-} draw_job_type_t;
-
-typedef struct loaded_image {
+const char *draw_job_names[DRAW_JOB_TYPE_COUNT] = {
+    [DRAW_NONE] = "none",
+    [DRAW_CLEAR] = "clear",
+    [DRAW_ARC] = "arc",
+    [DRAW_ELLIPSE] = "ellipse",
+    [DRAW_TEXT] = "text",
+    [DRAW_RECT] = "rect",
+    [DRAW_FILLED_RECT] = "fillrect",
+    [DRAW_CIRCLE] = "circle",
+    [DRAW_LINE] = "line",
+    [DRAW_POLYLINE] = "polyline",
+    [DRAW_POLY] = "poly",
+    [DRAW_FILLED_POLY] = "fillpoly",
+    [DRAW_TRIANGLE] = "tri",
+    [DRAW_IMAGE] = "image",
+    [DRAW_LOADED_IMAGE] = "loaded",
+    [DRAW_LOADED_IMAGE_CROP] = "crop",
+    [DRAW_SCALED_IMAGE] = "scaled",
+    [DRAW_ARROW] = "arrow",
+    [DRAW_SPRITE_BATCH] = "sprites",
+    [DRAW_TILEMAP] = "tilemap",
+    [DRAW_PATH] = "path",
+    [DRAW_CHART] = "chart",
+    [DRAW_MESH] = "mesh",
+};
+
+struct loaded_image {
     char *filename;
     FILE *file;
     SDL_Texture *tex;
@@ -79,178 +78,35 @@ typedef struct loaded_image {
     int w;
     int h;
     float scale;
-    //TODO make this atomic
-    unsigned int ref_count;
-    unsigned char pending_free;
+    struct {
+        SDL_Surface *surf;
+        SDL_Texture *tex;
+    } mips[GFX_IMAGE_MIP_LEVELS]; // Level n + 1, halved n + 1 times
+    unsigned int ref_count; // Handle's own reference plus queued jobs
+    unsigned char pending_free; // Freed on the GL thread next frame
+    unsigned long last_used; // Frame the image was last drawn in
+    SDL_Surface *reload; // Hot-reloaded surface, swapped in by the GL thread
+    unsigned int version; // Incremented each time the image is reloaded
+    unsigned int remote_id; // Identifies the image to a viewer, 0 if unset
+    unsigned char remote_sent; // The viewer has loaded the image
 
     struct loaded_image *next;
-} loaded_image_t;
-
-typedef struct loaded_image_crop {
-    loaded_image_t *image;
-    int x;
-    int y;
-    int c_x;
-    int c_y;
-    int c_w;
-    int c_h;
-} loaded_image_crop_t;
-
-typedef struct spritesheet_sequence {
-    char *name;
-    unsigned start_row;
-    unsigned start_col;
-    enum sprite_sequence_direction direction;
-    unsigned frames;
-    struct spritesheet_sequence *next;
-} spritesheet_sequence_t;
-
-typedef struct spritesheet {
-    loaded_image_t *image;
-    unsigned x;
-    unsigned y;
-    unsigned width;
-    unsigned height;
-    unsigned sprite_width;
-    unsigned sprite_height;
-    unsigned sprite_cols;
-    unsigned sprite_rows;
-    unsigned padding_x;
-    unsigned padding_y;
-} spritesheet_t;
-
-typedef struct animated_image {
-    spritesheet_t *spritesheet;
-    spritesheet_sequence_t *sequences;
-} animated_image_t;
+};
 
 typedef struct animated_sequence_instance {
     unsigned frame_period_ms;
     signed current_frame;
     unsigned prev_frame_timestamp;
     unsigned cur_frame_timestamp;
+    unsigned clock_timestamp; // Frame clock time of the last draw
     animated_image_t *image;
     spritesheet_sequence_t *sequence;
 } animated_sequence_instance_t;
 
-typedef struct clear_data {
-    unsigned int colour;
-} clear_data_t;
-
-typedef struct arc_data {
-    signed short x;
-    signed short y;
-    signed short radius;
-    signed short start;
-    signed short end;
-    unsigned int colour;
-} arc_data_t;
-
-typedef struct ellipse_data {
-    signed short x;
-    signed short y;
-    signed short rx;
-    signed short ry;
-    unsigned int colour;
-} ellipse_data_t;
-
-typedef struct rect_data {
-    signed short x;
-    signed short y;
-    signed short w;
-    signed short h;
-    unsigned int colour;
-} rect_data_t;
-
-typedef struct circle_data {
-    signed short x;
-    signed short y;
-    signed short radius;
-    unsigned int colour;
-} circle_data_t;
-
-typedef struct line_data {
-    signed short x1;
-    signed short y1;
-    signed short x2;
-    signed short y2;
-    unsigned char thickness;
-    unsigned int colour;
-} line_data_t;
-
-typedef struct poly_data {
-    coord_t *points;
-    unsigned int n;
-    unsigned int colour;
-} poly_data_t;
-
-typedef struct triangle_data {
-    coord_t *points;
-    unsigned int colour;
-} triangle_data_t;
-
-typedef struct image_data {
-    char *filename;
-    SDL_Texture *tex;
-    signed short x;
-    signed short y;
-} image_data_t;
-
-typedef struct loaded_image_data {
-    loaded_image_t *img;
-    signed short x;
-    signed short y;
-} loaded_image_data_t;
-
-typedef struct scaled_image_data {
-    image_data_t image;
-    float scale;
-} scaled_image_data_t;
-
-typedef struct text_data {
-    char *str;
-    signed short x;
-    signed short y;
-    unsigned int colour;
-    TTF_Font *font;
-} text_data_t;
-
-typedef struct arrow_data {
-    signed short x1;
-    signed short y1;
-    signed short x2;
-    signed short y2;
-    signed short head_length;
-    unsigned char thickness;
-    unsigned int colour;
-} arrow_data_t;
-
-union data_u {
-    clear_data_t clear;
-    arc_data_t arc;
-    ellipse_data_t ellipse;
-    rect_data_t rect;
-    circle_data_t circle;
-    line_data_t line;
-    poly_data_t poly;
-    triangle_data_t triangle;
-    image_data_t image;
-    loaded_image_data_t loaded_image;
-    loaded_image_crop_t loaded_image_crop;
-    scaled_image_data_t scaled_image;
-    text_data_t text;
-    arrow_data_t arrow;
-};
-
-typedef struct draw_job {
-    draw_job_type_t type;
-    union data_u *data;
-
-    struct draw_job *next;
-} draw_job_t;
-
 pthread_mutex_t job_list_lock = PTHREAD_MUTEX_INITIALIZER;
+GFX_LOCK_STATS(job_list_lock_stats, "job_list_lock");
 draw_job_t job_list_head = { 0 };
+draw_job_t *job_list_tail = &job_list_head;
 
 struct global_offsets {
     int x;
@@ -261,8 +117,14 @@ struct global_offsets {
 struct global_offsets global_offset = {
     .lock = PTHREAD_MUTEX_INITIALIZER,
 };
+GFX_LOCK_STATS(global_offset_lock_stats, "global_offset.lock");
 
 pthread_mutex_t loaded_images_lock = PTHREAD_MUTEX_INITIALIZER;
+GFX_LOCK_STATS(loaded_images_lock_stats, "loaded_images_lock");
+
+// SDL_ttf fonts may not be used from multiple threads at once
+pthread_mutex_t ttf_lock = PTHREAD_MUTEX_INITIALIZER;
+GFX_LOCK_STATS(ttf_lock_stats, "ttf_lock");
 loaded_image_t loaded_images_list = { 0 };
 
 const int screen_height = SCREEN_HEIGHT;
@@ -270,10 +132,30 @@ const int screen_width = SCREEN_WIDTH;
 
 SDL_Window *window = NULL;
 SDL_Renderer *renderer = NULL;
+unsigned renderer_generation = 0;
 SDL_GLContext context = NULL;
 
 char *error_message = NULL;
 
+// Emulator's end of split mode, see gfxDrawSetViewerSocket()
+static struct split_mode {
+    const char *socket_path;
+    gfx_remote_handle_t channel; // NULL unless in split mode
+    unsigned char *frame; // Frame being encoded
+    size_t frame_len;
+    size_t frame_size;
+    unsigned char incomplete; // A record did not fit into memory
+    unsigned char resync; // The viewer missed records, it must start over
+    unsigned int image_ids; // Last ID given to an image
+    uint32_t *released; // IDs of sent images freed since the last frame
+    unsigned int n_released;
+    unsigned int released_size;
+    unsigned char unsupported[DRAW_JOB_TYPE_COUNT]; // Warned about
+    unsigned long dropped;
+    pthread_mutex_t lock; // Guards released
+} split_mode = { .resync = 1, .lock = PTHREAD_MUTEX_INITIALIZER };
+GFX_LOCK_STATS(split_mode_lock_stats, "split_mode.lock");
+
 static uint32_t swapBytes(unsigned int x)
 {
     return ((x &FIRST_BYTE) << THREE_BYTES) +
@@ -295,62 +177,36 @@ void _setErrorMessage(char *msg)
     strcpy(error_message, msg);
 }
 
-#define PRINT_SDL_ERROR(msg, ...)                                              \
-    PRINT_ERROR("[SDL Error] %s\n" #msg, (char *)SDL_GetError(),           \
-                ##__VA_ARGS__)
-
-static draw_job_t *_pushDrawJob(void)
+// Jobs are only published once they have been completely filled in
+void gfxDrawPushJob(draw_job_t *job)
 {
-    draw_job_t *iterator;
-    draw_job_t *job = calloc(1, sizeof(draw_job_t));
-    if (job == NULL) {
-        return NULL;
-    }
+    GFX_MUTEX_LOCK(&job_list_lock, job_list_lock_stats);
 
-    pthread_mutex_lock(&job_list_lock);
+    job_list_tail->next = job;
+    job_list_tail = job;
 
-    for (iterator = &job_list_head; iterator->next;
-         iterator = iterator->next)
-        ;
-
-    iterator->next = job;
-
-    pthread_mutex_unlock(&job_list_lock);
-
-    return job;
+    GFX_MUTEX_UNLOCK(&job_list_lock, job_list_lock_stats);
 }
 
-static int _waitingDrawJobs(void)
+void gfxDrawDiscardJob(draw_job_t *job)
 {
-    int ret = 1;
-
-    pthread_mutex_lock(&job_list_lock);
-
-    if (job_list_head.next == NULL) {
-        ret = 0;
-    }
-
-    pthread_mutex_unlock(&job_list_lock);
-
-    return ret;
+    gfxUtilMemSub(GFX_MEM_JOBS, job->bytes);
+    free(job->data);
+    free(job);
 }
 
-static draw_job_t *popDrawJob(void)
+// Detaches all queued jobs so they can be handled without holding the lock
+static draw_job_t *_takeDrawJobs(void)
 {
-    draw_job_t *ret = job_list_head.next;
+    draw_job_t *ret;
 
-    if (ret) {
-        pthread_mutex_lock(&job_list_lock);
+    GFX_MUTEX_LOCK(&job_list_lock, job_list_lock_stats);
 
-        if (ret->next) {
-            job_list_head.next = ret->next;
-        }
-        else {
-            job_list_head.next = NULL;
-        }
+    ret = job_list_head.next;
+    job_list_head.next = NULL;
+    job_list_tail = &job_list_head;
 
-        pthread_mutex_unlock(&job_list_lock);
-    }
+    GFX_MUTEX_UNLOCK(&job_list_lock, job_list_lock_stats);
 
     return ret;
 }
@@ -383,453 +239,2172 @@ static int _drawFilledRectangle(signed short x, signed short y, signed short w,
     return 0;
 }
 
-static int _drawArc(signed short x, signed short y, signed short radius,
-                    signed short start, signed short end, unsigned int colour)
+#define TESS_MIN_SEGMENTS 8
+#define TESS_MAX_SEGMENTS 512
+
+enum tess_shape {
+    TESS_NONE = 0,
+    TESS_FILLED_CIRCLE,
+    TESS_ELLIPSE,
+    TESS_ARC,
+};
+
+typedef struct tess_key {
+    enum tess_shape shape;
+    signed short rx;
+    signed short ry;
+    signed short start;
+    signed short end;
+    unsigned char thickness;
+} tess_key_t;
+
+typedef struct tess_entry {
+    tess_key_t key;
+    SDL_FPoint *points; // Relative to the shape's centre pixel
+    int *indices;
+    unsigned int n_points;
+    unsigned int n_indices;
+    unsigned long last_used;
+} tess_entry_t;
+
+// Only touched by the GL thread, apart from the stats
+static struct tess_cache {
+    tess_entry_t entries[GFX_TESS_CACHE_SIZE];
+    unsigned int count;
+    unsigned long tick;
+
+    gfx_tess_stats_t stats;
+} tess = { 0 };
+
+static struct geometry_batch geometry = { 0 };
+
+int gfxDrawReserveMesh(struct geometry_batch *mesh, unsigned int n_verts,
+                       unsigned int n_indices)
 {
-    arcColor(renderer, x, y, radius, start, end,
-             swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+    if (mesh->n_verts + n_verts > mesh->verts_size) {
+        unsigned int size = (mesh->n_verts + n_verts) * 2;
+        SDL_Vertex *verts = realloc(mesh->verts, size * sizeof(SDL_Vertex));
+
+        if (verts == NULL) {
+            PRINT_ERROR("Failed to grow geometry batch");
+            return -1;
+        }
+        mesh->verts = verts;
+        mesh->verts_size = size;
+    }
+
+    if (mesh->n_indices + n_indices > mesh->indices_size) {
+        unsigned int size = (mesh->n_indices + n_indices) * 2;
+        int *indices = realloc(mesh->indices, size * sizeof(int));
+
+        if (indices == NULL) {
+            PRINT_ERROR("Failed to grow geometry batch");
+            return -1;
+        }
+        mesh->indices = indices;
+        mesh->indices_size = size;
+    }
 
     return 0;
 }
 
-static int _drawEllipse(signed short x, signed short y, signed short rx,
-                        signed short ry, unsigned int colour)
+static void _flushGeometry(void)
 {
-    ellipseColor(renderer, x, y, rx, ry,
-                 swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+    if (geometry.n_indices) {
+        SDL_RenderGeometry(renderer, NULL, geometry.verts, geometry.n_verts,
+                           geometry.indices, geometry.n_indices);
+        __atomic_add_fetch(&tess.stats.batches, 1, __ATOMIC_RELAXED);
+    }
 
-    return 0;
+    geometry.n_verts = 0;
+    geometry.n_indices = 0;
 }
 
-static int _drawCircle(signed short x, signed short y, signed short radius,
-                       unsigned int colour)
+unsigned int gfxDrawTessSegments(float radius, float span)
 {
-    filledCircleColor(renderer, x, y, radius,
-                      swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+    float step = radius > TESS_TOLERANCE ?
+                 2 * acosf(1 - TESS_TOLERANCE / radius) : span;
+    unsigned int segments = ceilf(span / step);
 
-    return 0;
+    if (segments < TESS_MIN_SEGMENTS) {
+        return TESS_MIN_SEGMENTS;
+    }
+    if (segments > TESS_MAX_SEGMENTS) {
+        return TESS_MAX_SEGMENTS;
+    }
+    return segments;
 }
 
-static int _drawLine(signed short x1, signed short y1, signed short x2,
-                     signed short y2, unsigned char thickness,
-                     unsigned int colour)
+static int _tessellate(tess_entry_t *entry)
 {
-    thickLineColor(renderer, x1, y1, x2, y2, thickness,
-                   swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+    tess_key_t *key = &entry->key;
+    unsigned int i, segments, ring;
+
+    if (key->shape == TESS_FILLED_CIRCLE) {
+        // Triangle fan covering the pixels up to radius from the centre
+        float r = key->rx + 0.5;
+
+        segments = gfxDrawTessSegments(r, 2 * TESS_PI);
+        entry->n_points = segments + 1;
+        entry->n_indices = segments * 3;
+        entry->points = malloc(entry->n_points * sizeof(SDL_FPoint));
+        entry->indices = malloc(entry->n_indices * sizeof(int));
+        if (entry->points == NULL || entry->indices == NULL) {
+            goto err;
+        }
+
+        entry->points[0] = (SDL_FPoint) {
+            0, 0
+        };
+        for (i = 0; i < segments; i++) {
+            float a = 2 * TESS_PI * i / segments;
+
+            entry->points[i + 1] = (SDL_FPoint) {
+                r *cosf(a), r *sinf(a)
+            };
+            entry->indices[i * 3] = 0;
+            entry->indices[i * 3 + 1] = i + 1;
+            entry->indices[i * 3 + 2] = (i + 1) % segments + 1;
+        }
+
+        return 0;
+    }
+
+    // Outlines are a band of the key's thickness centred on the curve,
+    // angles start to the right and increase clockwise
+    float half = key->thickness / 2.0;
+    float start = 0, span = 2 * TESS_PI;
+    unsigned char closed = 1;
+
+    if (key->shape == TESS_ARC) {
+        int degrees = ((key->end - key->start) % 360 + 360) % 360;
+
+        if (degrees) {
+            start = key->start * TESS_PI / 180;
+            span = degrees * TESS_PI / 180;
+            closed = 0;
+        }
+    }
+
+    segments = gfxDrawTessSegments((key->rx > key->ry ? key->rx : key->ry) +
+                                   half, span);
+    ring = closed ? segments : segments + 1;
+    entry->n_points = ring * 2;
+    entry->n_indices = segments * 6;
+    entry->points = malloc(entry->n_points * sizeof(SDL_FPoint));
+    entry->indices = malloc(entry->n_indices * sizeof(int));
+    if (entry->points == NULL || entry->indices == NULL) {
+        goto err;
+    }
+
+    float inner_x = key->rx > half ? key->rx - half : 0;
+    float inner_y = key->ry > half ? key->ry - half : 0;
+
+    for (i = 0; i < ring; i++) {
+        float a = start + span * i / segments;
+
+        entry->points[i * 2] = (SDL_FPoint) {
+            inner_x *cosf(a), inner_y *sinf(a)
+        };
+        entry->points[i * 2 + 1] = (SDL_FPoint) {
+            (key->rx + half) * cosf(a), (key->ry + half) * sinf(a)
+        };
+    }
+
+    for (i = 0; i < segments; i++) {
+        int in0 = i * 2, out0 = i * 2 + 1;
+        int in1 = ((i + 1) % ring) * 2, out1 = in1 + 1;
+
+        entry->indices[i * 6] = in0;
+        entry->indices[i * 6 + 1] = out0;
+        entry->indices[i * 6 + 2] = out1;
+        entry->indices[i * 6 + 3] = in0;
+        entry->indices[i * 6 + 4] = out1;
+        entry->indices[i * 6 + 5] = in1;
+    }
 
     return 0;
+
+err:
+    PRINT_ERROR("Failed to allocate tessellated shape");
+    free(entry->points);
+    free(entry->indices);
+    entry->points = NULL;
+    entry->indices = NULL;
+    return -1;
+}
+
+static void _tessFreeEntry(tess_entry_t *entry)
+{
+    __atomic_sub_fetch(&tess.stats.vertices, entry->n_points,
+                       __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&tess.stats.entries, 1, __ATOMIC_RELAXED);
+    free(entry->points);
+    free(entry->indices);
+    memset(entry, 0, sizeof(tess_entry_t));
 }
 
-static int _drawPoly(coord_t *points, unsigned int n, int x_offset,
-                     int y_offset, signed short colour)
+static tess_entry_t *_tessLookup(tess_key_t *key)
 {
-    signed short *x_coords = calloc(1, sizeof(signed short) * n);
-    signed short *y_coords = calloc(1, sizeof(signed short) * n);
+    tess_entry_t *victim = NULL;
     unsigned int i;
 
-    for (i = 0; i < n; i++) {
-        x_coords[i] = points[i].x + x_offset;
-        y_coords[i] = points[i].y + y_offset;
+    for (i = 0; i < tess.count; i++) {
+        tess_entry_t *entry = &tess.entries[i];
+
+        if (entry->key.shape == key->shape && entry->key.rx == key->rx &&
+            entry->key.ry == key->ry && entry->key.start == key->start &&
+            entry->key.end == key->end &&
+            entry->key.thickness == key->thickness) {
+            entry->last_used = ++tess.tick;
+            __atomic_add_fetch(&tess.stats.hits, 1, __ATOMIC_RELAXED);
+            return entry;
+        }
+
+        if (entry->key.shape == TESS_NONE) {
+            victim = entry;
+        }
+        else if (victim == NULL ||
+                 (victim->key.shape != TESS_NONE &&
+                  entry->last_used < victim->last_used)) {
+            victim = entry;
+        }
     }
 
-    polygonColor(renderer, x_coords, y_coords, n,
-                 swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+    __atomic_add_fetch(&tess.stats.misses, 1, __ATOMIC_RELAXED);
 
-    free(x_coords);
-    free(y_coords);
+    // Prefer unused entries, evicting the least recently used when full
+    if (tess.count < GFX_TESS_CACHE_SIZE &&
+        (victim == NULL || victim->key.shape != TESS_NONE)) {
+        victim = &tess.entries[tess.count++];
+    }
+    else if (victim->key.shape != TESS_NONE) {
+        _tessFreeEntry(victim);
+        __atomic_add_fetch(&tess.stats.evictions, 1, __ATOMIC_RELAXED);
+    }
 
-    return 0;
+    victim->key = *key;
+    if (_tessellate(victim)) {
+        victim->key.shape = TESS_NONE;
+        return NULL;
+    }
+    victim->last_used = ++tess.tick;
+
+    __atomic_add_fetch(&tess.stats.vertices, victim->n_points,
+                       __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tess.stats.entries, 1, __ATOMIC_RELAXED);
+
+    return victim;
 }
 
-static int _drawTriangle(coord_t *points, int x_offset, int y_offset,
-                         unsigned int colour)
+// Queues a cached shape centred on the pixel x, y into the geometry batch
+static int _drawTessellated(tess_key_t *key, signed short x, signed short y,
+                            unsigned int colour)
 {
-    filledTrigonColor(renderer, points[0].x + x_offset,
-                      points[0].y + y_offset, points[1].x + x_offset,
-                      points[1].y + y_offset, points[2].x + x_offset,
-                      points[2].y + y_offset,
-                      swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+    tess_entry_t *entry = _tessLookup(key);
+    SDL_Color c = { RED_PORTION(colour), GREEN_PORTION(colour),
+                    BLUE_PORTION(colour), ALPHA_SOLID
+                  };
+    unsigned int i;
+
+    if (entry == NULL ||
+        gfxDrawReserveMesh(&geometry, entry->n_points, entry->n_indices)) {
+        return -1;
+    }
+
+    for (i = 0; i < entry->n_points; i++)
+        geometry.verts[geometry.n_verts + i] = (SDL_Vertex) {
+        { x + 0.5f + entry->points[i].x, y + 0.5f + entry->points[i].y },
+        c, { 0, 0 }
+    };
+
+    for (i = 0; i < entry->n_indices; i++)
+        geometry.indices[geometry.n_indices + i] =
+            geometry.n_verts + entry->indices[i];
+
+    geometry.n_verts += entry->n_points;
+    geometry.n_indices += entry->n_indices;
 
     return 0;
 }
 
-static SDL_Texture *_loadImage(char *filename, SDL_Renderer *ren)
+void gfxDrawTessCacheGetStats(gfx_tess_stats_t *stats)
 {
-    SDL_Texture *tex =
-        IMG_LoadTexture(ren, gfxUtilFindResourcePath(filename));
-
-    return tex;
+    stats->hits = __atomic_load_n(&tess.stats.hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&tess.stats.misses, __ATOMIC_RELAXED);
+    stats->evictions =
+        __atomic_load_n(&tess.stats.evictions, __ATOMIC_RELAXED);
+    stats->batches = __atomic_load_n(&tess.stats.batches, __ATOMIC_RELAXED);
+    stats->entries = __atomic_load_n(&tess.stats.entries, __ATOMIC_RELAXED);
+    stats->vertices =
+        __atomic_load_n(&tess.stats.vertices, __ATOMIC_RELAXED);
 }
 
-static int _renderCroppedImage(SDL_Texture *tex, SDL_Renderer *ren,
-                               signed short x, signed short y, signed short c_x,
-                               signed short c_y, int w, int h)
+void gfxDrawTessCacheResetStats(void)
 {
-    SDL_Rect src, dst;
-    src.x = c_x;
-    src.y = c_y;
-    src.w = w;
-    src.h = h;
-    dst.x = x;
-    dst.y = y;
-    dst.w = w;
-    dst.h = h;
-    return SDL_RenderCopy(ren, tex, &src, &dst);
+    __atomic_store_n(&tess.stats.hits, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&tess.stats.misses, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&tess.stats.evictions, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&tess.stats.batches, 0, __ATOMIC_RELAXED);
 }
 
-static int _renderScaledImage(SDL_Texture *tex, SDL_Renderer *ren,
-                              signed short x, signed short y, int w, int h)
+static void _flushLineChain(void);
+
+// Shapes below one pixel are drawn by SDL2_gfx right away, after everything
+// batched so far such that they are drawn in job order
+static int _drawArc(signed short x, signed short y, signed short radius,
+                    signed short start, signed short end, unsigned int colour)
 {
-    SDL_Rect dst;
-    dst.w = w;
-    dst.h = h;
-    dst.x = x;
-    dst.y = y;
-    return SDL_RenderCopy(ren, tex, NULL, &dst);
+    tess_key_t key = { .shape = TESS_ARC, .rx = radius, .ry = radius,
+                       .start = start, .end = end, .thickness = 1
+                     };
+
+    if (radius < 1) {
+        _flushLineChain();
+        _flushGeometry();
+        arcColor(renderer, x, y, radius, start, end,
+                 swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+        return 0;
+    }
+
+    return _drawTessellated(&key, x, y, colour);
 }
 
-static int _getImageSize(char *filename, int *w, int *h)
+static int _drawEllipse(signed short x, signed short y, signed short rx,
+                        signed short ry, unsigned int colour)
 {
-    SDL_Texture *tex = _loadImage(filename, renderer);
-    if (tex == NULL) {
-        return -1;
+    tess_key_t key = { .shape = TESS_ELLIPSE, .rx = rx, .ry = ry,
+                       .thickness = 1
+                     };
+
+    if (rx < 1 || ry < 1) {
+        _flushLineChain();
+        _flushGeometry();
+        ellipseColor(renderer, x, y, rx, ry,
+                     swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+        return 0;
     }
-    SDL_QueryTexture(tex, NULL, NULL, w, h);
-    SDL_DestroyTexture(tex);
 
-    return 0;
+    return _drawTessellated(&key, x, y, colour);
 }
 
-gfx_animation_handle_t
-gfxDrawAnimationCreate(gfx_spritesheet_handle_t spritesheet)
+static int _drawCircle(signed short x, signed short y, signed short radius,
+                       unsigned int colour)
 {
-    if (spritesheet == NULL) {
-        PRINT_ERROR("Creating animation requires a valid spritesheet");
-        goto err;
+    tess_key_t key = { .shape = TESS_FILLED_CIRCLE, .rx = radius,
+                       .ry = radius
+                     };
+
+    if (radius < 1) {
+        _flushLineChain();
+        _flushGeometry();
+        filledCircleColor(renderer, x, y, radius,
+                          swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+        return 0;
     }
 
-    animated_image_t *ret = calloc(1, sizeof(animated_image_t));
+    return _drawTessellated(&key, x, y, colour);
+}
 
-    if (ret == NULL) {
-        PRINT_ERROR("Allocating animation failed");
-        goto err;
-    }
+#define LINE_MITER_LIMIT 4.0 // Longest miter, in half line widths
 
-    ret->spritesheet = spritesheet;
+// Drops points coinciding with their predecessor, which would otherwise give
+// segments without a direction, returning how many points remain
+unsigned int gfxDrawUniquePoints(SDL_FPoint *points, unsigned int n,
+                                 unsigned char closed)
+{
+    unsigned int i, count = n ? 1 : 0;
 
-    return (gfx_animation_handle_t)ret;
+    for (i = 1; i < n; i++)
+        if (points[i].x != points[count - 1].x ||
+            points[i].y != points[count - 1].y) {
+            points[count++] = points[i];
+        }
 
-err:
-    return NULL;
+    if (closed && count > 1 && points[count - 1].x == points[0].x &&
+        points[count - 1].y == points[0].y) {
+        count--;
+    }
+
+    return count;
 }
 
-int gfxDrawAnimationAddSequence(
-    gfx_animation_handle_t animation, char *name, unsigned start_row,
-    unsigned start_col,
-    enum sprite_sequence_direction sprite_step_direction, unsigned frames)
+// Strokes at least two unique points as a strip with mitered joins
+int gfxDrawStrokePoints(struct geometry_batch *mesh, const SDL_FPoint *points,
+                        unsigned int n, unsigned char closed,
+                        unsigned char thickness, SDL_Color c)
 {
-    if (animation == NULL) {
-        PRINT_ERROR("Animation handle is not valid");
-        goto err;
+    float half = (thickness ? thickness : 1) / 2.0;
+    unsigned int i, segments;
+
+    if (closed && n < 3) {
+        closed = 0;
     }
+    segments = closed ? n : n - 1;
 
-    if (name == NULL) {
-        PRINT_ERROR("Sequence requires a valid name");
-        goto err;
+    if (gfxDrawReserveMesh(mesh, n * 2, segments * 6)) {
+        return -1;
     }
 
-    animated_image_t *anim = (animated_image_t *)animation;
+    SDL_Vertex *v = &mesh->verts[mesh->n_verts];
+    int *indices = &mesh->indices[mesh->n_indices];
 
-    spritesheet_sequence_t *seq = calloc(1, sizeof(spritesheet_sequence_t));
-    if (seq == NULL) {
-        PRINT_ERROR("Could not allocate animation sequence");
-        goto err;
-    }
+    for (i = 0; i < n; i++) {
+        unsigned char has_prev = closed || i > 0;
+        unsigned char has_next = closed || i + 1 < n;
+        float prev_nx = 0, prev_ny = 0, nx = 0, ny = 0, ox, oy;
 
-    seq->name = strdup(name);
-    if (seq->name == NULL) {
-        PRINT_ERROR("Could not allocate sequence name");
-        goto err_name;
-    }
+        if (has_prev) {
+            const SDL_FPoint *from = &points[i ? i - 1 : n - 1];
+            float dx = points[i].x - from->x, dy = points[i].y - from->y;
+            float length = sqrtf(dx * dx + dy * dy);
 
-    seq->start_row = start_row;
-    seq->start_col = start_col;
-    seq->direction = sprite_step_direction;
-    seq->frames = frames;
+            prev_nx = -dy / length;
+            prev_ny = dx / length;
+        }
 
-    if (anim->sequences == NULL) {
-        anim->sequences = seq;
-    }
-    else {
-        spritesheet_sequence_t *iterator = anim->sequences;
+        if (has_next) {
+            const SDL_FPoint *to = &points[(i + 1) % n];
+            float dx = to->x - points[i].x, dy = to->y - points[i].y;
+            float length = sqrtf(dx * dx + dy * dy);
 
-        for (; iterator->next; iterator = iterator->next)
-            ;
-        iterator->next = seq;
-    }
+            nx = -dy / length;
+            ny = dx / length;
+        }
 
-    return 0;
+        if (has_prev && has_next) {
+            float mx = prev_nx + nx, my = prev_ny + ny;
+            float length = sqrtf(mx * mx + my * my);
 
-err_name:
-    free(seq);
-err:
-    return -1;
-}
-
-gfx_sequence_handle_t
-gfxDrawAnimationSequenceInstantiate(gfx_animation_handle_t animation,
-                                    char *sequence_name,
-                                    unsigned frame_period_ms)
-{
-    if (animation == NULL) {
-        PRINT_ERROR(
-            "Animation provided for sequence instantiation was invalid");
-        goto err;
-    }
+            if (length < 1e-3) { // Line doubles back on itself
+                ox = nx * half;
+                oy = ny * half;
+            }
+            else {
+                float miter = half / ((mx * nx + my * ny) / length);
+
+                if (miter > half * LINE_MITER_LIMIT) {
+                    miter = half * LINE_MITER_LIMIT;
+                }
+                ox = mx / length * miter;
+                oy = my / length * miter;
+            }
+        }
+        else if (has_next) {
+            ox = nx * half;
+            oy = ny * half;
+        }
+        else {
+            ox = prev_nx * half;
+            oy = prev_ny * half;
+        }
 
-    if (sequence_name == NULL) {
-        PRINT_ERROR("Sequence name is invalid");
-        goto err;
+        v[i * 2] = (SDL_Vertex) {
+            { points[i].x + 0.5f + ox, points[i].y + 0.5f + oy }, c, { 0, 0 }
+        };
+        v[i * 2 + 1] = (SDL_Vertex) {
+            { points[i].x + 0.5f - ox, points[i].y + 0.5f - oy }, c, { 0, 0 }
+        };
     }
 
-    if (frame_period_ms == 0) {
-        PRINT_ERROR("Sequence frame period cannot be zero");
-        goto err;
+    for (i = 0; i < segments; i++) {
+        int from = mesh->n_verts + i * 2;
+        int to = mesh->n_verts + ((i + 1) % n) * 2;
+        int *quad = &indices[i * 6];
+
+        quad[0] = from;
+        quad[1] = from + 1;
+        quad[2] = to;
+        quad[3] = from + 1;
+        quad[4] = to + 1;
+        quad[5] = to;
     }
 
-    animated_sequence_instance_t *ret =
-        calloc(1, sizeof(animated_sequence_instance_t));
-    if (ret == NULL) {
-        PRINT_ERROR("Could not create sequence '%s' instance",
-                    sequence_name);
-        goto err;
-    }
+    mesh->n_verts += n * 2;
+    mesh->n_indices += segments * 6;
 
-    ret->image = (animated_image_t *)animation;
+    return 0;
+}
 
-    spritesheet_sequence_t *iterator;
+// Consecutive line jobs that continue each other with the same thickness and
+// colour are joined into a single polyline
+static struct line_chain {
+    SDL_FPoint *points;
+    unsigned int n;
+    unsigned int size;
+    unsigned char thickness;
+    unsigned int colour;
+} line_chain = { 0 };
 
-    for (iterator = ret->image->sequences; iterator;
-         iterator = iterator->next)
-        if (!strcmp(iterator->name, sequence_name)) {
-            ret->sequence = iterator;
-            break;
-        }
+static void _flushLineChain(void)
+{
+    SDL_Color c = { RED_PORTION(line_chain.colour),
+                    GREEN_PORTION(line_chain.colour),
+                    BLUE_PORTION(line_chain.colour), ALPHA_SOLID
+                  };
+    unsigned int n;
 
-    if (ret->sequence == NULL) {
-        PRINT_ERROR("Could not find sequence '%s'", sequence_name);
-        goto err_sequence;
+    if (!line_chain.n) {
+        return;
     }
 
-    ret->frame_period_ms = frame_period_ms;
+    n = gfxDrawUniquePoints(line_chain.points, line_chain.n, 0);
 
-    return ret;
+    if (n > 1) {
+        gfxDrawStrokePoints(&geometry, line_chain.points, n, 0,
+                            line_chain.thickness, c);
+    }
+    else { // Zero length line, leaving nothing for the strip to span
+        _flushGeometry();
+        thickLineColor(renderer, line_chain.points[0].x,
+                       line_chain.points[0].y, line_chain.points[0].x,
+                       line_chain.points[0].y,
+                       line_chain.thickness ? line_chain.thickness : 1,
+                       swapBytes((line_chain.colour << ONE_BYTE) |
+                                 ALPHA_SOLID));
+    }
 
-err_sequence:
-    free(ret);
-err:
-    return NULL;
+    line_chain.n = 0;
 }
 
-static int freeLoadedImage(loaded_image_t **img)
+static int _appendLinePoint(float x, float y)
 {
-    int ret = -1;
-
-    pthread_mutex_lock(&loaded_images_lock);
-    loaded_image_t *iterator = &loaded_images_list;
-    loaded_image_t *delete;
-
-    for (; iterator->next; iterator = iterator->next)
-        if (iterator->next == *img) {
-            break;
+    if (line_chain.n == line_chain.size) {
+        unsigned int size = line_chain.size ? line_chain.size * 2 : 64;
+        SDL_FPoint *points =
+            realloc(line_chain.points, size * sizeof(SDL_FPoint));
+
+        if (points == NULL) {
+            PRINT_ERROR("Failed to grow line chain");
+            line_chain.n = 0;
+            return -1;
         }
+        line_chain.points = points;
+        line_chain.size = size;
+    }
 
-    if (iterator->next == *img) {
-        delete = iterator->next;
+    line_chain.points[line_chain.n++] = (SDL_FPoint) {
+        x, y
+    };
 
-        if (!iterator->next->next) {
-            iterator->next = NULL;
-        }
-        else {
-            iterator->next = delete->next;
-        }
+    return 0;
+}
 
-        SDL_FreeSurface(delete->surf);
-        SDL_RWclose(delete->ops);
-        SDL_DestroyTexture(delete->tex);
-        free(delete->filename);
-        free(delete);
-        *img = (loaded_image_t *)NULL;
+static void _startLineChain(unsigned char thickness, unsigned int colour)
+{
+    _flushLineChain();
+
+    line_chain.thickness = thickness;
+    line_chain.colour = colour;
+}
 
-        ret = 0;
+static int _drawLine(signed short x1, signed short y1, signed short x2,
+                     signed short y2, unsigned char thickness,
+                     unsigned int colour)
+{
+    if (!line_chain.n || line_chain.thickness != thickness ||
+        line_chain.colour != colour ||
+        line_chain.points[line_chain.n - 1].x != x1 ||
+        line_chain.points[line_chain.n - 1].y != y1) {
+        _startLineChain(thickness, colour);
+        if (_appendLinePoint(x1, y1)) {
+            return -1;
+        }
     }
-    pthread_mutex_unlock(&loaded_images_lock);
 
-    return ret;
+    return _appendLinePoint(x2, y2);
 }
 
-static void vPutLoadedImage(gfx_image_handle_t img)
+// Queues a cached mesh, translated by x, y, into the geometry batch
+static int _pushMesh(struct geometry_batch *mesh, int x, int y,
+                     unsigned int colour)
 {
-    loaded_image_t *loaded_img = (loaded_image_t *)img;
-
-    loaded_img->ref_count--;
+    SDL_Color c = { RED_PORTION(colour), GREEN_PORTION(colour),
+                    BLUE_PORTION(colour), ALPHA_SOLID
+                  };
+    unsigned int i;
 
-    if (loaded_img->pending_free && !loaded_img->ref_count) {
-        freeLoadedImage((loaded_image_t **)&img);
+    if (gfxDrawReserveMesh(&geometry, mesh->n_verts, mesh->n_indices)) {
+        return -1;
     }
+
+    for (i = 0; i < mesh->n_verts; i++)
+        geometry.verts[geometry.n_verts + i] = (SDL_Vertex) {
+        {
+            mesh->verts[i].position.x + x, mesh->verts[i].position.y + y
+        }, c, { 0, 0 }
+    };
+
+    for (i = 0; i < mesh->n_indices; i++)
+        geometry.indices[geometry.n_indices + i] =
+            geometry.n_verts + mesh->indices[i];
+
+    geometry.n_verts += mesh->n_verts;
+    geometry.n_indices += mesh->n_indices;
+
+    return 0;
 }
 
-int xDrawLoadedImageCropped(loaded_image_t *img, SDL_Renderer *ren,
-                            signed short x, signed short y, signed short c_x,
-                            signed short c_y, signed short c_w,
-                            signed short c_h)
+static int _drawPath(path_data_t *data, int x_offset, int y_offset)
 {
-    return _renderCroppedImage(img->tex, ren, x, y, c_x, c_y, c_w, c_h);
+    struct geometry_batch *mesh = gfxPathLockMesh(data);
+    int ret;
+
+    if (mesh == NULL) {
+        return -1;
+    }
+
+    ret = _pushMesh(mesh, data->x + x_offset, data->y + y_offset,
+                    data->colour);
+
+    gfxPathUnlockMesh(data->path);
+
+    return ret;
 }
 
-int xDrawLoadedImage(loaded_image_t *img, SDL_Renderer *ren, signed short x,
-                     signed short y)
+// Polygon points are owned by their job, offsets are applied in place
+static void _offsetPoly(poly_data_t *poly, int x_offset, int y_offset)
 {
-    return _renderScaledImage(img->tex, ren, x, y, img->w *img->scale,
-                              img->h *img->scale);
+    unsigned int i;
+
+    if (x_offset || y_offset)
+        for (i = 0; i < poly->n; i++) {
+            poly->x[i] += x_offset;
+            poly->y[i] += y_offset;
+        }
 }
 
-static int _drawScaledImage(SDL_Texture *tex, SDL_Renderer *ren, signed short x,
-                            signed short y, float scale)
+static int _drawPolyline(poly_data_t *poly, int x_offset, int y_offset)
 {
-    int w, h;
-    SDL_QueryTexture(tex, NULL, NULL, &w, &h);
-    if (!w || !h) {
-        return -1;
-    }
+    unsigned int i;
 
-    if (_renderScaledImage(tex, ren, x, y, w * scale, h * scale)) {
-        return -1;
-    }
+    _offsetPoly(poly, x_offset, y_offset);
 
-    SDL_DestroyTexture(tex);
+    _startLineChain(poly->thickness, poly->colour);
+    for (i = 0; i < poly->n; i++)
+        if (_appendLinePoint(poly->x[i], poly->y[i])) {
+            return -1;
+        }
+    _flushLineChain();
 
     return 0;
 }
 
-static int _drawImage(SDL_Texture *tex, SDL_Renderer *ren, signed short x,
-                      signed short y)
+static int _drawPoly(poly_data_t *poly, int x_offset, int y_offset)
 {
-    return _drawScaledImage(tex, ren, x, y, 1);
-}
+    _offsetPoly(poly, x_offset, y_offset);
 
-static int _drawText(char *string, signed short x, signed short y,
-                     unsigned int colour, TTF_Font *font)
-{
-    SDL_Color color = { RED_PORTION(colour), GREEN_PORTION(colour),
-                        BLUE_PORTION(colour), ZERO_ALPHA
-                      };
-    SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
-    gfxFontPutFont(font);
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_Rect dst = { 0 };
-    SDL_QueryTexture(texture, NULL, NULL, &dst.w, &dst.h);
-    dst.x = x;
-    dst.y = y;
-    SDL_RenderCopy(renderer, texture, NULL, &dst);
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
+    polygonColor(renderer, poly->x, poly->y, poly->n,
+                 swapBytes((poly->colour << ONE_BYTE) | ALPHA_SOLID));
 
     return 0;
 }
 
-static int _getTextSize(char *string, int *width, int *height)
+#define POLY_SPAN_BATCH 256
+
+static struct poly_fill_buffer {
+    int *crossings;
+    unsigned int size;
+    SDL_Rect spans[POLY_SPAN_BATCH];
+    unsigned int span_count;
+} poly_fill_buf = { 0 };
+
+static void _flushPolySpans(void)
 {
-    SDL_Color color = { 0 };
-    TTF_Font *font = gfxFontGetCurFont();
-    SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
-    gfxFontPutFont(font);
-    if (surface == NULL) {
-        goto err_surface;
+    if (poly_fill_buf.span_count) {
+        SDL_RenderFillRects(renderer, poly_fill_buf.spans,
+                            poly_fill_buf.span_count);
+        poly_fill_buf.span_count = 0;
     }
+}
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == NULL) {
-        goto err_texture;
+// Even-odd scanline fill, sampling each row at its pixel centres
+static int _drawFilledPoly(poly_data_t *poly, int x_offset, int y_offset)
+{
+    unsigned int i, j, k, count, n = poly->n;
+    int y, min_y = INT_MAX, max_y = INT_MIN;
+
+    if (n > poly_fill_buf.size) {
+        int *crossings = realloc(poly_fill_buf.crossings, n * sizeof(int));
+        if (crossings == NULL) {
+            PRINT_ERROR("Failed to grow polygon fill buffer");
+            return -1;
+        }
+        poly_fill_buf.crossings = crossings;
+        poly_fill_buf.size = n;
     }
 
-    if (SDL_QueryTexture(texture, NULL, NULL, width, height)) {
-        goto err_query;
+    _offsetPoly(poly, x_offset, y_offset);
+
+    for (i = 0; i < n; i++) {
+        if (poly->y[i] < min_y) {
+            min_y = poly->y[i];
+        }
+        if (poly->y[i] > max_y) {
+            max_y = poly->y[i];
+        }
     }
 
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
+    // Rows outside of the screen produce no visible spans
+    if (min_y < 0) {
+        min_y = 0;
+    }
+    if (max_y > SCREEN_HEIGHT) {
+        max_y = SCREEN_HEIGHT;
+    }
+
+    SDL_SetRenderDrawColor(renderer, RED_PORTION(poly->colour),
+                           GREEN_PORTION(poly->colour),
+                           BLUE_PORTION(poly->colour), ALPHA_SOLID);
+
+    for (y = min_y; y < max_y; y++) {
+        float scan_y = y + 0.5;
+
+        for (count = 0, i = 0, j = n - 1; i < n; j = i++) {
+            float y0 = poly->y[j], y1 = poly->y[i];
+
+            if ((y0 <= scan_y) != (y1 <= scan_y)) {
+                float x = poly->x[j] + (scan_y - y0) *
+                          (poly->x[i] - poly->x[j]) / (y1 - y0);
+                poly_fill_buf.crossings[count++] = ceilf(x - 0.5);
+            }
+        }
+
+        for (i = 1; i < count; i++) {
+            int crossing = poly_fill_buf.crossings[i];
+
+            for (k = i; k && poly_fill_buf.crossings[k - 1] > crossing; k--) {
+                poly_fill_buf.crossings[k] = poly_fill_buf.crossings[k - 1];
+            }
+            poly_fill_buf.crossings[k] = crossing;
+        }
+
+        for (i = 0; i + 1 < count; i += 2) {
+            int x0 = poly_fill_buf.crossings[i];
+            int x1 = poly_fill_buf.crossings[i + 1];
+
+            if (x1 <= x0) {
+                continue;
+            }
+
+            if (poly_fill_buf.span_count == POLY_SPAN_BATCH) {
+                _flushPolySpans();
+            }
+
+            poly_fill_buf.spans[poly_fill_buf.span_count++] =
+            (SDL_Rect) {
+                x0, y, x1 - x0, 1
+            };
+        }
+    }
+
+    _flushPolySpans();
 
     return 0;
+}
 
-err_query:
-    SDL_DestroyTexture(texture);
-err_texture:
-    SDL_FreeSurface(surface);
-err_surface:
-    return -1;
+static int _drawTriangle(coord_t *points, int x_offset, int y_offset,
+                         unsigned int colour)
+{
+    filledTrigonColor(renderer, points[0].x + x_offset,
+                      points[0].y + y_offset, points[1].x + x_offset,
+                      points[1].y + y_offset, points[2].x + x_offset,
+                      points[2].y + y_offset,
+                      swapBytes((colour << ONE_BYTE) | ALPHA_SOLID));
+
+    return 0;
 }
 
-static int _drawArrow(signed short x1, signed short y1, signed short x2,
-                      signed short y2, signed short head_length,
-                      unsigned char thickness, unsigned int colour)
+static SDL_Texture *_loadImage(char *filename, SDL_Renderer *ren)
 {
-    // Line vector
-    unsigned short dx = x2 - x1;
-    unsigned short dy = y2 - y1;
+    SDL_Texture *tex =
+        IMG_LoadTexture(ren, gfxUtilFindResourcePath(filename));
 
-    // Normalize
-    float length = sqrt(dx *dx + dy *dy);
-    signed short unit_dx = (signed short)(dx / length);
-    signed short unit_dy = (signed short)(dy / length);
-
-    signed short head_x1 =
-        roundf(x2 - unit_dx *head_length - unit_dy *head_length);
-    signed short head_y1 =
-        roundf(y2 - unit_dy *head_length + unit_dx *head_length);
-
-    signed short head_x2 =
-        roundf(x2 - unit_dx *head_length + unit_dy *head_length);
-    signed short head_y2 =
-        roundf(y2 - unit_dy *head_length - unit_dx *head_length);
-
-    if (thickLineColor(renderer, x1, y1, x2, y2, thickness,
-                       swapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
-        return -1;
-    }
-    if (thickLineColor(renderer, head_x1, head_y1, x2, y2, thickness,
-                       swapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
-        return -1;
-    }
-    if (thickLineColor(renderer, head_x2, head_y2, x2, y2, thickness,
-                       swapBytes((colour << ONE_BYTE) | ALPHA_SOLID))) {
-        return -1;
-    }
+    return tex;
+}
 
-    return 0;
+static int _renderCroppedImage(SDL_Texture *tex, SDL_Renderer *ren,
+                               signed short x, signed short y, signed short c_x,
+                               signed short c_y, int w, int h)
+{
+    SDL_Rect src, dst;
+    src.x = c_x;
+    src.y = c_y;
+    src.w = w;
+    src.h = h;
+    dst.x = x;
+    dst.y = y;
+    dst.w = w;
+    dst.h = h;
+    return SDL_RenderCopy(ren, tex, &src, &dst);
 }
 
-static int vHandleDrawJob(draw_job_t *job)
+static int _renderScaledImage(SDL_Texture *tex, SDL_Renderer *ren,
+                              signed short x, signed short y, int w, int h)
 {
-    int ret = 0;
-    static int x_offset = 0;
-    static int y_offset = 0;
-    ;
-    if (!pthread_mutex_unlock(&global_offset.lock)) {
-        x_offset = global_offset.x;
-        y_offset = global_offset.y;
-    }
-    else {
-        return -1;
-    }
+    SDL_Rect dst;
+    dst.w = w;
+    dst.h = h;
+    dst.x = x;
+    dst.y = y;
+    return SDL_RenderCopy(ren, tex, NULL, &dst);
+}
 
-    if (job == NULL) {
+static int _getImageSize(char *filename, int *w, int *h)
+{
+    SDL_Texture *tex = _loadImage(filename, renderer);
+    if (tex == NULL) {
         return -1;
     }
+    SDL_QueryTexture(tex, NULL, NULL, w, h);
+    SDL_DestroyTexture(tex);
 
-    if (job->data == NULL) {
-        return -1;
-    }
+    return 0;
+}
+
+gfx_animation_handle_t
+gfxDrawAnimationCreate(gfx_spritesheet_handle_t spritesheet)
+{
+    if (spritesheet == NULL) {
+        PRINT_ERROR("Creating animation requires a valid spritesheet");
+        goto err;
+    }
+
+    animated_image_t *ret = calloc(1, sizeof(animated_image_t));
+
+    if (ret == NULL) {
+        PRINT_ERROR("Allocating animation failed");
+        goto err;
+    }
+
+    ret->spritesheet = spritesheet;
+
+    return (gfx_animation_handle_t)ret;
+
+err:
+    return NULL;
+}
+
+int gfxDrawAnimationAddSequence(
+    gfx_animation_handle_t animation, char *name, unsigned start_row,
+    unsigned start_col,
+    enum sprite_sequence_direction sprite_step_direction, unsigned frames)
+{
+    if (animation == NULL) {
+        PRINT_ERROR("Animation handle is not valid");
+        goto err;
+    }
+
+    if (name == NULL) {
+        PRINT_ERROR("Sequence requires a valid name");
+        goto err;
+    }
+
+    if (frames == 0) {
+        PRINT_ERROR("Sequence requires at least one frame");
+        goto err;
+    }
+
+    animated_image_t *anim = (animated_image_t *)animation;
+
+    spritesheet_sequence_t *seq = calloc(1, sizeof(spritesheet_sequence_t));
+    if (seq == NULL) {
+        PRINT_ERROR("Could not allocate animation sequence");
+        goto err;
+    }
+
+    seq->name = strdup(name);
+    if (seq->name == NULL) {
+        PRINT_ERROR("Could not allocate sequence name");
+        goto err_name;
+    }
+
+    seq->start_row = start_row;
+    seq->start_col = start_col;
+    seq->direction = sprite_step_direction;
+    seq->frames = frames;
+
+    spritesheet_t *sheet = anim->spritesheet;
+
+    if ((sprite_step_direction == SPRITE_SEQUENCE_HORIZONTAL_POS ||
+         sprite_step_direction == SPRITE_SEQUENCE_HORIZONTAL_NEG) ?
+        (start_row >= sheet->sprite_rows ||
+         start_col + frames > sheet->sprite_cols) :
+        (start_col >= sheet->sprite_cols ||
+         start_row + frames > sheet->sprite_rows)) {
+        PRINT_ERROR("Sequence '%s' does not fit on its spritesheet", name);
+        goto err_rects;
+    }
+
+    seq->rects = calloc(frames, sizeof(SDL_Rect));
+    if (seq->rects == NULL) {
+        PRINT_ERROR("Could not allocate sequence frame rects");
+        goto err_rects;
+    }
+
+    unsigned i;
+
+    for (i = 0; i < frames; i++) {
+        // Negative sequences step backwards from their first frame
+        unsigned cell = (sprite_step_direction ==
+                         SPRITE_SEQUENCE_HORIZONTAL_NEG ||
+                         sprite_step_direction ==
+                         SPRITE_SEQUENCE_VERTICAL_NEG) ?
+                        (frames - i) % frames : i;
+
+        if (sprite_step_direction == SPRITE_SEQUENCE_HORIZONTAL_POS ||
+            sprite_step_direction == SPRITE_SEQUENCE_HORIZONTAL_NEG)
+            seq->rects[i] = sheet->cells[start_row * sheet->sprite_cols +
+                                         start_col + cell];
+        else
+            seq->rects[i] = sheet->cells[(start_row + cell) *
+                                         sheet->sprite_cols + start_col];
+    }
+
+    if (anim->sequences == NULL) {
+        anim->sequences = seq;
+    }
+    else {
+        spritesheet_sequence_t *iterator = anim->sequences;
+
+        for (; iterator->next; iterator = iterator->next)
+            ;
+        iterator->next = seq;
+    }
+
+    return 0;
+
+err_rects:
+    free(seq->name);
+err_name:
+    free(seq);
+err:
+    return -1;
+}
+
+gfx_sequence_handle_t
+gfxDrawAnimationSequenceInstantiate(gfx_animation_handle_t animation,
+                                    char *sequence_name,
+                                    unsigned frame_period_ms)
+{
+    if (animation == NULL) {
+        PRINT_ERROR(
+            "Animation provided for sequence instantiation was invalid");
+        goto err;
+    }
+
+    if (sequence_name == NULL) {
+        PRINT_ERROR("Sequence name is invalid");
+        goto err;
+    }
+
+    if (frame_period_ms == 0) {
+        PRINT_ERROR("Sequence frame period cannot be zero");
+        goto err;
+    }
+
+    animated_sequence_instance_t *ret =
+        calloc(1, sizeof(animated_sequence_instance_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Could not create sequence '%s' instance",
+                    sequence_name);
+        goto err;
+    }
+
+    ret->image = (animated_image_t *)animation;
+    ret->clock_timestamp = gfxDrawFrameClockGetMs();
+
+    spritesheet_sequence_t *iterator;
+
+    for (iterator = ret->image->sequences; iterator;
+         iterator = iterator->next)
+        if (!strcmp(iterator->name, sequence_name)) {
+            ret->sequence = iterator;
+            break;
+        }
+
+    if (ret->sequence == NULL) {
+        PRINT_ERROR("Could not find sequence '%s'", sequence_name);
+        goto err_sequence;
+    }
+
+    ret->frame_period_ms = frame_period_ms;
+
+    return ret;
+
+err_sequence:
+    free(ret);
+err:
+    return NULL;
+}
+
+static size_t _textureBytes(SDL_Texture *tex)
+{
+    Uint32 format;
+    int w, h;
+
+    if (SDL_QueryTexture(tex, &format, NULL, &w, &h)) {
+        return 0;
+    }
+
+    return (size_t)w * h * SDL_BYTESPERPIXEL(format);
+}
+
+// Accounts for a texture that is kept across frames
+SDL_Texture *gfxDrawTrackTexture(SDL_Texture *tex)
+{
+    if (tex) {
+        gfxUtilMemAdd(GFX_MEM_TEXTURES, _textureBytes(tex));
+    }
+
+    return tex;
+}
+
+void gfxDrawDestroyTexture(SDL_Texture *tex)
+{
+    gfxUtilMemSub(GFX_MEM_TEXTURES, _textureBytes(tex));
+    SDL_DestroyTexture(tex);
+}
+
+static size_t _surfaceBytes(SDL_Surface *surf)
+{
+    return surf ? (size_t)surf->pitch * surf->h : 0;
+}
+
+static void _freeSurface(SDL_Surface *surf)
+{
+    gfxUtilMemSub(GFX_MEM_SURFACES, _surfaceBytes(surf));
+    SDL_FreeSurface(surf);
+}
+
+static struct memory_budget {
+    size_t bytes; // 0 when no budget is set
+    unsigned long frame; // Frames presented, stamps when caches are used
+    unsigned long evictions;
+} memory_budget = { 0 };
+
+// Drops everything of an image that is recreated when next drawn, returning
+// whether there was anything to drop
+static unsigned char _evictLoadedImage(loaded_image_t *img)
+{
+    unsigned char ret = img->tex != NULL;
+    unsigned i;
+
+    for (i = 0; i < GFX_IMAGE_MIP_LEVELS; i++) {
+        if (img->mips[i].tex) {
+            gfxDrawDestroyTexture(img->mips[i].tex);
+            img->mips[i].tex = NULL;
+        }
+        if (img->mips[i].surf) {
+            _freeSurface(img->mips[i].surf);
+            img->mips[i].surf = NULL;
+            ret = 1;
+        }
+    }
+
+    if (img->tex) {
+        gfxDrawDestroyTexture(img->tex);
+        img->tex = NULL;
+    }
+
+    return ret;
+}
+
+// Called from any thread, the viewer is told with the next frame
+static void _splitReleaseImage(loaded_image_t *img)
+{
+    uint32_t *released;
+    unsigned int size;
+
+    GFX_MUTEX_LOCK(&split_mode.lock, split_mode_lock_stats);
+
+    if (split_mode.n_released == split_mode.released_size) {
+        size = split_mode.released_size ? split_mode.released_size * 2 : 16;
+        released = realloc(split_mode.released, size * sizeof(uint32_t));
+        if (released == NULL) {
+            // The viewer is reset instead, freeing all images it has
+            split_mode.resync = 1;
+            goto unlock;
+        }
+        split_mode.released = released;
+        split_mode.released_size = size;
+    }
+
+    split_mode.released[split_mode.n_released++] = img->remote_id;
+
+unlock:
+    GFX_MUTEX_UNLOCK(&split_mode.lock, split_mode_lock_stats);
+}
+
+static void _destroyLoadedImage(loaded_image_t *img)
+{
+    if (img->remote_sent) {
+        _splitReleaseImage(img);
+    }
+    _evictLoadedImage(img);
+    _freeSurface(img->surf);
+    SDL_FreeSurface(img->reload);
+    SDL_RWclose(img->ops);
+    free(img->filename);
+    free(img);
+}
+
+static int freeLoadedImage(loaded_image_t **img)
+{
+    loaded_image_t *delete = NULL;
+
+    GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+    loaded_image_t *iterator = &loaded_images_list;
+
+    for (; iterator->next; iterator = iterator->next)
+        if (iterator->next == *img) {
+            delete = iterator->next;
+            iterator->next = delete->next;
+            break;
+        }
+    GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+
+    if (delete == NULL) {
+        return -1;
+    }
+
+    _destroyLoadedImage(delete);
+    *img = (loaded_image_t *)NULL;
+
+    return 0;
+}
+
+static unsigned char loaded_images_pending_free = 0;
+
+void vGetLoadedImage(loaded_image_t *img)
+{
+    __atomic_add_fetch(&img->ref_count, 1, __ATOMIC_RELAXED);
+}
+
+// Textures may only be destroyed from the GL thread, images released
+// elsewhere are freed by the next gfxDrawUpdateScreen()
+void vPutLoadedImage(gfx_image_handle_t img)
+{
+    loaded_image_t *loaded_img = (loaded_image_t *)img;
+
+    if (__atomic_sub_fetch(&loaded_img->ref_count, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    if (!gfxUtilIsCurGLThread()) {
+        freeLoadedImage((loaded_image_t **)&img);
+    }
+    else {
+        __atomic_store_n(&loaded_img->pending_free, 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&loaded_images_pending_free, 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void _reapLoadedImages(void)
+{
+    loaded_image_t *iterator, *delete, *reaped = NULL;
+
+    if (!__atomic_exchange_n(&loaded_images_pending_free, 0,
+                             __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+    for (iterator = &loaded_images_list; iterator->next;) {
+        if (__atomic_load_n(&iterator->next->pending_free,
+                            __ATOMIC_ACQUIRE)) {
+            delete = iterator->next;
+            iterator->next = delete->next;
+            delete->next = reaped;
+            reaped = delete;
+        }
+        else {
+            iterator = iterator->next;
+        }
+    }
+    GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+
+    while (reaped) {
+        delete = reaped;
+        reaped = reaped->next;
+        _destroyLoadedImage(delete);
+    }
+}
+
+static unsigned char loaded_images_pending_reload = 0;
+
+static const char *_imageFileName(loaded_image_t *img)
+{
+    const char *ret = strrchr(img->filename, '/');
+
+    return ret ? ret + 1 : img->filename;
+}
+
+// Resource listener, decodes a changed image file for every loaded image
+// that was loaded from it
+static void _reloadChangedImage(const char *name, const char *path)
+{
+    loaded_image_t *iterator;
+    SDL_Surface *surf, *copy;
+    unsigned char found = 0, used = 0;
+
+    GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+    for (iterator = loaded_images_list.next; iterator && !found;
+         iterator = iterator->next)
+        if (!strcmp(_imageFileName(iterator), name)) {
+            found = 1;
+        }
+    GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+
+    if (!found) {
+        return;
+    }
+
+    surf = IMG_Load(path);
+    if (surf == NULL) {
+        PRINT_SDL_ERROR("Failed to reload image '%s'", path);
+        return;
+    }
+
+    GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+    for (iterator = loaded_images_list.next; iterator;
+         iterator = iterator->next) {
+        if (strcmp(_imageFileName(iterator), name)) {
+            continue;
+        }
+
+        // Images loaded from the same file each get their own surface
+        copy = used ? SDL_ConvertSurfaceFormat(surf, surf->format->format, 0)
+               : surf;
+        if (copy == NULL) {
+            PRINT_SDL_ERROR("Failed to copy reloaded image '%s'", path);
+            continue;
+        }
+
+        SDL_FreeSurface(iterator->reload);
+        iterator->reload = copy;
+        used = 1;
+    }
+    __atomic_store_n(&loaded_images_pending_reload, 1, __ATOMIC_RELEASE);
+    GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+
+    if (!used) {
+        SDL_FreeSurface(surf);
+    }
+}
+
+// Swaps hot-reloaded surfaces into their images, the textures and
+// downscaled variants of the old surface are recreated when next drawn
+static void _applyImageReloads(void)
+{
+    loaded_image_t *iterator;
+
+    if (!__atomic_exchange_n(&loaded_images_pending_reload, 0,
+                             __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+    for (iterator = loaded_images_list.next; iterator;
+         iterator = iterator->next) {
+        if (iterator->reload == NULL) {
+            continue;
+        }
+
+        _evictLoadedImage(iterator);
+        _freeSurface(iterator->surf);
+        iterator->surf = iterator->reload;
+        iterator->reload = NULL;
+        gfxUtilMemAdd(GFX_MEM_SURFACES, _surfaceBytes(iterator->surf));
+
+        iterator->w = iterator->surf->w;
+        iterator->h = iterator->surf->h;
+        iterator->version++;
+    }
+    GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+}
+
+// Evicts the caches of the least recently drawn images until the accounted
+// memory fits the budget, images drawn this frame are kept
+static void _enforceMemoryBudget(void)
+{
+    size_t budget = __atomic_load_n(&memory_budget.bytes, __ATOMIC_RELAXED);
+    loaded_image_t *iterator, *lru;
+
+    if (budget && gfxUtilMemTotal() > budget) {
+        GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+
+        while (gfxUtilMemTotal() > budget) {
+            lru = NULL;
+            for (iterator = loaded_images_list.next; iterator;
+                 iterator = iterator->next)
+                if (iterator->last_used != memory_budget.frame &&
+                    (iterator->tex || iterator->mips[0].surf) &&
+                    (!lru || iterator->last_used < lru->last_used)) {
+                    lru = iterator;
+                }
+
+            if (lru == NULL || !_evictLoadedImage(lru)) {
+                break;
+            }
+            __atomic_add_fetch(&memory_budget.evictions, 1,
+                               __ATOMIC_RELAXED);
+        }
+
+        GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+    }
+
+    memory_budget.frame++;
+}
+
+// Textures are created on first use as images can be loaded from any thread
+SDL_Texture *gfxDrawGetImageTexture(loaded_image_t *img)
+{
+    img->last_used = memory_budget.frame;
+
+    if (img->tex == NULL) {
+        img->tex = gfxDrawTrackTexture(
+                       SDL_CreateTextureFromSurface(renderer, img->surf));
+        if (img->tex == NULL) {
+            PRINT_SDL_ERROR("Failed to create texture from surface");
+        }
+    }
+
+    return img->tex;
+}
+
+unsigned int gfxDrawGetImageVersion(loaded_image_t *img)
+{
+    return img->version;
+}
+
+int xDrawLoadedImageCropped(loaded_image_t *img, SDL_Renderer *ren,
+                            signed short x, signed short y, signed short c_x,
+                            signed short c_y, signed short c_w,
+                            signed short c_h)
+{
+    return _renderCroppedImage(gfxDrawGetImageTexture(img), ren, x, y, c_x,
+                               c_y, c_w, c_h);
+}
+
+static struct sprite_batch_buffer {
+    SDL_Vertex *verts;
+    int *indices;
+    unsigned size; // In sprites
+} sprite_batch_buf = { 0 };
+
+static int _drawSpriteBatch(loaded_image_t *img, SDL_Rect *rects, unsigned n,
+                            int x_offset, int y_offset)
+{
+    SDL_Texture *tex = gfxDrawGetImageTexture(img);
+    SDL_Color c = { 0xFF, 0xFF, 0xFF, ALPHA_SOLID };
+    unsigned i;
+
+    if (tex == NULL || !img->w || !img->h) {
+        return -1;
+    }
+
+    if (n > sprite_batch_buf.size) {
+        SDL_Vertex *verts =
+            realloc(sprite_batch_buf.verts, n * 4 * sizeof(SDL_Vertex));
+        if (verts == NULL) {
+            PRINT_ERROR("Failed to grow sprite batch vertices");
+            return -1;
+        }
+        sprite_batch_buf.verts = verts;
+
+        int *indices =
+            realloc(sprite_batch_buf.indices, n * 6 * sizeof(int));
+        if (indices == NULL) {
+            PRINT_ERROR("Failed to grow sprite batch indices");
+            return -1;
+        }
+        sprite_batch_buf.indices = indices;
+
+        for (i = sprite_batch_buf.size; i < n; i++) {
+            indices[i * 6] = i * 4;
+            indices[i * 6 + 1] = i * 4 + 1;
+            indices[i * 6 + 2] = i * 4 + 2;
+            indices[i * 6 + 3] = i * 4;
+            indices[i * 6 + 4] = i * 4 + 2;
+            indices[i * 6 + 5] = i * 4 + 3;
+        }
+        sprite_batch_buf.size = n;
+    }
+
+    for (i = 0; i < n; i++) {
+        SDL_Rect *src = &rects[i * 2], *dst = &rects[i * 2 + 1];
+        SDL_Vertex *v = &sprite_batch_buf.verts[i * 4];
+        float x = dst->x + x_offset, y = dst->y + y_offset;
+        float u0 = (float)src->x / img->w;
+        float v0 = (float)src->y / img->h;
+        float u1 = (float)(src->x + src->w) / img->w;
+        float v1 = (float)(src->y + src->h) / img->h;
+
+        v[0] = (SDL_Vertex) { { x, y }, c, { u0, v0 } };
+        v[1] = (SDL_Vertex) { { x + dst->w, y }, c, { u1, v0 } };
+        v[2] = (SDL_Vertex) { { x + dst->w, y + dst->h }, c, { u1, v1 } };
+        v[3] = (SDL_Vertex) { { x, y + dst->h }, c, { u0, v1 } };
+    }
+
+    return SDL_RenderGeometry(renderer, tex, sprite_batch_buf.verts, n * 4,
+                              sprite_batch_buf.indices, n * 6);
+}
+
+// Box filters a surface down to half its size
+static SDL_Surface *_halveSurface(SDL_Surface *src)
+{
+    SDL_Surface *in = src, *out = NULL;
+    int x, y, c;
+
+    if (src->format->format != SDL_PIXELFORMAT_RGBA32) {
+        in = SDL_ConvertSurfaceFormat(src, SDL_PIXELFORMAT_RGBA32, 0);
+        if (in == NULL) {
+            PRINT_SDL_ERROR("Failed to convert image for downscaling");
+            return NULL;
+        }
+    }
+
+    out = SDL_CreateRGBSurfaceWithFormat(0, in->w > 1 ? in->w / 2 : 1,
+                                         in->h > 1 ? in->h / 2 : 1, 32,
+                                         SDL_PIXELFORMAT_RGBA32);
+    if (out == NULL) {
+        PRINT_SDL_ERROR("Failed to create downscaled image");
+        goto out;
+    }
+
+    SDL_LockSurface(in);
+
+    for (y = 0; y < out->h; y++)
+        for (x = 0; x < out->w; x++) {
+            int x1 = x * 2 + 1 < in->w ? x * 2 + 1 : x * 2;
+            int y1 = y * 2 + 1 < in->h ? y * 2 + 1 : y * 2;
+            Uint8 *row0 = (Uint8 *)in->pixels + y * 2 * in->pitch;
+            Uint8 *row1 = (Uint8 *)in->pixels + y1 * in->pitch;
+            Uint8 *dst = (Uint8 *)out->pixels + y * out->pitch + x * 4;
+
+            for (c = 0; c < 4; c++)
+                dst[c] = (row0[x * 2 * 4 + c] + row0[x1 * 4 + c] +
+                          row1[x * 2 * 4 + c] + row1[x1 * 4 + c] + 2) /
+                         4;
+        }
+
+    SDL_UnlockSurface(in);
+
+out:
+    if (in != src) {
+        SDL_FreeSurface(in);
+    }
+
+    return out;
+}
+
+// Returns the smallest mip level that is still at least the drawn size,
+// generating any missing levels. Falls back to larger levels on failure.
+static SDL_Texture *_getLoadedImageMipTexture(loaded_image_t *img,
+                                              float scale)
+{
+    SDL_Surface *prev = img->surf;
+    unsigned level = 0;
+
+    img->last_used = memory_budget.frame;
+
+    while (level < GFX_IMAGE_MIP_LEVELS && scale * (2 << level) <= 1.0 &&
+           img->w >> (level + 1) && img->h >> (level + 1)) {
+        if (img->mips[level].surf == NULL) {
+            img->mips[level].surf = _halveSurface(prev);
+            if (img->mips[level].surf == NULL) {
+                break;
+            }
+            gfxUtilMemAdd(GFX_MEM_SURFACES,
+                          _surfaceBytes(img->mips[level].surf));
+        }
+
+        if (img->mips[level].tex == NULL) {
+            img->mips[level].tex =
+                gfxDrawTrackTexture(SDL_CreateTextureFromSurface(
+                                        renderer, img->mips[level].surf));
+            if (img->mips[level].tex == NULL) {
+                PRINT_SDL_ERROR("Failed to create downscaled texture");
+                break;
+            }
+            SDL_SetTextureScaleMode(img->mips[level].tex,
+                                    SDL_ScaleModeLinear);
+        }
+
+        prev = img->mips[level].surf;
+        level++;
+    }
+
+    return level ? img->mips[level - 1].tex : gfxDrawGetImageTexture(img);
+}
+
+int xDrawLoadedImage(loaded_image_t *img, SDL_Renderer *ren, signed short x,
+                     signed short y, float scale)
+{
+    return _renderScaledImage(_getLoadedImageMipTexture(img, scale), ren, x,
+                              y, img->w * scale, img->h * scale);
+}
+
+static int _drawScaledImage(SDL_Texture *tex, SDL_Renderer *ren, signed short x,
+                            signed short y, float scale)
+{
+    int w, h;
+    SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+    if (!w || !h) {
+        return -1;
+    }
+
+    if (_renderScaledImage(tex, ren, x, y, w * scale, h * scale)) {
+        return -1;
+    }
+
+    SDL_DestroyTexture(tex);
+
+    return 0;
+}
+
+static int _drawImage(SDL_Texture *tex, SDL_Renderer *ren, signed short x,
+                      signed short y)
+{
+    return _drawScaledImage(tex, ren, x, y, 1);
+}
+
+static int _drawText(char *string, signed short x, signed short y,
+                     unsigned int colour, TTF_Font *font)
+{
+    SDL_Color color = { RED_PORTION(colour), GREEN_PORTION(colour),
+                        BLUE_PORTION(colour), ZERO_ALPHA
+                      };
+    GFX_MUTEX_LOCK(&ttf_lock, ttf_lock_stats);
+    SDL_Surface *surface = TTF_RenderText_Solid(font, string, color);
+    GFX_MUTEX_UNLOCK(&ttf_lock, ttf_lock_stats);
+    gfxFontPutFont(font);
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Rect dst = { 0 };
+    SDL_QueryTexture(texture, NULL, NULL, &dst.w, &dst.h);
+    dst.x = x;
+    dst.y = y;
+    SDL_RenderCopy(renderer, texture, NULL, &dst);
+    SDL_DestroyTexture(texture);
+    SDL_FreeSurface(surface);
+
+    return 0;
+}
+
+// Called from any thread, so must not touch the renderer
+static int _getTextSize(char *string, int *width, int *height)
+{
+    TTF_Font *font = gfxFontGetCurFont();
+
+    GFX_MUTEX_LOCK(&ttf_lock, ttf_lock_stats);
+    int ret = TTF_SizeText(font, string, width, height);
+    GFX_MUTEX_UNLOCK(&ttf_lock, ttf_lock_stats);
+
+    gfxFontPutFont(font);
+
+    return ret ? -1 : 0;
+}
+
+static int _drawArrow(signed short x1, signed short y1, signed short x2,
+                      signed short y2, signed short head_length,
+                      unsigned char thickness, unsigned int colour)
+{
+    // Line vector
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+
+    // Normalize
+    float length = sqrtf(dx * dx + dy * dy);
+
+    if (length == 0) {
+        return 0;
+    }
+
+    float unit_dx = dx / length;
+    float unit_dy = dy / length;
+
+    // Head is drawn as a single line through the tip so that it is joined
+    _startLineChain(thickness, colour);
+    if (_appendLinePoint(x1, y1) || _appendLinePoint(x2, y2)) {
+        return -1;
+    }
+    _flushLineChain();
+
+    if (_appendLinePoint(x2 - unit_dx * head_length - unit_dy * head_length,
+                         y2 - unit_dy * head_length + unit_dx * head_length) ||
+        _appendLinePoint(x2, y2) ||
+        _appendLinePoint(x2 - unit_dx * head_length + unit_dy * head_length,
+                         y2 - unit_dy * head_length - unit_dx * head_length)) {
+        return -1;
+    }
+    _flushLineChain();
+
+    return 0;
+}
+
+static void _pickSpan(SDL_Rect *box, int x0, int y0, int x1, int y1)
+{
+    box->x = x0 < x1 ? x0 : x1;
+    box->y = y0 < y1 ? y0 : y1;
+    box->w = abs(x1 - x0) + 1;
+    box->h = abs(y1 - y0) + 1;
+}
+
+static void _pickPoints(SDL_Rect *box, Sint16 *x, Sint16 *y, unsigned int n)
+{
+    int min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        min_x = x[i] < min_x ? x[i] : min_x;
+        max_x = x[i] > max_x ? x[i] : max_x;
+        min_y = y[i] < min_y ? y[i] : min_y;
+        max_y = y[i] > max_y ? y[i] : max_y;
+    }
+
+    _pickSpan(box, min_x, min_y, max_x, max_y);
+}
+
+static void _pickPad(SDL_Rect *box, int pad)
+{
+    box->x -= pad;
+    box->y -= pad;
+    box->w += pad * 2;
+    box->h += pad * 2;
+}
+
+// Bounding box of what a job draws, before the global offset is applied
+static int _pickJobBounds(draw_job_t *job, SDL_Rect *box)
+{
+    union data_u *data = job->data;
+    unsigned int i;
+
+    switch (job->type) {
+        case DRAW_ARC:
+            _pickSpan(box, data->arc.x - data->arc.radius,
+                      data->arc.y - data->arc.radius,
+                      data->arc.x + data->arc.radius,
+                      data->arc.y + data->arc.radius);
+            break;
+        case DRAW_CIRCLE:
+            _pickSpan(box, data->circle.x - data->circle.radius,
+                      data->circle.y - data->circle.radius,
+                      data->circle.x + data->circle.radius,
+                      data->circle.y + data->circle.radius);
+            break;
+        case DRAW_ELLIPSE:
+            _pickSpan(box, data->ellipse.x - data->ellipse.rx,
+                      data->ellipse.y - data->ellipse.ry,
+                      data->ellipse.x + data->ellipse.rx,
+                      data->ellipse.y + data->ellipse.ry);
+            break;
+        case DRAW_RECT:
+        case DRAW_FILLED_RECT:
+            *box = (SDL_Rect) {
+                data->rect.x, data->rect.y, data->rect.w, data->rect.h
+            };
+            break;
+        case DRAW_LINE:
+            _pickSpan(box, data->line.x1, data->line.y1, data->line.x2,
+                      data->line.y2);
+            _pickPad(box, data->line.thickness / 2);
+            break;
+        case DRAW_ARROW:
+            _pickSpan(box, data->arrow.x1, data->arrow.y1, data->arrow.x2,
+                      data->arrow.y2);
+            _pickPad(box, data->arrow.head_length +
+                     data->arrow.thickness / 2);
+            break;
+        case DRAW_POLYLINE:
+        case DRAW_POLY:
+        case DRAW_FILLED_POLY:
+            _pickPoints(box, data->poly.x, data->poly.y, data->poly.n);
+            _pickPad(box, data->poly.thickness / 2);
+            break;
+        case DRAW_TRIANGLE: {
+            Sint16 x[3], y[3];
+
+            for (i = 0; i < 3; i++) {
+                x[i] = data->triangle.points[i].x;
+                y[i] = data->triangle.points[i].y;
+            }
+            _pickPoints(box, x, y, 3);
+        }
+        break;
+        case DRAW_TEXT: {
+            int err;
+
+            box->x = data->text.x;
+            box->y = data->text.y;
+            GFX_MUTEX_LOCK(&ttf_lock, ttf_lock_stats);
+            err = TTF_SizeText(data->text.font, data->text.str, &box->w,
+                               &box->h);
+            GFX_MUTEX_UNLOCK(&ttf_lock, ttf_lock_stats);
+            if (err) {
+                return -1;
+            }
+        }
+        break;
+        case DRAW_LOADED_IMAGE:
+            *box = (SDL_Rect) {
+                data->loaded_image.x, data->loaded_image.y,
+                data->loaded_image.img->w * data->loaded_image.scale,
+                data->loaded_image.img->h * data->loaded_image.scale
+            };
+            break;
+        case DRAW_LOADED_IMAGE_CROP:
+            *box = (SDL_Rect) {
+                data->loaded_image_crop.x, data->loaded_image_crop.y,
+                data->loaded_image_crop.c_w, data->loaded_image_crop.c_h
+            };
+            break;
+        case DRAW_SPRITE_BATCH: {
+            int min_x = INT_MAX, min_y = INT_MAX;
+            int max_x = INT_MIN, max_y = INT_MIN;
+
+            for (i = 0; i < data->sprite_batch.n; i++) {
+                SDL_Rect *dst = &data->sprite_batch.rects[i * 2 + 1];
+
+                min_x = dst->x < min_x ? dst->x : min_x;
+                min_y = dst->y < min_y ? dst->y : min_y;
+                max_x = dst->x + dst->w > max_x ? dst->x + dst->w : max_x;
+                max_y = dst->y + dst->h > max_y ? dst->y + dst->h : max_y;
+            }
+            if (!data->sprite_batch.n) {
+                return -1;
+            }
+            *box = (SDL_Rect) {
+                min_x, min_y, max_x - min_x, max_y - min_y
+            };
+        }
+        break;
+        case DRAW_TILEMAP: {
+            unsigned int w, h;
+
+            if (data->tilemap.release) {
+                return -1;
+            }
+            gfxTilemapGetSize(data->tilemap.map, &w, &h);
+            *box = (SDL_Rect) {
+                data->tilemap.x, data->tilemap.y, w, h
+            };
+        }
+        break;
+        case DRAW_PATH: {
+            SDL_FPoint min, max;
+
+            if (data->path.release ||
+                gfxPathGetBounds(data->path.path, &min, &max)) {
+                return -1;
+            }
+
+            _pickSpan(box, data->path.x + floorf(min.x),
+                      data->path.y + floorf(min.y),
+                      data->path.x + ceilf(max.x),
+                      data->path.y + ceilf(max.y));
+            if (!data->path.fill) {
+                _pickPad(box, data->path.thickness / 2);
+            }
+        }
+        break;
+        case DRAW_CHART: {
+            unsigned int w, h;
+
+            if (data->chart.release) {
+                return -1;
+            }
+            gfxChartGetSize(data->chart.chart, &w, &h);
+            *box = (SDL_Rect) {
+                data->chart.x, data->chart.y, w, h
+            };
+        }
+        break;
+        default: // Clears and images loaded by filename are not pickable
+            return -1;
+    }
+
+    return 0;
+}
+
+static void _pickAddJob(draw_job_t *job, int x_offset, int y_offset)
+{
+    SDL_Rect bounds;
+
+    if (_pickJobBounds(job, &bounds)) {
+        return;
+    }
+
+    bounds.x += x_offset;
+    bounds.y += y_offset;
+
+    gfxPickAdd(&bounds, job->pick_id);
+}
+
+// Appends a record to the frame being encoded, returning its payload
+static void *_splitAppend(uint32_t type, size_t size, int x_offset,
+                          int y_offset)
+{
+    struct remote_record *record;
+    unsigned char *frame;
+    size_t frame_size = split_mode.frame_size ? split_mode.frame_size : 4096;
+
+    while (split_mode.frame_len + REMOTE_RECORD_SIZE(size) > frame_size) {
+        frame_size *= 2;
+    }
+
+    if (frame_size != split_mode.frame_size) {
+        frame = realloc(split_mode.frame, frame_size);
+        if (frame == NULL) {
+            PRINT_ERROR("Failed to grow frame to %zu bytes", frame_size);
+            split_mode.incomplete = 1;
+            return NULL;
+        }
+        split_mode.frame = frame;
+        split_mode.frame_size = frame_size;
+    }
+
+    record = (struct remote_record *)&split_mode.frame[split_mode.frame_len];
+    *record = (struct remote_record) {
+        .type = type, .size = size, .x_offset = x_offset,
+         .y_offset = y_offset
+    };
+    split_mode.frame_len += REMOTE_RECORD_SIZE(size);
+
+    return record + 1;
+}
+
+// Has the viewer load an image the first time it is drawn
+static int _splitDefineImage(loaded_image_t *img)
+{
+    struct remote_image *define;
+    size_t len;
+
+    if (img->remote_sent) {
+        return 0;
+    }
+
+    if (!img->remote_id) {
+        img->remote_id = ++split_mode.image_ids;
+    }
+
+    len = strlen(img->filename) + 1;
+    define = _splitAppend(REMOTE_IMAGE_DEFINE, sizeof(*define) + len, 0, 0);
+    if (define == NULL) {
+        return -1;
+    }
+
+    define->id = img->remote_id;
+    define->scale = img->scale;
+    memcpy(define + 1, img->filename, len);
+    img->remote_sent = 1;
+
+    return 0;
+}
+
+static int _splitEncodeText(draw_job_t *job, int x_offset, int y_offset)
+{
+    struct remote_text *text;
+    ssize_t font_size;
+    size_t name_len, str_len;
+    char *name;
+
+    name = gfxFontGetFontName(job->data->text.font, &font_size);
+    if (name == NULL) {
+        return -1;
+    }
+
+    name_len = strlen(name) + 1;
+    str_len = strlen(job->data->text.str) + 1;
+
+    text = _splitAppend(job->type, sizeof(union data_u) + sizeof(*text) +
+                        name_len + str_len, x_offset, y_offset);
+    if (text == NULL) {
+        free(name);
+        return -1;
+    }
+
+    memcpy(text, job->data, sizeof(union data_u));
+    text = (struct remote_text *)((union data_u *)text + 1);
+    text->font_size = font_size;
+    memcpy(text + 1, name, name_len);
+    memcpy((char *)(text + 1) + name_len, job->data->text.str, str_len);
+
+    free(name);
+
+    return 0;
+}
+
+// Paths are sent as the mesh they are drawn with, as it is cached here
+static int _splitEncodePath(draw_job_t *job, int x_offset, int y_offset)
+{
+    struct geometry_batch *mesh = gfxPathLockMesh(&job->data->path);
+    struct remote_mesh *payload;
+    SDL_FPoint *points;
+    unsigned int i;
+    int ret = -1;
+
+    if (mesh == NULL) {
+        return -1;
+    }
+
+    payload = _splitAppend(job->type, sizeof(union data_u) +
+                           sizeof(*payload) +
+                           mesh->n_verts * sizeof(SDL_FPoint) +
+                           mesh->n_indices * sizeof(int),
+                           x_offset, y_offset);
+    if (payload == NULL) {
+        goto unlock;
+    }
+
+    memcpy(payload, job->data, sizeof(union data_u));
+    payload = (struct remote_mesh *)((union data_u *)payload + 1);
+    payload->n_verts = mesh->n_verts;
+    payload->n_indices = mesh->n_indices;
+
+    points = (SDL_FPoint *)(payload + 1);
+    for (i = 0; i < mesh->n_verts; i++) {
+        points[i] = mesh->verts[i].position;
+    }
+    memcpy(points + mesh->n_verts, mesh->indices,
+           mesh->n_indices * sizeof(int));
+
+    ret = 0;
+
+unlock:
+    gfxPathUnlockMesh(job->data->path.path);
+
+    return ret;
+}
+
+static int _splitEncodeJob(draw_job_t *job, int x_offset, int y_offset)
+{
+    union data_u *data = job->data;
+    loaded_image_t *img = NULL;
+    const void *extra = NULL;
+    size_t extra_size = 0;
+    unsigned char *payload;
+
+    switch (job->type) {
+        case DRAW_TEXT:
+            return _splitEncodeText(job, x_offset, y_offset);
+        case DRAW_PATH:
+            if (data->path.release) {
+                return 0;
+            }
+            return _splitEncodePath(job, x_offset, y_offset);
+        case DRAW_POLYLINE:
+        case DRAW_POLY:
+        case DRAW_FILLED_POLY:
+            // The y coordinates are stored directly after the x coordinates
+            extra = data->poly.x;
+            extra_size = 2 * data->poly.n * sizeof(Sint16);
+            break;
+        case DRAW_IMAGE:
+        case DRAW_SCALED_IMAGE: // Starts with the image_data_t
+            extra = data->image.filename;
+            extra_size = strlen(data->image.filename) + 1;
+            break;
+        case DRAW_LOADED_IMAGE:
+            img = data->loaded_image.img;
+            break;
+        case DRAW_LOADED_IMAGE_CROP:
+            img = data->loaded_image_crop.image;
+            break;
+        case DRAW_SPRITE_BATCH:
+            img = data->sprite_batch.image;
+            extra = data->sprite_batch.rects;
+            extra_size = 2 * data->sprite_batch.n * sizeof(SDL_Rect);
+            break;
+        case DRAW_TILEMAP:
+        case DRAW_CHART:
+            // Their caches live on the GL thread, a viewer has none
+            if (job->type == DRAW_TILEMAP ? data->tilemap.release :
+                data->chart.release) {
+                return 0;
+            }
+            if (!split_mode.unsupported[job->type]) {
+                PRINT_ERROR("Drawing %ss is not supported in split mode",
+                            draw_job_names[job->type]);
+                split_mode.unsupported[job->type] = 1;
+            }
+            return 0;
+        default:
+            break;
+    }
+
+    if (img) {
+        if (_splitDefineImage(img)) {
+            return -1;
+        }
+    }
+
+    payload = _splitAppend(job->type, sizeof(union data_u) +
+                           (img ? sizeof(uint32_t) : 0) + extra_size,
+                           x_offset, y_offset);
+    if (payload == NULL) {
+        return -1;
+    }
+
+    memcpy(payload, data, sizeof(union data_u));
+    payload += sizeof(union data_u);
+
+    if (img) {
+        memcpy(payload, &img->remote_id, sizeof(uint32_t));
+        payload += sizeof(uint32_t);
+    }
+
+    if (extra_size) {
+        memcpy(payload, extra, extra_size);
+    }
+
+    return 0;
+}
+
+// Frees what a job holds, as _drawJob() does for jobs that are drawn
+static void _releaseDrawJob(draw_job_t *job)
+{
+    union data_u *data = job->data;
+
+    switch (job->type) {
+        case DRAW_TEXT:
+            gfxFontPutFont(data->text.font);
+            free(data->text.str);
+            break;
+        case DRAW_IMAGE:
+        case DRAW_SCALED_IMAGE:
+            free(data->image.filename);
+            break;
+        case DRAW_LOADED_IMAGE:
+            vPutLoadedImage(data->loaded_image.img);
+            break;
+        case DRAW_LOADED_IMAGE_CROP:
+            vPutLoadedImage(data->loaded_image_crop.image);
+            break;
+        case DRAW_SPRITE_BATCH:
+            vPutLoadedImage(data->sprite_batch.image);
+            free(data->sprite_batch.rects);
+            break;
+        case DRAW_TILEMAP:
+            if (data->tilemap.release) {
+                gfxTilemapFree(data->tilemap.map);
+            }
+            break;
+        case DRAW_PATH:
+            if (data->path.release) {
+                gfxPathFree(data->path.path);
+            }
+            break;
+        case DRAW_CHART:
+            if (data->chart.release) {
+                gfxChartFree(data->chart.chart);
+            }
+            break;
+        default:
+            break;
+    }
+    free(job->data);
+}
+
+// Accepts a viewer that connected and passes on its input
+static void _splitPollViewer(void)
+{
+    SDL_Event event;
+
+    if (gfxRemoteAccept(split_mode.channel) == 1) {
+        GFX_MUTEX_LOCK(&split_mode.lock, split_mode_lock_stats);
+        split_mode.resync = 1;
+        GFX_MUTEX_UNLOCK(&split_mode.lock, split_mode_lock_stats);
+    }
+
+    // Read by gfx_event as if the input came from a window of this process
+    while (gfxRemoteReceiveMessage(split_mode.channel, &event,
+                                   sizeof(event)) == sizeof(event)) {
+        SDL_PushEvent(&event);
+    }
+}
+
+static void _splitBeginFrame(void)
+{
+    struct remote_frame *frame;
+    struct remote_image *release;
+    loaded_image_t *iterator;
+    unsigned char resync;
+    unsigned int i;
+
+    split_mode.frame_len = 0;
+    split_mode.incomplete = 0;
+
+    frame = _splitAppend(REMOTE_FRAME, sizeof(*frame), 0, 0);
+    if (frame) {
+        frame->hud = gfxDrawHUDIsShown();
+    }
+
+    GFX_MUTEX_LOCK(&split_mode.lock, split_mode_lock_stats);
+
+    resync = split_mode.resync;
+    split_mode.resync = 0;
+
+    for (i = 0; i < split_mode.n_released && !resync; i++) {
+        release = _splitAppend(REMOTE_IMAGE_RELEASE,
+                               sizeof(struct remote_image), 0, 0);
+        if (release) {
+            release->id = split_mode.released[i];
+        }
+    }
+    split_mode.n_released = 0;
+
+    GFX_MUTEX_UNLOCK(&split_mode.lock, split_mode_lock_stats);
+
+    if (resync) {
+        _splitAppend(REMOTE_RESET, 0, 0, 0);
+
+        GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
+        for (iterator = loaded_images_list.next; iterator;
+             iterator = iterator->next) {
+            iterator->remote_sent = 0;
+        }
+        GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
+    }
+}
+
+static void _splitSendFrame(void)
+{
+    enum gfx_remote_status status = GFX_REMOTE_DROPPED;
+
+    if (!split_mode.incomplete) {
+        status = gfxRemoteSendFrame(split_mode.channel, split_mode.frame,
+                                    split_mode.frame_len);
+    }
+
+    // Images defined and released by the frame never reached the viewer
+    if (status != GFX_REMOTE_SENT) {
+        GFX_MUTEX_LOCK(&split_mode.lock, split_mode_lock_stats);
+        split_mode.resync = 1;
+        GFX_MUTEX_UNLOCK(&split_mode.lock, split_mode_lock_stats);
+    }
+
+    if (status == GFX_REMOTE_DROPPED) {
+        split_mode.dropped++;
+    }
+}
+
+static int _drawJob(draw_job_t *job, int x_offset, int y_offset)
+{
+    int ret = 0;
+
+    // Connected lines are joined until a job draws something else
+    if (job->type != DRAW_LINE) {
+        _flushLineChain();
+    }
+
+    // Shapes and lines are batched until a job draws something else
+    if (job->type != DRAW_CIRCLE && job->type != DRAW_ELLIPSE &&
+        job->type != DRAW_ARC && job->type != DRAW_LINE &&
+        job->type != DRAW_POLYLINE && job->type != DRAW_ARROW &&
+        job->type != DRAW_PATH && job->type != DRAW_MESH) {
+        _flushGeometry();
+    }
 
     switch (job->type) {
         case DRAW_CLEAR:
@@ -843,7 +2418,8 @@ static int vHandleDrawJob(draw_job_t *job)
             break;
         case DRAW_ELLIPSE:
             ret = _drawEllipse(job->data->ellipse.x + x_offset,
-                               job->data->ellipse.y, job->data->ellipse.rx,
+                               job->data->ellipse.y + y_offset,
+                               job->data->ellipse.rx,
                                job->data->ellipse.ry,
                                job->data->ellipse.colour);
             break;
@@ -880,9 +2456,14 @@ static int vHandleDrawJob(draw_job_t *job)
                             job->data->line.thickness,
                             job->data->line.colour);
             break;
+        case DRAW_POLYLINE:
+            ret = _drawPolyline(&job->data->poly, x_offset, y_offset);
+            break;
         case DRAW_POLY:
-            ret = _drawPoly(job->data->poly.points, job->data->poly.n,
-                            x_offset, y_offset, job->data->poly.colour);
+            ret = _drawPoly(&job->data->poly, x_offset, y_offset);
+            break;
+        case DRAW_FILLED_POLY:
+            ret = _drawFilledPoly(&job->data->poly, x_offset, y_offset);
             break;
         case DRAW_TRIANGLE:
             ret = _drawTriangle(job->data->triangle.points, x_offset,
@@ -894,11 +2475,13 @@ static int vHandleDrawJob(draw_job_t *job)
             ret = _drawImage(job->data->image.tex, renderer,
                              job->data->image.x + x_offset,
                              job->data->image.y + y_offset);
+            free(job->data->image.filename);
             break;
         case DRAW_LOADED_IMAGE:
             ret = xDrawLoadedImage(job->data->loaded_image.img, renderer,
                                    job->data->loaded_image.x + x_offset,
-                                   job->data->loaded_image.y + y_offset);
+                                   job->data->loaded_image.y + y_offset,
+                                   job->data->loaded_image.scale);
             vPutLoadedImage(job->data->loaded_image.img);
             break;
         case DRAW_LOADED_IMAGE_CROP:
@@ -922,14 +2505,56 @@ static int vHandleDrawJob(draw_job_t *job)
                       job->data->scaled_image.scale);
             free(job->data->scaled_image.image.filename);
             break;
-        case DRAW_ARROW:
-            ret = _drawArrow(job->data->arrow.x1 + x_offset,
-                             job->data->arrow.y1 + y_offset,
-                             job->data->arrow.x2 + x_offset,
-                             job->data->arrow.y2 + y_offset,
-                             job->data->arrow.head_length,
-                             job->data->arrow.thickness,
-                             job->data->arrow.colour);
+        case DRAW_ARROW:
+            ret = _drawArrow(job->data->arrow.x1 + x_offset,
+                             job->data->arrow.y1 + y_offset,
+                             job->data->arrow.x2 + x_offset,
+                             job->data->arrow.y2 + y_offset,
+                             job->data->arrow.head_length,
+                             job->data->arrow.thickness,
+                             job->data->arrow.colour);
+            break;
+        case DRAW_SPRITE_BATCH:
+            ret = _drawSpriteBatch(job->data->sprite_batch.image,
+                                   job->data->sprite_batch.rects,
+                                   job->data->sprite_batch.n, x_offset,
+                                   y_offset);
+            vPutLoadedImage(job->data->sprite_batch.image);
+            free(job->data->sprite_batch.rects);
+            break;
+        case DRAW_TILEMAP:
+            if (job->data->tilemap.release) {
+                gfxTilemapFree(job->data->tilemap.map);
+            }
+            else
+                ret = gfxTilemapRender(job->data->tilemap.map,
+                                       job->data->tilemap.x + x_offset,
+                                       job->data->tilemap.y + y_offset);
+            break;
+        case DRAW_PATH:
+            if (job->data->path.release) {
+                gfxPathFree(job->data->path.path);
+            }
+            else {
+                ret = _drawPath(&job->data->path, x_offset, y_offset);
+            }
+            break;
+        case DRAW_CHART:
+            if (job->data->chart.release) {
+                gfxChartFree(job->data->chart.chart);
+            }
+            else
+                ret = gfxChartRender(job->data->chart.chart,
+                                     job->data->chart.x + x_offset,
+                                     job->data->chart.y + y_offset,
+                                     job->data->chart.colour);
+            break;
+        case DRAW_MESH:
+            ret = _pushMesh(&job->data->mesh.mesh,
+                            job->data->mesh.x + x_offset,
+                            job->data->mesh.y + y_offset,
+                            job->data->mesh.colour);
+            break;
         default:
             break;
     }
@@ -938,15 +2563,53 @@ static int vHandleDrawJob(draw_job_t *job)
     return ret;
 }
 
-#define INIT_JOB(JOB, TYPE)                                                    \
-    draw_job_t *JOB = _pushDrawJob();                                      \
-    if (!JOB)                                                              \
-        return -1;                                                     \
-    union data_u *data = calloc(1, sizeof(union data_u));                  \
-    if (data == NULL)                                                      \
-        logCriticalError("job->data alloc");                           \
-    JOB->data = data;                                                      \
-    JOB->type = TYPE;
+static int vHandleDrawJob(draw_job_t *job)
+{
+    int ret;
+    static int x_offset = 0;
+    static int y_offset = 0;
+
+    if (!GFX_MUTEX_LOCK(&global_offset.lock, global_offset_lock_stats)) {
+        x_offset = global_offset.x;
+        y_offset = global_offset.y;
+        GFX_MUTEX_UNLOCK(&global_offset.lock, global_offset_lock_stats);
+    }
+    else {
+        return -1;
+    }
+
+    if (job == NULL) {
+        return -1;
+    }
+
+    if (job->data == NULL) {
+        return -1;
+    }
+
+    if (job->pick_id != GFX_PICK_NONE) {
+        _pickAddJob(job, x_offset, y_offset);
+    }
+
+    // Jobs are sent to the viewer instead in split mode
+    if (split_mode.channel) {
+        ret = _splitEncodeJob(job, x_offset, y_offset);
+        _releaseDrawJob(job);
+        return ret;
+    }
+
+    return _drawJob(job, x_offset, y_offset);
+}
+
+// Draws a job rebuilt by a viewer, which owns no queue to push it to
+int gfxDrawReplayJob(draw_job_t *job, int x_offset, int y_offset)
+{
+    int ret = _drawJob(job, x_offset, y_offset);
+
+    gfxUtilMemSub(GFX_MEM_JOBS, job->bytes);
+    free(job);
+
+    return ret;
+}
 
 static void logCriticalError(char *msg)
 {
@@ -954,12 +2617,27 @@ static void logCriticalError(char *msg)
     exit(-1);
 }
 
-#define NS_IN_SECOND 1000000000.0
-#define MS_IN_SECOND 1000.0
-#define NS_IN_MS 1000000.0
+draw_job_t *gfxDrawCreateJob(draw_job_type_t type, size_t extra)
+{
+    draw_job_t *job = calloc(1, sizeof(draw_job_t));
 
-#if (configFPS_LIMIT == 1)
-static float timespecDiffMilli(struct timespec *start, struct timespec *stop)
+    if (job == NULL) {
+        return NULL;
+    }
+
+    job->data = calloc(1, sizeof(union data_u) + extra);
+    if (job->data == NULL) {
+        logCriticalError("job->data alloc");
+    }
+    job->type = type;
+    job->pick_id = gfxDrawGetPickID();
+    job->bytes = sizeof(draw_job_t) + sizeof(union data_u) + extra;
+    gfxUtilMemAdd(GFX_MEM_JOBS, job->bytes);
+
+    return job;
+}
+
+float gfxDrawTimespecDiffMs(struct timespec *start, struct timespec *stop)
 {
     if ((stop->tv_nsec - start->tv_nsec) < 0)
         return (stop->tv_sec - start->tv_sec - 1) * MS_IN_SECOND +
@@ -970,79 +2648,442 @@ static float timespecDiffMilli(struct timespec *start, struct timespec *stop)
            (stop->tv_nsec - start->tv_nsec) / NS_IN_MS;
 }
 
-#ifdef configFPS_LIMIT_RATE
-#define FRAMELIMIT configFPS_LIMIT_RATE
-#else
-#define FRAMELIMIT 50
-#endif //configFPS_LIMIT_RATE
-#define FRAMELIMIT_PERIOD 1000.0 / FRAMELIMIT
-#endif //configFPS_LIMIT
+struct frame_clock {
+    struct timespec last_present;
+    double ms; // Scaled time, only touched by the GL thread
+    unsigned now_ms;
+    unsigned delta_ms;
+    float scale;
+    unsigned char paused;
+};
+
+static struct frame_clock frame_clock = { .scale = 1.0 };
+
+static void _frameClockAdvance(void)
+{
+    struct timespec now;
+    float scale;
+    double delta = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    __atomic_load(&frame_clock.scale, &scale, __ATOMIC_RELAXED);
+
+    if ((frame_clock.last_present.tv_sec ||
+         frame_clock.last_present.tv_nsec) &&
+        !gfxDrawFrameClockIsPaused()) {
+        delta = gfxDrawTimespecDiffMs(&frame_clock.last_present, &now) * scale;
+    }
+
+    frame_clock.last_present = now;
+
+    unsigned prev_ms = (unsigned)frame_clock.ms;
+    frame_clock.ms += delta;
+
+    __atomic_store_n(&frame_clock.delta_ms,
+                     (unsigned)frame_clock.ms - prev_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&frame_clock.now_ms, (unsigned)frame_clock.ms,
+                     __ATOMIC_RELEASE);
+}
+
+unsigned gfxDrawFrameClockGetMs(void)
+{
+    return __atomic_load_n(&frame_clock.now_ms, __ATOMIC_ACQUIRE);
+}
+
+unsigned gfxDrawFrameClockGetDeltaMs(void)
+{
+    return __atomic_load_n(&frame_clock.delta_ms, __ATOMIC_RELAXED);
+}
+
+void gfxDrawFrameClockPause(unsigned char pause)
+{
+    __atomic_store_n(&frame_clock.paused, pause ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+unsigned char gfxDrawFrameClockIsPaused(void)
+{
+    return __atomic_load_n(&frame_clock.paused, __ATOMIC_RELAXED);
+}
+
+int gfxDrawFrameClockSetScale(float scale)
+{
+    if (!(scale >= 0)) {
+        PRINT_ERROR("Frame clock scale must be non-negative");
+        return -1;
+    }
+
+    __atomic_store(&frame_clock.scale, &scale, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+float gfxDrawFrameClockGetScale(void)
+{
+    float scale;
+
+    __atomic_load(&frame_clock.scale, &scale, __ATOMIC_RELAXED);
+
+    return scale;
+}
+
+// Draws what is still batched and shows the frame
+static void _presentFrame(void)
+{
+    _flushLineChain();
+    _flushGeometry();
+
+    if (gfxDrawHUDIsShown()) {
+        gfxHUDRender();
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
+int gfxDrawUpdateScreen(void)
+{
+    gfxDrawBindThread(); // Setup Rendering handle with correct GL context
+
+    if (gfxUtilIsCurGLThread()) {
+        PRINT_ERROR(
+            "Updating screen from thread that does not hold GL context");
+        goto err;
+    }
+
+#if (configFPS_LIMIT == 1)
+    static struct timespec last_time = { 0 }, cur_time = { 0 };
+
+    if (clock_gettime(CLOCK_MONOTONIC, &cur_time)) {
+        PRINT_ERROR("Failed to get monotonic clock");
+        goto err;
+    }
+
+    if (gfxDrawTimespecDiffMs(&last_time, &cur_time) <
+        (float)FRAMELIMIT_PERIOD) {
+        goto no_jobs;
+    }
+
+    memcpy(&last_time, &cur_time, sizeof(struct timespec));
+#endif //configFPS_LIMIT
+
+    _reapLoadedImages();
+    _applyImageReloads();
+
+    if (split_mode.channel) {
+        _splitPollViewer();
+    }
+
+    draw_job_t *tmp_job = _takeDrawJobs(), *next_job;
+    int ret = 0;
+
+    if (tmp_job == NULL) {
+        goto no_jobs;
+    }
+
+    if (split_mode.channel) {
+        _splitBeginFrame();
+    }
+
+    gfxHUDResetJobs();
+
+    for (; tmp_job; tmp_job = next_job) {
+        next_job = tmp_job->next;
+        gfxHUDCountJob(tmp_job->type);
+        if (vHandleDrawJob(tmp_job) == -1) {
+            ret = -1;
+        }
+        gfxUtilMemSub(GFX_MEM_JOBS, tmp_job->bytes);
+        free(tmp_job);
+    }
+
+    if (split_mode.channel) {
+        _splitSendFrame();
+    }
+    else {
+        _presentFrame();
+    }
+
+    gfxPickPresentFrame();
+    _enforceMemoryBudget();
+    gfxHUDRecordFrame();
+    _frameClockAdvance();
+
+    return ret;
+
+err:
+    return -1;
+no_jobs:
+    return 0;
+}
+
+// Viewer's end of split mode, see gfxDrawViewerRun()
+static gfx_remote_handle_t viewer_channel = NULL; // NULL while disconnected
+
+// Input that the emulator's gfx_event reads
+static unsigned char _viewerForwardsEvent(SDL_Event *event)
+{
+    switch (event->type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+int gfxDrawViewerRun(const char *socket_path)
+{
+    SDL_Event event;
+    void *frame;
+    size_t size;
+    unsigned char draw;
+    int ret;
+
+    if (gfxDrawBindThread()) {
+        return -1;
+    }
+
+    while (1) {
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                goto quit;
+            }
+            if (viewer_channel && _viewerForwardsEvent(&event)) {
+                gfxRemoteSendMessage(viewer_channel, &event, sizeof(event));
+            }
+        }
+
+        if (viewer_channel == NULL) {
+            viewer_channel = gfxRemoteConnect(socket_path);
+            if (viewer_channel == NULL) {
+                SDL_Delay(GFX_VIEWER_RETRY_MS);
+                continue;
+            }
+            // A new emulator knows none of the images loaded so far
+            gfxRemoteViewerFreeImages();
+        }
+
+        ret = gfxRemoteReceiveFrame(viewer_channel, &frame, &size,
+                                    GFX_VIEWER_POLL_MS);
+        if (ret == -1) {
+            gfxRemoteClose(viewer_channel);
+            viewer_channel = NULL;
+            continue;
+        }
+        if (ret == 0) {
+            continue;
+        }
+
+        _reapLoadedImages();
+        _applyImageReloads();
+
+        gfxHUDResetJobs();
+
+        // Only the newest frame is drawn once the viewer fell behind
+        do {
+            draw = !gfxRemoteFramePending(viewer_channel);
+            gfxRemoteViewerDecodeFrame(frame, size, draw);
+            gfxRemoteReleaseFrame(viewer_channel);
+        }
+        while (!draw && gfxRemoteReceiveFrame(viewer_channel, &frame,
+                                              &size, 0) == 1);
+
+        if (draw) {
+            _presentFrame();
+            _enforceMemoryBudget();
+            gfxHUDRecordFrame();
+        }
+    }
+
+quit:
+    if (viewer_channel) {
+        gfxRemoteClose(viewer_channel);
+        viewer_channel = NULL;
+    }
+    gfxRemoteViewerFreeImages();
+
+    return 0;
+}
+
+char *gfxGetErrorMessage(void)
+{
+    return error_message;
+}
+
+struct init_task {
+    const char *name;
+    int (*task)(void *);
+    void *arg;
+    pthread_t thread;
+    unsigned char started; // Running on a worker thread until joined
+    int ret;
+};
+
+static struct init_tasks {
+    enum gfx_init_mode mode;
+    struct init_task fonts;
+    struct init_task tasks[GFX_INIT_TASKS_MAX];
+    unsigned int count;
+} init_tasks = { .mode = GFX_INIT_SERIAL };
+
+static void *_runInitTask(void *arg)
+{
+    struct init_task *task = arg;
+    int phase = gfxUtilInitPhaseBegin(task->name);
+
+    task->ret = task->task(task->arg);
+    if (task->ret) {
+        PRINT_ERROR("Init task '%s' failed", task->name);
+    }
+
+    gfxUtilInitPhaseEnd(phase);
+
+    return NULL;
+}
+
+static void _startInitTask(struct init_task *task)
+{
+    if (init_tasks.mode == GFX_INIT_PARALLEL &&
+        !pthread_create(&task->thread, NULL, _runInitTask, task)) {
+        task->started = 1;
+    }
+    else {
+        _runInitTask(task);
+    }
+}
+
+// Waits for all tasks, returns -1 if any of them failed
+static int _joinInitTasks(void)
+{
+    struct init_task *task;
+    int ret = 0;
+    unsigned int i;
+
+    for (i = 0; i <= init_tasks.count; i++) {
+        task = i < init_tasks.count ? &init_tasks.tasks[i] : &init_tasks.fonts;
+
+        if (task->started) {
+            pthread_join(task->thread, NULL);
+            task->started = 0;
+        }
+
+        if (task->ret) {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+static int _initFonts(void *path)
+{
+    if (TTF_Init()) {
+        PRINT_ERROR("TTF_Init failed");
+        goto err_ttf;
+    }
+
+    if (gfxFontInit(path)) {
+        PRINT_ERROR("GFX Font init failed");
+        goto err_gfx_font;
+    }
+
+    return 0;
+
+err_gfx_font:
+    TTF_Quit();
+err_ttf:
+    return -1;
+}
+
+void gfxDrawSetInitMode(enum gfx_init_mode mode)
+{
+    init_tasks.mode = mode;
+}
+
+int gfxDrawAddInitTask(const char *name, int (*task)(void *), void *arg)
+{
+    if (task == NULL) {
+        return -1;
+    }
+
+    if (init_tasks.count == GFX_INIT_TASKS_MAX) {
+        PRINT_ERROR("Only %d init tasks can be added", GFX_INIT_TASKS_MAX);
+        return -1;
+    }
+
+    init_tasks.tasks[init_tasks.count++] = (struct init_task) {
+        .name = name, .task = task, .arg = arg
+    };
+
+    return 0;
+}
 
-int gfxDrawUpdateScreen(void)
+void gfxDrawSetViewerSocket(const char *socket_path)
 {
-    gfxDrawBindThread(); // Setup Rendering handle with correct GL context
+    split_mode.socket_path = socket_path;
+}
 
-    if (gfxUtilIsCurGLThread()) {
-        PRINT_ERROR(
-            "Updating screen from thread that does not hold GL context");
-        goto err;
-    }
+unsigned long gfxDrawGetViewerFramesDropped(void)
+{
+    return split_mode.dropped;
+}
 
-#if (configFPS_LIMIT == 1)
-    static struct timespec last_time = { 0 }, cur_time = { 0 };
+static int _createWindow(void)
+{
+    int phase;
 
-    if (clock_gettime(CLOCK_MONOTONIC, &cur_time)) {
-        PRINT_ERROR("Failed to get monotonic clock");
-        goto err;
-    }
+    phase = gfxUtilInitPhaseBegin("window");
+    window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
+                              SDL_WINDOWPOS_CENTERED, screen_width,
+                              screen_height, SDL_WINDOW_OPENGL);
+    gfxUtilInitPhaseEnd(phase);
 
-    if (timespecDiffMilli(&last_time, &cur_time) <
-        (float)FRAMELIMIT_PERIOD) {
-        goto no_jobs;
+    if (window == NULL) {
+        PRINT_SDL_ERROR("Failed to create %d x %d window '%s'",
+                        screen_width, screen_height, WINDOW_TITLE);
+        goto err_window;
     }
 
-    memcpy(&last_time, &cur_time, sizeof(struct timespec));
-#endif //configFPS_LIMIT
+    phase = gfxUtilInitPhaseBegin("GL context");
+    context = SDL_GL_CreateContext(window);
+    gfxUtilInitPhaseEnd(phase);
 
-    if (!_waitingDrawJobs()) {
-        goto no_jobs;
+    if (context == NULL) {
+        PRINT_SDL_ERROR("Failed to create context");
+        goto err_create_context;
     }
 
-    draw_job_t *tmp_job;
-
-    while ((tmp_job = popDrawJob()) != NULL) {
-        if (!tmp_job->data) {
-            goto err;
-        }
-        if (vHandleDrawJob(tmp_job) == -1) {
-            goto draw_error;
-        }
-        free(tmp_job);
+    if (SDL_GL_MakeCurrent(window, context) < 0) {
+        PRINT_SDL_ERROR("Claiming current context failed");
+        goto err_make_current;
     }
 
-    pthread_mutex_unlock(&job_list_lock);
-
-    SDL_RenderPresent(renderer);
+    if (SDL_GL_MakeCurrent(window, NULL) < 0) {
+        PRINT_SDL_ERROR("Releasing current context failed");
+        goto err_make_current;
+    }
 
     return 0;
 
-draw_error:
-    free(tmp_job);
-err:
-    pthread_mutex_unlock(&job_list_lock);
+err_make_current:
+    SDL_GL_DeleteContext(context);
+    context = NULL;
+err_create_context:
+    SDL_DestroyWindow(window);
+    window = NULL;
+err_window:
     return -1;
-no_jobs:
-    pthread_mutex_unlock(&job_list_lock);
-    return 0;
-}
-
-char *gfxGetErrorMessage(void)
-{
-    return error_message;
 }
 
 int gfxDrawInit(char *path) // Should be called from the Thread running main()
 {
+    unsigned int i;
+    int phase;
+
     /* Relevant for Docker-based toolchain */
 #ifdef DOCKER
 #ifndef HOST_OS
@@ -1060,69 +3101,86 @@ int gfxDrawInit(char *path) // Should be called from the Thread running main()
 #endif /* DOCKER */
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_AUDIO)) {
+    // Fonts only need TTF and the resource directory, not SDL
+    init_tasks.fonts = (struct init_task) {
+        .name = "fonts", .task = _initFonts, .arg = path
+    };
+    _startInitTask(&init_tasks.fonts);
+
+    // In split mode the window belongs to the viewer
+    phase = gfxUtilInitPhaseBegin("SDL_Init");
+    if (SDL_Init((split_mode.socket_path ? 0 : SDL_INIT_VIDEO) |
+                 SDL_INIT_EVENTS | SDL_INIT_AUDIO)) {
         PRINT_SDL_ERROR("SDL_Init failed");
+        gfxUtilInitPhaseEnd(phase);
         goto err_sdl;
     }
-    if (TTF_Init()) {
-        PRINT_ERROR("TTF_Init failed");
-        goto err_ttf;
-    }
+    gfxUtilInitPhaseEnd(phase);
 
-    if (gfxFontInit(path)) {
-        PRINT_ERROR("GFX Font init failed");
-        goto err_gfx_font;
+    for (i = 0; i < init_tasks.count; i++) {
+        _startInitTask(&init_tasks.tasks[i]);
     }
 
-    window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
-                              SDL_WINDOWPOS_CENTERED, screen_width,
-                              screen_height, SDL_WINDOW_OPENGL);
-
-    if (window == NULL) {
-        PRINT_SDL_ERROR("Failed to create %d x %d window '%s'",
-                        screen_width, screen_height, WINDOW_TITLE);
-        goto err_window;
+    if (split_mode.socket_path) {
+        split_mode.channel = gfxRemoteListen(split_mode.socket_path,
+                                             GFX_REMOTE_RING_SIZE);
+        if (split_mode.channel == NULL) {
+            goto err_window;
+        }
     }
-
-    context = SDL_GL_CreateContext(window);
-
-    if (context == NULL) {
-        PRINT_SDL_ERROR("Failed to create context");
-        goto err_create_context;
+    else if (_createWindow()) {
+        goto err_window;
     }
 
-    if (SDL_GL_MakeCurrent(window, context) < 0) {
-        PRINT_SDL_ERROR("Claiming current context failed");
-        goto err_make_current;
+    if (_joinInitTasks()) {
+        goto err_tasks;
     }
 
-    if (SDL_GL_MakeCurrent(window, NULL) < 0) {
-        PRINT_SDL_ERROR("Releasing current context failed");
-        goto err_make_current;
-    }
+    gfxUtilAddResourceListener(_reloadChangedImage);
 
+    phase = gfxUtilInitPhaseBegin("renderer");
     gfxDrawBindThread();
+    gfxUtilInitPhaseEnd(phase);
 
     atexit(SDL_Quit);
 
+#if GFX_INIT_REPORT
+    gfxUtilInitReport(stdout);
+#endif // GFX_INIT_REPORT
+
     return 0;
 
-err_make_current:
-    SDL_GL_DeleteContext(context);
-err_create_context:
-    SDL_DestroyWindow(window);
+err_tasks:
+    if (split_mode.channel) {
+        gfxRemoteClose(split_mode.channel);
+        split_mode.channel = NULL;
+    }
+    else {
+        SDL_GL_DeleteContext(context);
+        SDL_DestroyWindow(window);
+    }
 err_window:
-    gfxFontExit();
-err_gfx_font:
-    TTF_Quit();
-err_ttf:
+    _joinInitTasks();
     SDL_Quit();
 err_sdl:
+    _joinInitTasks();
+    if (!init_tasks.fonts.ret) {
+        gfxFontExit();
+        TTF_Quit();
+    }
     return -1;
 }
 
 int gfxDrawBindThread(void) // Should be called from the Drawing Thread
 {
+    // There is nothing to render to in split mode
+    if (split_mode.channel) {
+        if (gfxUtilIsCurGLThread()) {
+            gfxUtilSetGLThread();
+        }
+        return 0;
+    }
+
     if (gfxUtilIsCurGLThread() || !renderer) {
         if (SDL_GL_MakeCurrent(window, context) < 0) {
             PRINT_SDL_ERROR("Releasing current context failed");
@@ -1134,6 +3192,14 @@ int gfxDrawBindThread(void) // Should be called from the Drawing Thread
             renderer = NULL;
         }
 
+        gfxHUDForgetTexture();
+        renderer_generation++;
+
+        gfx_mem_stats_t stats;
+
+        gfxUtilMemStatsGet(&stats);
+        gfxUtilMemSub(GFX_MEM_TEXTURES, stats.bytes[GFX_MEM_TEXTURES]);
+
         renderer =
             SDL_CreateRenderer(window, -1,
                                SDL_RENDERER_ACCELERATED |
@@ -1150,17 +3216,19 @@ int gfxDrawBindThread(void) // Should be called from the Drawing Thread
 
         SDL_RenderClear(renderer);
 
-        pthread_mutex_lock(&loaded_images_lock);
+        GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
         loaded_image_t *iterator = &loaded_images_list;
+        unsigned i;
 
-        for (; iterator; iterator = iterator->next)
-            if (iterator->tex) {
-                SDL_DestroyTexture(iterator->tex);
-                iterator->tex = SDL_CreateTextureFromSurface(
-                                    renderer, iterator->surf);
+        // Destroyed along with the old renderer, recreated on next draw
+        for (; iterator; iterator = iterator->next) {
+            iterator->tex = NULL;
+            for (i = 0; i < GFX_IMAGE_MIP_LEVELS; i++) {
+                iterator->mips[i].tex = NULL;
             }
+        }
 
-        pthread_mutex_unlock(&loaded_images_lock);
+        GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
 
         gfxUtilSetGLThread();
     }
@@ -1186,6 +3254,12 @@ void gfxDrawExit(void)
         SDL_DestroyRenderer(renderer);
     }
 
+    gfxHUDFree();
+
+    if (split_mode.channel) {
+        gfxRemoteClose(split_mode.channel);
+    }
+
     TTF_Quit();
     SDL_Quit();
 
@@ -1204,6 +3278,7 @@ int gfxDrawText(char *str, signed short x, signed short y, unsigned int colour)
 
     if (job->data->text.str == NULL) {
         printf("Error allocating buffer in gfxDrawText\n");
+        gfxDrawDiscardJob(job);
         return -1;
     }
 
@@ -1213,6 +3288,8 @@ int gfxDrawText(char *str, signed short x, signed short y, unsigned int colour)
     job->data->text.y = y;
     job->data->text.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1246,6 +3323,8 @@ int gfxDrawEllipse(signed short x, signed short y, signed short rx,
     job->data->ellipse.ry = ry;
     job->data->ellipse.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1261,6 +3340,8 @@ int gfxDrawArc(signed short x, signed short y, signed short radius,
     job->data->arc.end = end;
     job->data->arc.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1275,6 +3356,8 @@ int gfxDrawFilledBox(signed short x, signed short y, signed short w,
     job->data->rect.h = h;
     job->data->rect.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1289,11 +3372,17 @@ int gfxDrawBox(signed short x, signed short y, signed short w, signed short h,
     job->data->rect.h = h;
     job->data->rect.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
 void gfxDrawDuplicateBuffer(void)
 {
+    if (renderer == NULL) {
+        return;
+    }
+
     SDL_Surface *screen_shot =
         SDL_CreateRGBSurface(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32,
                              0x00ff0000, 0x0000ff00, 0x000000ff,
@@ -1313,6 +3402,8 @@ int gfxDrawClear(unsigned int colour)
 
     job->data->clear.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1326,6 +3417,8 @@ int gfxDrawCircle(signed short x, signed short y, signed short radius,
     job->data->circle.radius = radius;
     job->data->circle.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1341,53 +3434,72 @@ int gfxDrawLine(signed short x1, signed short y1, signed short x2,
     job->data->line.thickness = thickness;
     job->data->line.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
-int gfxDrawPoly(coord_t *points, int n, unsigned int colour)
+static int _pushPolyJob(draw_job_type_t type, coord_t *points, int n,
+                        unsigned char thickness, unsigned int colour)
 {
-    INIT_JOB(job, DRAW_POLY);
+    int i, min_points = type == DRAW_POLYLINE ? 2 : 3;
 
-    coord_t *points_cpy = (coord_t *)calloc(n, sizeof(coord_t));
-    if (!points_cpy) {
+    if (points == NULL || n < min_points) {
+        PRINT_ERROR("%s requires at least %d points",
+                    draw_job_names[type], min_points);
         return -1;
     }
 
-    memcpy(points_cpy, points, sizeof(coord_t) * n);
+    // Points are stored as separate X and Y arrays in the job's data block
+    INIT_JOB_EXTRA(job, type, 2 * n * sizeof(Sint16));
+
+    job->data->poly.x = (Sint16 *)(job->data + 1);
+    job->data->poly.y = job->data->poly.x + n;
+
+    for (i = 0; i < n; i++) {
+        job->data->poly.x[i] = points[i].x;
+        job->data->poly.y[i] = points[i].y;
+    }
 
-    job->data->poly.points = points_cpy;
     job->data->poly.n = n;
+    job->data->poly.thickness = thickness;
     job->data->poly.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
-int gfxDrawTriangle(coord_t *points, unsigned int colour)
+int gfxDrawPoly(coord_t *points, int n, unsigned int colour)
 {
-    INIT_JOB(job, DRAW_TRIANGLE);
+    return _pushPolyJob(DRAW_POLY, points, n, 0, colour);
+}
 
-    coord_t *points_cpy = (coord_t *)calloc(3, sizeof(coord_t));
-    if (!points_cpy) {
-        return -1;
-    }
+int gfxDrawFilledPoly(coord_t *points, int n, unsigned int colour)
+{
+    return _pushPolyJob(DRAW_FILLED_POLY, points, n, 0, colour);
+}
+
+int gfxDrawPolyline(coord_t *points, int n, unsigned char thickness,
+                    unsigned int colour)
+{
+    return _pushPolyJob(DRAW_POLYLINE, points, n, thickness, colour);
+}
 
-    memcpy(points_cpy, points, sizeof(coord_t) * 3);
+int gfxDrawTriangle(coord_t *points, unsigned int colour)
+{
+    INIT_JOB(job, DRAW_TRIANGLE);
 
-    job->data->triangle.points = points_cpy;
+    memcpy(job->data->triangle.points, points, sizeof(coord_t) * 3);
     job->data->triangle.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
 gfx_image_handle_t gfxDrawLoadScaledImage(char *filename, float scale)
 {
-    if (!renderer || gfxUtilIsCurGLThread()) {
-        gfxDrawBindThread();
-        if (!renderer) {
-            goto err_renderer;
-        }
-    }
-
     loaded_image_t *ret = calloc(1, sizeof(loaded_image_t));
     if (ret == NULL) {
         PRINT_ERROR("Failed to allocate loaded image");
@@ -1417,30 +3529,25 @@ gfx_image_handle_t gfxDrawLoadScaledImage(char *filename, float scale)
         PRINT_SDL_ERROR("Failed to load image");
         goto err_surf;
     }
+    gfxUtilMemAdd(GFX_MEM_SURFACES, _surfaceBytes(ret->surf));
 
-    ret->tex = SDL_CreateTextureFromSurface(renderer, ret->surf);
-    if (ret->tex == NULL) {
-        PRINT_SDL_ERROR("Failed to create texture from surface");
-        goto err_tex;
-    }
-
-    SDL_QueryTexture(ret->tex, NULL, NULL, &ret->w, &ret->h);
-
+    // The texture is created by the GL thread when the image is first drawn
+    ret->w = ret->surf->w;
+    ret->h = ret->surf->h;
     ret->scale = scale;
+    ret->ref_count = 1;
 
-    pthread_mutex_lock(&loaded_images_lock);
+    GFX_MUTEX_LOCK(&loaded_images_lock, loaded_images_lock_stats);
 
     loaded_image_t *iterator = &loaded_images_list;
     for (; iterator->next; iterator = iterator->next)
         ;
     iterator->next = ret;
 
-    pthread_mutex_unlock(&loaded_images_lock);
+    GFX_MUTEX_UNLOCK(&loaded_images_lock, loaded_images_lock_stats);
 
     return ret;
 
-err_tex:
-    SDL_FreeSurface(ret->surf);
 err_surf:
     SDL_RWclose(ret->ops);
 err_ops:
@@ -1450,7 +3557,6 @@ err_file_open:
 err_filename:
     free(ret);
 err_alloc:
-err_renderer:
     return NULL;
 }
 
@@ -1461,17 +3567,15 @@ gfx_image_handle_t gfxDrawLoadImage(char *filename)
 
 int gfxDrawFreeLoadedImage(gfx_image_handle_t *img)
 {
-    int ret = 0;
-    loaded_image_t **loaded_img = (loaded_image_t **)img;
-
-    if (!(*loaded_img)->ref_count) {
-        ret = freeLoadedImage(loaded_img);
-    }
-    else {
-        (*loaded_img)->pending_free = 1;
+    if (img == NULL || *img == NULL) {
+        return -1;
     }
 
-    return ret;
+    // Drops the handle's reference, queued draw jobs keep the image alive
+    vPutLoadedImage(*img);
+    *img = NULL;
+
+    return 0;
 }
 
 int gfxDrawLoadedImage(gfx_image_handle_t img, signed short x, signed short y)
@@ -1480,12 +3584,31 @@ int gfxDrawLoadedImage(gfx_image_handle_t img, signed short x, signed short y)
         return -1;
     }
 
+    return gfxDrawLoadedImageScaled(img, x, y,
+                                    ((loaded_image_t *)img)->scale);
+}
+
+int gfxDrawLoadedImageScaled(gfx_image_handle_t img, signed short x,
+                             signed short y, float scale)
+{
+    if (img == NULL) {
+        return -1;
+    }
+
+    if (!(scale > 0)) {
+        PRINT_ERROR("Image scale must be positive");
+        return -1;
+    }
+
     INIT_JOB(job, DRAW_LOADED_IMAGE);
 
-    ((loaded_image_t *)img)->ref_count++;
+    vGetLoadedImage((loaded_image_t *)img);
     job->data->loaded_image.img = img;
     job->data->loaded_image.x = x;
     job->data->loaded_image.y = y;
+    job->data->loaded_image.scale = scale;
+
+    gfxDrawPushJob(job);
 
     return 0;
 }
@@ -1552,6 +3675,7 @@ int __attribute_deprecated__ gfxDrawImage(char *filename, signed short x,
     char abs_path[PATH_MAX + 1];
 
     if (realpath(filename, (char *)abs_path) == NULL) {
+        gfxDrawDiscardJob(job);
         return -1;
     }
 
@@ -1560,6 +3684,8 @@ int __attribute_deprecated__ gfxDrawImage(char *filename, signed short x,
     job->data->image.x = x;
     job->data->image.y = y;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1609,10 +3735,23 @@ void gfxDrawSpritesheetSetPadding(spritesheet_t *spritesheet,
  * @param spritesheet Sprite sheet to be set
  * @param cols Number of columns on the spritesheet
  * @param rows Number of rows on the spritesheet
+ * @return 0 on success
  */
-void gfxDrawSpritesheetSetDivisions(spritesheet_t *spritesheet, unsigned cols,
-                                    unsigned rows)
+int gfxDrawSpritesheetSetDivisions(spritesheet_t *spritesheet, unsigned cols,
+                                   unsigned rows)
 {
+    if (!cols || !rows) {
+        PRINT_ERROR("Spritesheet requires at least one column and row");
+        return -1;
+    }
+
+    SDL_Rect *cells = calloc(cols * rows, sizeof(SDL_Rect));
+    if (cells == NULL) {
+        PRINT_ERROR("Could not allocate rects for %ux%u spritesheet", cols,
+                    rows);
+        return -1;
+    }
+
     unsigned total_x_padding_pixels =
         spritesheet->padding_x * (cols - 1) * 2;
     unsigned total_y_padding_pixels =
@@ -1623,6 +3762,29 @@ void gfxDrawSpritesheetSetDivisions(spritesheet_t *spritesheet, unsigned cols,
         (spritesheet->width - total_x_padding_pixels) / cols;
     spritesheet->sprite_height =
         (spritesheet->height - total_y_padding_pixels) / rows;
+
+    // There is no padding before the first sprite, each following sprite is
+    // offset by its predecessor's padding on both sides
+    unsigned col, row;
+
+    for (row = 0; row < rows; row++)
+        for (col = 0; col < cols; col++) {
+            SDL_Rect *cell = &cells[row * cols + col];
+
+            cell->x = spritesheet->x +
+                      col * (spritesheet->sprite_width +
+                             spritesheet->padding_x * 2);
+            cell->y = spritesheet->y +
+                      row * (spritesheet->sprite_height +
+                             spritesheet->padding_y * 2);
+            cell->w = spritesheet->sprite_width;
+            cell->h = spritesheet->sprite_height;
+        }
+
+    free(spritesheet->cells);
+    spritesheet->cells = cells;
+
+    return 0;
 }
 
 gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromEntireImageUnpadded(
@@ -1633,7 +3795,10 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromEntireImageUnpadded(
         return NULL;
     }
 
-    gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows);
+    if (gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows)) {
+        free(ret);
+        return NULL;
+    }
 
     return (gfx_spritesheet_handle_t)ret;
 }
@@ -1648,7 +3813,10 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromEntireImagePadded(
     }
 
     gfxDrawSpritesheetSetPadding(ret, sprite_padding_x, sprite_padding_y);
-    gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows);
+    if (gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows)) {
+        free(ret);
+        return NULL;
+    }
 
     return (gfx_spritesheet_handle_t)ret;
 }
@@ -1664,7 +3832,10 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromEntireImagePaddedSpacing(
 
     gfxDrawSpritesheetSetPadding(ret, sprite_spacing_x / 2,
                                  sprite_spacing_y / 2);
-    gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows);
+    if (gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows)) {
+        free(ret);
+        return NULL;
+    }
 
     return (gfx_spritesheet_handle_t)ret;
 }
@@ -1683,7 +3854,10 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromPortionOfImageUnpadded(
                                      bounding_box_top_y_pixel,
                                      sprite_width *sprite_cols,
                                      sprite_height *sprite_rows);
-    gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows);
+    if (gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows)) {
+        free(ret);
+        return NULL;
+    }
 
     return (gfx_spritesheet_handle_t)ret;
 }
@@ -1709,7 +3883,10 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromPortionOfImagePadded(
         sprite_rows *sprite_height +
         (sprite_rows - 1) * sprite_padding_y * 2);
     gfxDrawSpritesheetSetPadding(ret, sprite_padding_x, sprite_padding_y);
-    gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows);
+    if (gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows)) {
+        free(ret);
+        return NULL;
+    }
 
     return (gfx_spritesheet_handle_t)ret;
 }
@@ -1733,52 +3910,41 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromPortionOfImagePaddedSpacing(
         (sprite_rows - 1) * sprite_spacing_y);
     gfxDrawSpritesheetSetPadding(ret, sprite_spacing_x / 2,
                                  sprite_spacing_y / 2);
-    gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows);
+    if (gfxDrawSpritesheetSetDivisions(ret, sprite_cols, sprite_rows)) {
+        free(ret);
+        return NULL;
+    }
 
     return (gfx_spritesheet_handle_t)ret;
 }
 
-int gfxDrawSprite(gfx_spritesheet_handle_t spritesheet, char column, char row,
-                  signed short x, signed short y)
+int gfxDrawSpriteIndex(gfx_spritesheet_handle_t spritesheet, unsigned index,
+                       signed short x, signed short y)
 {
-    if (spritesheet == NULL) {
-        PRINT_ERROR("No spritesheet given to draw from");
-        goto err;
-    }
+    spritesheet_t *sheet = (spritesheet_t *)spritesheet;
 
-    if (column < 0 ||
-        column > ((spritesheet_t *)spritesheet)->sprite_cols) {
-        PRINT_ERROR("Spritesheet column not valid");
+    if (sheet == NULL) {
+        PRINT_ERROR("No spritesheet given to draw from");
         goto err;
     }
 
-    if (row < 0 || row > ((spritesheet_t *)spritesheet)->sprite_rows) {
-        PRINT_ERROR("Spritesheet row not valid");
+    if (index >= sheet->sprite_cols * sheet->sprite_rows) {
+        PRINT_ERROR("Spritesheet index %u not valid", index);
         goto err;
     }
 
     INIT_JOB(job, DRAW_LOADED_IMAGE_CROP);
 
-    ((spritesheet_t *)spritesheet)->image->ref_count++;
-    job->data->loaded_image_crop.image =
-        ((spritesheet_t *)spritesheet)->image;
+    vGetLoadedImage(sheet->image);
+    job->data->loaded_image_crop.image = sheet->image;
     job->data->loaded_image_crop.x = x;
     job->data->loaded_image_crop.y = y;
-    job->data->loaded_image_crop.c_w =
-        ((spritesheet_t *)spritesheet)->sprite_width;
-    job->data->loaded_image_crop.c_h =
-        ((spritesheet_t *)spritesheet)->sprite_height;
-
-    // X and Y need to incorporate row or column * 2 + 1 instances of the
-    // sprite's padding
-    job->data->loaded_image_crop.c_x =
-        column * (((spritesheet_t *)spritesheet)->sprite_width +
-                  ((spritesheet_t *)spritesheet)->padding_x * 2) +
-        ((spritesheet_t *)spritesheet)->padding_x;
-    job->data->loaded_image_crop.c_y =
-        row * (((spritesheet_t *)spritesheet)->sprite_height +
-               ((spritesheet_t *)spritesheet)->padding_y * 2) +
-        ((spritesheet_t *)spritesheet)->padding_y;
+    job->data->loaded_image_crop.c_x = sheet->cells[index].x;
+    job->data->loaded_image_crop.c_y = sheet->cells[index].y;
+    job->data->loaded_image_crop.c_w = sheet->cells[index].w;
+    job->data->loaded_image_crop.c_h = sheet->cells[index].h;
+
+    gfxDrawPushJob(job);
 
     return 0;
 
@@ -1786,6 +3952,33 @@ err:
     return -1;
 }
 
+int gfxDrawSprite(gfx_spritesheet_handle_t spritesheet, unsigned column,
+                  unsigned row, signed short x, signed short y)
+{
+    if (spritesheet == NULL) {
+        PRINT_ERROR("No spritesheet given to draw from");
+        goto err;
+    }
+
+    if (column >= ((spritesheet_t *)spritesheet)->sprite_cols) {
+        PRINT_ERROR("Spritesheet column not valid");
+        goto err;
+    }
+
+    if (row >= ((spritesheet_t *)spritesheet)->sprite_rows) {
+        PRINT_ERROR("Spritesheet row not valid");
+        goto err;
+    }
+
+    return gfxDrawSpriteIndex(
+               spritesheet,
+               row * ((spritesheet_t *)spritesheet)->sprite_cols + column, x,
+               y);
+
+err:
+    return -1;
+}
+
 int __attribute_deprecated__ gfxGetImageSize(char *filename, int *w, int *h)
 {
     char full_filename[PATH_MAX + 1];
@@ -1801,6 +3994,7 @@ int __attribute_deprecated__ gfxDrawScaledImage(char *filename, signed short x,
     char abs_path[PATH_MAX + 1];
 
     if (realpath(filename, (char *)abs_path) == NULL) {
+        gfxDrawDiscardJob(job);
         return -1;
     }
 
@@ -1811,6 +4005,8 @@ int __attribute_deprecated__ gfxDrawScaledImage(char *filename, signed short x,
     job->data->scaled_image.image.y = y;
     job->data->scaled_image.scale = scale;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1828,6 +4024,8 @@ int gfxDrawArrow(signed short x1, signed short y1, signed short x2,
     job->data->arrow.thickness = thickness;
     job->data->arrow.colour = colour;
 
+    gfxDrawPushJob(job);
+
     return 0;
 }
 
@@ -1838,17 +4036,8 @@ void gfxDrawAnimationReset(gfx_sequence_handle_t sequence)
 
     anim->prev_frame_timestamp = 0;
     anim->cur_frame_timestamp = 0;
-
-    if (anim->sequence->direction ==
-        SPRITE_SEQUENCE_HORIZONTAL_POS ||
-        anim->sequence->direction == SPRITE_SEQUENCE_HORIZONTAL_NEG) {
-        anim->current_frame = anim->sequence->start_col;
-    }
-    else if (anim->sequence->direction ==
-             SPRITE_SEQUENCE_VERTICAL_POS ||
-             anim->sequence->direction == SPRITE_SEQUENCE_VERTICAL_NEG) {
-        anim->current_frame = anim->sequence->start_row;
-    }
+    anim->clock_timestamp = gfxDrawFrameClockGetMs();
+    anim->current_frame = 0;
 }
 
 int gfxDrawAnimationDrawFrame(gfx_sequence_handle_t sequence,
@@ -1861,98 +4050,70 @@ int gfxDrawAnimationDrawFrame(gfx_sequence_handle_t sequence,
 
     animated_sequence_instance_t *anim =
         (animated_sequence_instance_t *)sequence;
+    unsigned clock_now = gfxDrawFrameClockGetMs();
+
+    if (ms_timestep == GFX_FRAME_CLOCK) {
+        ms_timestep = clock_now - anim->clock_timestamp;
+    }
+    anim->clock_timestamp = clock_now;
 
     anim->cur_frame_timestamp += ms_timestep;
 
     if (anim->cur_frame_timestamp >
         (anim->prev_frame_timestamp + anim->frame_period_ms)) {
-
-        if (anim->sequence->direction ==
-            SPRITE_SEQUENCE_HORIZONTAL_POS ||
-            anim->sequence->direction == SPRITE_SEQUENCE_VERTICAL_POS) {
-            anim->current_frame += ((anim->cur_frame_timestamp -
-                                     anim->prev_frame_timestamp) /
-                                    anim->frame_period_ms);
-            anim->current_frame %= anim->sequence->frames;
-        }
-        else if (anim->sequence->direction ==
-                 SPRITE_SEQUENCE_HORIZONTAL_NEG ||
-                 anim->sequence->direction ==
-                 SPRITE_SEQUENCE_VERTICAL_NEG) {
-            anim->current_frame -= ((anim->cur_frame_timestamp -
-                                     anim->prev_frame_timestamp) /
-                                    anim->frame_period_ms);
-            if (anim->current_frame == -1)
-                anim->current_frame =
-                    anim->sequence->frames - 1;
-        }
-
-        anim->prev_frame_timestamp += (((anim->cur_frame_timestamp -
-                                         anim->prev_frame_timestamp) /
-                                        anim->frame_period_ms) *
-                                       anim->frame_period_ms);
+        unsigned steps = (anim->cur_frame_timestamp -
+                          anim->prev_frame_timestamp) /
+                         anim->frame_period_ms;
+
+        // Frame rects are stored in playback order, whatever the direction
+        anim->current_frame =
+            (anim->current_frame + steps) % anim->sequence->frames;
+        anim->prev_frame_timestamp += steps * anim->frame_period_ms;
     }
 
     INIT_JOB(job, DRAW_LOADED_IMAGE_CROP);
 
-    anim->image->spritesheet->image->ref_count++;
+    SDL_Rect *src = &anim->sequence->rects[anim->current_frame];
+
+    vGetLoadedImage(anim->image->spritesheet->image);
     job->data->loaded_image_crop.image = anim->image->spritesheet->image;
     job->data->loaded_image_crop.x = x;
     job->data->loaded_image_crop.y = y;
-    job->data->loaded_image_crop.c_w =
-        anim->image->spritesheet->sprite_width;
-    job->data->loaded_image_crop.c_h =
-        anim->image->spritesheet->sprite_height;
-
-    switch (anim->sequence->direction) {
-        case SPRITE_SEQUENCE_HORIZONTAL_POS:
-        case SPRITE_SEQUENCE_HORIZONTAL_NEG: {
-            unsigned cur_frame_index_offset =
-                (anim->current_frame + anim->sequence->start_col) %
-                anim->sequence->frames;
-            job->data->loaded_image_crop.c_x =
-                anim->image->spritesheet->x +
-                cur_frame_index_offset *
-                (anim->image->spritesheet->sprite_width +
-                 anim->image->spritesheet->padding_x * 2);
-            job->data->loaded_image_crop.c_y =
-                anim->image->spritesheet->y +
-                anim->sequence->start_row *
-                (anim->image->spritesheet->sprite_height +
-                 anim->image->spritesheet->padding_y * 2);
-        } break;
-        case SPRITE_SEQUENCE_VERTICAL_POS:
-        case SPRITE_SEQUENCE_VERTICAL_NEG: {
-            unsigned cur_frame_index_offset =
-                (anim->current_frame + anim->sequence->start_row) %
-                anim->sequence->frames;
-            job->data->loaded_image_crop.c_x =
-                anim->image->spritesheet->x +
-                anim->sequence->start_col *
-                (anim->image->spritesheet->sprite_width +
-                 anim->image->spritesheet->padding_x * 2);
-            job->data->loaded_image_crop.c_y =
-                anim->image->spritesheet->y +
-                cur_frame_index_offset *
-                (anim->image->spritesheet->sprite_height +
-                 anim->image->spritesheet->padding_y * 2);
-        } break;
-        default:
-            break;
-    }
+    job->data->loaded_image_crop.c_x = src->x;
+    job->data->loaded_image_crop.c_y = src->y;
+    job->data->loaded_image_crop.c_w = src->w;
+    job->data->loaded_image_crop.c_h = src->h;
+
+    gfxDrawPushJob(job);
 
     return 0;
 err:
     return -1;
 }
 
+void gfxDrawSetMemoryBudget(size_t bytes)
+{
+    __atomic_store_n(&memory_budget.bytes, bytes, __ATOMIC_RELAXED);
+}
+
+size_t gfxDrawGetMemoryBudget(void)
+{
+    return __atomic_load_n(&memory_budget.bytes, __ATOMIC_RELAXED);
+}
+
+unsigned long gfxDrawGetMemoryEvictions(void)
+{
+    return __atomic_load_n(&memory_budget.evictions, __ATOMIC_RELAXED);
+}
+
 int gfxDrawSetGlobalXOffset(int offset)
 {
     int ret;
 
-    if (!(ret = pthread_mutex_lock(&global_offset.lock))) {
+    if (!(ret = GFX_MUTEX_LOCK(&global_offset.lock,
+                               global_offset_lock_stats))) {
         global_offset.x = offset;
-        pthread_mutex_unlock(&global_offset.lock);
+        GFX_MUTEX_UNLOCK(&global_offset.lock, global_offset_lock_stats);
     }
     else {
         PRINT_ERROR("Could not set global X offset");
@@ -1965,9 +4126,10 @@ int gfxDrawSetGlobalYOffset(int offset)
 {
     int ret;
 
-    if (!(ret = pthread_mutex_lock(&global_offset.lock))) {
+    if (!(ret = GFX_MUTEX_LOCK(&global_offset.lock,
+                               global_offset_lock_stats))) {
         global_offset.y = offset;
-        pthread_mutex_unlock(&global_offset.lock);
+        GFX_MUTEX_UNLOCK(&global_offset.lock, global_offset_lock_stats);
     }
     else {
         PRINT_ERROR("Could not set global Y offset");
@@ -1980,9 +4142,10 @@ int gfxDrawGetGlobalXOffset(int *offset)
 {
     int ret;
 
-    if (!(ret = pthread_mutex_lock(&global_offset.lock))) {
+    if (!(ret = GFX_MUTEX_LOCK(&global_offset.lock,
+                               global_offset_lock_stats))) {
         *offset = global_offset.x;
-        pthread_mutex_unlock(&global_offset.lock);
+        GFX_MUTEX_UNLOCK(&global_offset.lock, global_offset_lock_stats);
     }
     else {
         PRINT_ERROR("Could not get global X offset");
@@ -1995,9 +4158,10 @@ int gfxDrawGetGlobalYOffset(int *offset)
 {
     int ret;
 
-    if (!(ret = pthread_mutex_lock(&global_offset.lock))) {
+    if (!(ret = GFX_MUTEX_LOCK(&global_offset.lock,
+                               global_offset_lock_stats))) {
         *offset = global_offset.y;
-        pthread_mutex_unlock(&global_offset.lock);
+        GFX_MUTEX_UNLOCK(&global_offset.lock, global_offset_lock_stats);
     }
     else {
         PRINT_ERROR("Could not get global Y offset");
@@ -47,8 +47,10 @@ typedef struct mouse {
 QueueHandle_t buttonInputQueue = NULL;
 
 mouse_t mouse;
+GFX_LOCK_STATS(mouse_lock_stats, "mouse.lock");
 
 xSemaphoreHandle fetch_lock;
+GFX_LOCK_STATS(fetch_lock_stats, "fetch_lock");
 
 static int _initMouse(void)
 {
@@ -77,6 +79,10 @@ static void _SDLFetchEvents(void)
             exit(EXIT_SUCCESS);
         }
         else if (event.type == SDL_KEYDOWN) {
+            if (event.key.keysym.scancode == HUD_TOGGLE_SCANCODE &&
+                !event.key.repeat) {
+                gfxDrawHUDToggle();
+            }
             buttons[event.key.keysym.scancode] = 1;
             send = 1;
         }
@@ -85,15 +91,15 @@ static void _SDLFetchEvents(void)
             send = 1;
         }
         else if (event.type == SDL_MOUSEMOTION) {
-            if (xSemaphoreTake(mouse.lock, 0) == pdTRUE) {
+            if (GFX_SEMAPHORE_TAKE(mouse.lock, 0, mouse_lock_stats) == pdTRUE) {
                 mouse.x = event.motion.x;
                 mouse.y = event.motion.y;
-                xSemaphoreGive(mouse.lock);
+                GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
             }
 
         }
         else if (event.type == SDL_MOUSEBUTTONDOWN) {
-            if (xSemaphoreTake(mouse.lock, 0) == pdTRUE) {
+            if (GFX_SEMAPHORE_TAKE(mouse.lock, 0, mouse_lock_stats) == pdTRUE) {
                 switch (event.button.button) {
                     case SDL_BUTTON_LEFT:
                         mouse.left_button = 1;
@@ -108,12 +114,12 @@ static void _SDLFetchEvents(void)
                         break;
                 }
                 send = 1;
-                xSemaphoreGive(mouse.lock);
+                GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
             }
 
         }
         else if (event.type == SDL_MOUSEBUTTONUP) {
-            if (xSemaphoreTake(mouse.lock, 0) == pdTRUE) {
+            if (GFX_SEMAPHORE_TAKE(mouse.lock, 0, mouse_lock_stats) == pdTRUE) {
                 switch (event.button.button) {
                     case SDL_BUTTON_LEFT:
                         mouse.left_button = 0;
@@ -128,7 +134,7 @@ static void _SDLFetchEvents(void)
                         break;
                 }
                 send = 1;
-                xSemaphoreGive(mouse.lock);
+                GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
             }
         }
     }
@@ -156,15 +162,15 @@ int gfxEventFetchEvents(int flags)
         }
 
     if ((flags >> FETCH_BLOCK_S) & 0x01) {
-        xSemaphoreTake(fetch_lock, portMAX_DELAY);
+        GFX_SEMAPHORE_TAKE(fetch_lock, portMAX_DELAY, fetch_lock_stats);
         _SDLFetchEvents();
-        xSemaphoreGive(fetch_lock);
+        GFX_SEMAPHORE_GIVE(fetch_lock, fetch_lock_stats);
         return 0;
     }
     else {
-        if (xSemaphoreTake(fetch_lock, 0) == pdTRUE) {
+        if (GFX_SEMAPHORE_TAKE(fetch_lock, 0, fetch_lock_stats) == pdTRUE) {
             _SDLFetchEvents();
-            xSemaphoreGive(fetch_lock);
+            GFX_SEMAPHORE_GIVE(fetch_lock, fetch_lock_stats);
             return 0;
         }
     }
@@ -175,9 +181,9 @@ signed short gfxEventGetMouseX(void)
 {
     signed short ret;
 
-    xSemaphoreTake(mouse.lock, portMAX_DELAY);
+    GFX_SEMAPHORE_TAKE(mouse.lock, portMAX_DELAY, mouse_lock_stats);
     ret = mouse.x;
-    xSemaphoreGive(mouse.lock);
+    GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
     if (ret >= 0 && ret <= SCREEN_WIDTH) {
         return ret;
     }
@@ -188,9 +194,9 @@ signed short gfxEventGetMouseY(void)
 {
     signed short ret;
 
-    xSemaphoreTake(mouse.lock, portMAX_DELAY);
+    GFX_SEMAPHORE_TAKE(mouse.lock, portMAX_DELAY, mouse_lock_stats);
     ret = mouse.y;
-    xSemaphoreGive(mouse.lock);
+    GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
 
     if (ret >= 0 && ret <= SCREEN_HEIGHT) {
         return ret;
@@ -202,9 +208,9 @@ signed char gfxEventGetMouseLeft(void)
 {
     signed char ret;
 
-    xSemaphoreTake(mouse.lock, portMAX_DELAY);
+    GFX_SEMAPHORE_TAKE(mouse.lock, portMAX_DELAY, mouse_lock_stats);
     ret = mouse.left_button;
-    xSemaphoreGive(mouse.lock);
+    GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
 
     return ret;
 }
@@ -213,9 +219,9 @@ signed char gfxEventGetMouseRight(void)
 {
     signed char ret;
 
-    xSemaphoreTake(mouse.lock, portMAX_DELAY);
+    GFX_SEMAPHORE_TAKE(mouse.lock, portMAX_DELAY, mouse_lock_stats);
     ret = mouse.right_button;
-    xSemaphoreGive(mouse.lock);
+    GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
 
     return ret;
 }
@@ -224,13 +230,18 @@ signed char gfxEventGetMouseMiddle(void)
 {
     signed char ret;
 
-    xSemaphoreTake(mouse.lock, portMAX_DELAY);
+    GFX_SEMAPHORE_TAKE(mouse.lock, portMAX_DELAY, mouse_lock_stats);
     ret = mouse.middle_button;
-    xSemaphoreGive(mouse.lock);
+    GFX_SEMAPHORE_GIVE(mouse.lock, mouse_lock_stats);
 
     return ret;
 }
 
+unsigned int gfxEventPick(signed short x, signed short y)
+{
+    return gfxDrawPickPresented(x, y);
+}
+
 int gfxEventInit(void)
 {
     if (_initMouse()) {
@@ -23,6 +23,7 @@
 
 #include <stdlib.h>
 #include <pthread.h>
+#include <sys/stat.h>
 
 #include "gfx_font.h"
 #include "gfx_utils.h"
@@ -36,6 +37,7 @@ struct gfx_font_ref {
     TTF_Font *font;
     unsigned ref_count;
     unsigned pending_free;
+    TTF_Font *reload; // Hot-reloaded font, swapped in once unreferenced
 };
 
 typedef struct gfx_font {
@@ -43,10 +45,12 @@ typedef struct gfx_font {
     char *name;
     struct gfx_font_ref font;
     unsigned size;
+    size_t bytes; // Accounted as GFX_MEM_FONTS, the size of the font file
     struct gfx_font *next;
 } gfx_font_t;
 
 pthread_mutex_t list_lock = PTHREAD_MUTEX_INITIALIZER;
+GFX_LOCK_STATS(list_lock_stats, "font list_lock");
 static struct gfx_font font_list = { 0 };
 
 static const char *fonts_dir;
@@ -72,6 +76,27 @@ static char *_getFontPath(char *font_name)
     return ret;
 }
 
+static void _accountFont(struct gfx_font *font)
+{
+    struct stat st;
+
+    gfxUtilMemSub(GFX_MEM_FONTS, font->bytes);
+    font->bytes = stat(font->path, &st) ? 0 : st.st_size;
+    gfxUtilMemAdd(GFX_MEM_FONTS, font->bytes);
+}
+
+// Fonts are handed out by their TTF_Font and found again by it when put
+// back, a reloaded font can thus only replace one that is not handed out
+static void _swapReloadedFont(struct gfx_font *font)
+{
+    if (font->font.reload && !font->font.ref_count) {
+        TTF_CloseFont(font->font.font);
+        font->font.font = font->font.reload;
+        font->font.reload = NULL;
+        _accountFont(font);
+    }
+}
+
 static struct gfx_font *_loadFont(char *font_name, ssize_t size)
 {
     struct gfx_font *ret;
@@ -95,6 +120,8 @@ static struct gfx_font *_loadFont(char *font_name, ssize_t size)
         goto err_font_open;
     }
 
+    _accountFont(ret);
+
     ret->font.ref_count = 0;
     ret->font.pending_free = 0;
 
@@ -108,6 +135,35 @@ err_alloc_def_font:
     return NULL;
 }
 
+// Resource listener, reopens fonts loaded from a changed font file
+static void _reloadChangedFont(const char *name, const char *path)
+{
+    struct gfx_font *iterator;
+    TTF_Font *font;
+
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
+
+    for (iterator = font_list.next; iterator; iterator = iterator->next) {
+        if (iterator->font.pending_free || strcmp(iterator->name, name)) {
+            continue;
+        }
+
+        font = TTF_OpenFont(path, iterator->size);
+        if (font == NULL) {
+            PRINT_TTF_ERROR("Failed to reload font '%s'", name);
+            continue;
+        }
+
+        if (iterator->font.reload) {
+            TTF_CloseFont(iterator->font.reload);
+        }
+        iterator->font.reload = font;
+        _swapReloadedFont(iterator);
+    }
+
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
+}
+
 int gfxFontInit(char *path)
 {
     const char *resource_path = gfxUtilFindResourceDirectory();
@@ -120,19 +176,25 @@ int gfxFontInit(char *path)
 
     cur_default_font = font_list.next;
 
+    gfxUtilAddResourceListener(_reloadChangedFont);
+
     return 0;
 }
 
 void gfxFontDeleteFont(struct gfx_font *font)
 {
+    gfxUtilMemSub(GFX_MEM_FONTS, font->bytes);
     free(font->path);
     TTF_CloseFont(font->font.font);
+    if (font->font.reload) {
+        TTF_CloseFont(font->font.reload);
+    }
     free(font);
 }
 
 void gfxFontExit(void)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     struct gfx_font *iterator = font_list.next;
     struct gfx_font *delete = NULL;
 
@@ -143,12 +205,12 @@ void gfxFontExit(void)
         gfxFontDeleteFont(delete);
     }
 
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 }
 
 void gfxFontPutFontHandle(font_handle_t font)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     struct gfx_font *iterator = &font_list;
     struct gfx_font *delete = NULL;
 
@@ -167,17 +229,20 @@ void gfxFontPutFontHandle(font_handle_t font)
                 }
                 gfxFontDeleteFont(iterator);
             }
-            pthread_mutex_unlock(&list_lock);
+            else {
+                _swapReloadedFont(iterator);
+            }
+            GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
             return;
         }
         delete = iterator;
     }
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 }
 
 void gfxFontPutFont(const TTF_Font *font)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     struct gfx_font *iterator = &font_list;
     struct gfx_font *delete = NULL;
 
@@ -196,50 +261,74 @@ void gfxFontPutFont(const TTF_Font *font)
                 }
                 gfxFontDeleteFont(iterator);
             }
-            pthread_mutex_unlock(&list_lock);
+            else {
+                _swapReloadedFont(iterator);
+            }
+            GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
             return;
         }
         delete = iterator;
     }
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 }
 
 TTF_Font *gfxFontGetCurFont(void)
 {
     TTF_Font *ret;
 
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
 
+    _swapReloadedFont(cur_default_font);
     cur_default_font->font.ref_count++;
     ret = cur_default_font->font.font;
 
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
+
+    return ret;
+}
+
+char *gfxFontGetFontName(const TTF_Font *font, ssize_t *size)
+{
+    struct gfx_font *iterator;
+    char *ret = NULL;
+
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
+
+    for (iterator = font_list.next; iterator; iterator = iterator->next)
+        if (iterator->font.font == font) {
+            ret = strdup(iterator->name);
+            *size = iterator->size;
+            break;
+        }
+
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 
     return ret;
 }
 
 ssize_t gfxFontGetCurFontSize(void)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     ssize_t ret = cur_default_font->size;
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
     return ret;
 }
 
 char *gfxFontGetCurFontName(void)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     char *ret = strdup(cur_default_font->name);
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
     return ret;
 }
 
 font_handle_t gfxFontGetCurFontHandle(void)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
+    _swapReloadedFont(cur_default_font);
     cur_default_font->font.ref_count++;
     font_handle_t ret = cur_default_font;
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
     return ret;
 }
 
@@ -258,53 +347,81 @@ static struct gfx_font *_appendFont(char *font_name, ssize_t size)
     return iterator->next;
 }
 
+TTF_Font *gfxFontGetFont(char *font_name, ssize_t size)
+{
+    struct gfx_font *iterator;
+    TTF_Font *ret = NULL;
+
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
+
+    for (iterator = font_list.next; iterator; iterator = iterator->next)
+        if (!iterator->font.pending_free && (ssize_t)iterator->size == size &&
+            !strcmp(iterator->name, font_name)) {
+            break;
+        }
+
+    if (iterator == NULL) {
+        iterator = _appendFont(font_name, size);
+    }
+
+    if (iterator) {
+        _swapReloadedFont(iterator);
+        iterator->font.ref_count++;
+        ret = iterator->font.font;
+    }
+
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
+
+    return ret;
+}
+
 int gfxFontLoadFont(char *font_name, ssize_t size)
 {
     int ret = 0;
 
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
 
     if (_appendFont(font_name, (size) ? size : DEFAULT_FONT_SIZE) ==
         NULL) {
         ret = -1;
     }
 
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 
     return ret;
 }
 
 int gfxFontSelectFontFromName(char *font_name)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     struct gfx_font *iterator = &font_list;
 
     for (; iterator; iterator = iterator->next)
         if (iterator->name)
             if (!strcmp(iterator->name, font_name)) {
                 cur_default_font = iterator;
-                pthread_mutex_unlock(&list_lock);
+                GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
                 return 0;
             }
 
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 
     return -1;
 }
 
 int gfxFontSelectFontFromHandle(font_handle_t font_handle)
 {
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
     struct gfx_font *iterator = &font_list;
 
     for (; iterator; iterator = iterator->next)
         if (iterator == font_handle) {
             cur_default_font = iterator;
-            pthread_mutex_unlock(&list_lock);
+            GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
             return 0;
         }
 
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 
     return -1;
 }
@@ -315,14 +432,15 @@ int gfxFontSetSize(ssize_t font_size)
         goto err_;
     }
 
-    pthread_mutex_lock(&list_lock);
+    GFX_MUTEX_LOCK(&list_lock, list_lock_stats);
 
     if (cur_default_font->size == font_size) {
-        pthread_mutex_unlock(&list_lock);
+        GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
         return 0;
     }
 
     if (!cur_default_font->font.ref_count) {
+        _swapReloadedFont(cur_default_font);
         TTF_CloseFont(cur_default_font->font.font);
         TTF_Font *new_font =
             TTF_OpenFont(cur_default_font->path, font_size);
@@ -343,10 +461,10 @@ int gfxFontSetSize(ssize_t font_size)
         }
     }
 
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
 
     return 0;
 err_:
-    pthread_mutex_unlock(&list_lock);
+    GFX_MUTEX_UNLOCK(&list_lock, list_lock_stats);
     return -1;
 }
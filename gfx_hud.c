@@ -0,0 +1,446 @@
+/**
+ * @file gfx_hud.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief On-screen performance HUD drawn from a glyph atlas as a single
+ * geometry batch
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <pthread.h>
+
+#include "gfx_draw_internal.h"
+#include "gfx_font.h"
+#include "gfx_FreeRTOS_utils.h"
+#include "gfx_hud.h"
+#include "gfx_print.h"
+#include "gfx_utils.h"
+
+#define HUD_FIRST_GLYPH ' '
+#define HUD_LAST_GLYPH '~'
+#define HUD_GLYPH_COUNT (HUD_LAST_GLYPH - HUD_FIRST_GLYPH + 1)
+#define HUD_ATLAS_WIDTH 512
+#define HUD_SOLID_SIZE 2 // White block in the atlas used for untextured quads
+#define HUD_MAX_QUADS 1024
+#define HUD_X 5
+#define HUD_Y 5
+#define HUD_PADDING 4
+#define HUD_GRAPH_LEN 120
+#define HUD_GRAPH_BAR_WIDTH 2
+#define HUD_GRAPH_HEIGHT 40
+#define HUD_GRAPH_MAX_MS 50.0
+#define HUD_WIDTH (HUD_GRAPH_LEN * HUD_GRAPH_BAR_WIDTH + 2 * HUD_PADDING)
+#define HUD_LINE_LEN 64
+#define HUD_TYPE_LINE_CHARS 36
+#define HUD_MAX_TASK_LINES 5
+#define HUD_TEXT_REFRESH_FRAMES 10
+#define HUD_BACKGROUND_ALPHA 0xC0
+
+#if (configFPS_LIMIT == 1)
+#define HUD_TARGET_FRAME_MS (FRAMELIMIT_PERIOD)
+#else
+#define HUD_TARGET_FRAME_MS (1000.0 / 60)
+#endif //configFPS_LIMIT
+
+struct hud {
+    unsigned char shown;
+
+    // Glyph atlas, the surface is kept to recreate the texture on rebind
+    SDL_Surface *atlas_surf;
+    SDL_Texture *atlas;
+    SDL_Rect glyphs[HUD_GLYPH_COUNT];
+    int line_height;
+
+    // Single geometry batch: background, cached text quads and then graph
+    SDL_Vertex verts[HUD_MAX_QUADS * 4];
+    int indices[HUD_MAX_QUADS * 6];
+    unsigned int quads;
+    unsigned int text_quads;
+    unsigned int refresh;
+    float graph_y;
+
+    float frame_ms[HUD_GRAPH_LEN];
+    unsigned int frame_idx;
+    struct timespec last_present;
+    float hud_ms;
+
+    unsigned int jobs[DRAW_JOB_TYPE_COUNT];
+    unsigned int jobs_total;
+
+    futil_profile_sample_t sample;
+};
+
+static struct hud hud = { 0 };
+
+static int _hudCreateAtlas(void)
+{
+    SDL_Color white = { MAX_8_BIT, MAX_8_BIT, MAX_8_BIT, ALPHA_SOLID };
+    SDL_Surface *glyphs[HUD_GLYPH_COUNT] = { 0 };
+    SDL_Rect solid = { 0, 0, HUD_SOLID_SIZE, HUD_SOLID_SIZE };
+    int x = HUD_SOLID_SIZE, y = 0;
+    unsigned int i, q;
+
+    if (hud.atlas_surf == NULL) {
+        TTF_Font *font = gfxFontGetCurFont();
+
+        GFX_MUTEX_LOCK(&ttf_lock, ttf_lock_stats);
+
+        hud.line_height = TTF_FontHeight(font);
+
+        for (i = 0; i < HUD_GLYPH_COUNT; i++) {
+            glyphs[i] = TTF_RenderGlyph_Blended(
+                            font, HUD_FIRST_GLYPH + i, white);
+            if (glyphs[i] == NULL) {
+                GFX_MUTEX_UNLOCK(&ttf_lock, ttf_lock_stats);
+                gfxFontPutFont(font);
+                PRINT_ERROR("Failed to render HUD glyph '%c'",
+                            HUD_FIRST_GLYPH + i);
+                goto err_glyphs;
+            }
+
+            if (x + glyphs[i]->w > HUD_ATLAS_WIDTH) {
+                x = 0;
+                y += hud.line_height;
+            }
+
+            hud.glyphs[i].x = x;
+            hud.glyphs[i].y = y;
+            hud.glyphs[i].w = glyphs[i]->w;
+            hud.glyphs[i].h = glyphs[i]->h;
+            x += glyphs[i]->w;
+        }
+
+        GFX_MUTEX_UNLOCK(&ttf_lock, ttf_lock_stats);
+        gfxFontPutFont(font);
+
+        hud.atlas_surf = SDL_CreateRGBSurfaceWithFormat(
+                             0, HUD_ATLAS_WIDTH, y + hud.line_height, 32,
+                             SDL_PIXELFORMAT_ARGB8888);
+        if (hud.atlas_surf == NULL) {
+            PRINT_SDL_ERROR("Failed to create HUD atlas surface");
+            goto err_glyphs;
+        }
+
+        SDL_FillRect(hud.atlas_surf, &solid, 0xFFFFFFFF);
+
+        for (i = 0; i < HUD_GLYPH_COUNT; i++) {
+            SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphs[i], NULL, hud.atlas_surf, &hud.glyphs[i]);
+            SDL_FreeSurface(glyphs[i]);
+        }
+
+        for (q = 0; q < HUD_MAX_QUADS; q++) {
+            hud.indices[q * 6 + 0] = q * 4 + 0;
+            hud.indices[q * 6 + 1] = q * 4 + 1;
+            hud.indices[q * 6 + 2] = q * 4 + 2;
+            hud.indices[q * 6 + 3] = q * 4 + 0;
+            hud.indices[q * 6 + 4] = q * 4 + 2;
+            hud.indices[q * 6 + 5] = q * 4 + 3;
+        }
+    }
+
+    hud.atlas = gfxDrawTrackTexture(
+                    SDL_CreateTextureFromSurface(renderer, hud.atlas_surf));
+    if (hud.atlas == NULL) {
+        PRINT_SDL_ERROR("Failed to create HUD atlas texture");
+        return -1;
+    }
+    SDL_SetTextureBlendMode(hud.atlas, SDL_BLENDMODE_BLEND);
+
+    return 0;
+
+err_glyphs:
+    for (i = 0; i < HUD_GLYPH_COUNT; i++)
+        if (glyphs[i]) {
+            SDL_FreeSurface(glyphs[i]);
+        }
+    return -1;
+}
+
+static void _hudSetQuad(unsigned int quad, float x, float y, float w, float h,
+                        const SDL_Rect *src, unsigned int colour,
+                        unsigned char alpha)
+{
+    SDL_Vertex *v = &hud.verts[quad * 4];
+    SDL_Color c = { RED_PORTION(colour), GREEN_PORTION(colour),
+                    BLUE_PORTION(colour), alpha
+                  };
+    float aw = hud.atlas_surf->w, ah = hud.atlas_surf->h;
+    float u0, v0, u1, v1;
+
+    if (src) {
+        u0 = src->x / aw;
+        v0 = src->y / ah;
+        u1 = (src->x + src->w) / aw;
+        v1 = (src->y + src->h) / ah;
+    }
+    else {
+        u0 = u1 = HUD_SOLID_SIZE / 2.0 / aw;
+        v0 = v1 = HUD_SOLID_SIZE / 2.0 / ah;
+    }
+
+    v[0] = (SDL_Vertex) { { x, y }, c, { u0, v0 } };
+    v[1] = (SDL_Vertex) { { x + w, y }, c, { u1, v0 } };
+    v[2] = (SDL_Vertex) { { x + w, y + h }, c, { u1, v1 } };
+    v[3] = (SDL_Vertex) { { x, y + h }, c, { u0, v1 } };
+}
+
+static void _hudPushQuad(float x, float y, float w, float h,
+                         const SDL_Rect *src, unsigned int colour)
+{
+    if (hud.quads < HUD_MAX_QUADS) {
+        _hudSetQuad(hud.quads++, x, y, w, h, src, colour, ALPHA_SOLID);
+    }
+}
+
+static void _hudPushText(float x, float y, const char *str,
+                         unsigned int colour)
+{
+    SDL_Rect *glyph;
+
+    for (; *str; str++) {
+        if (*str < HUD_FIRST_GLYPH || *str > HUD_LAST_GLYPH) {
+            glyph = &hud.glyphs['?' - HUD_FIRST_GLYPH];
+        }
+        else {
+            glyph = &hud.glyphs[*str - HUD_FIRST_GLYPH];
+        }
+
+        if (*str != ' ') {
+            _hudPushQuad(x, y, glyph->w, glyph->h, glyph, colour);
+        }
+        x += glyph->w;
+    }
+}
+
+static float _hudMemory(enum gfx_mem_category category)
+{
+    gfx_mem_stats_t stats;
+
+    gfxUtilMemStatsGet(&stats);
+
+    return (category == GFX_MEM_CATEGORY_COUNT ? stats.total :
+            stats.bytes[category]) / 1024.0;
+}
+
+static void _hudUpdateText(void)
+{
+    char line[HUD_LINE_LEN];
+    float y = HUD_Y + HUD_PADDING, total = 0;
+    unsigned int i, j, samples = 0, len = 0;
+    unsigned int order[FUTIL_PROFILER_MAX_TASKS];
+
+    // Quad 0 is the background, set once the height is known
+    hud.quads = 1;
+
+    for (i = 0; i < HUD_GRAPH_LEN; i++)
+        if (hud.frame_ms[i] > 0) {
+            total += hud.frame_ms[i];
+            samples++;
+        }
+
+    snprintf(line, HUD_LINE_LEN, "FPS %.1f  frame %.2f ms  hud %.3f ms",
+             total > 0 ? samples * MS_IN_SECOND / total : 0,
+             samples ? total / samples : 0, hud.hud_ms);
+    _hudPushText(HUD_X + HUD_PADDING, y, line, White);
+    y += hud.line_height;
+
+    snprintf(line, HUD_LINE_LEN, "queue %u jobs  tex %.1f KiB  mem %.1f KiB",
+             hud.jobs_total, _hudMemory(GFX_MEM_TEXTURES),
+             _hudMemory(GFX_MEM_CATEGORY_COUNT));
+    _hudPushText(HUD_X + HUD_PADDING, y, line, White);
+    y += hud.line_height;
+
+    for (i = 0; i < DRAW_JOB_TYPE_COUNT; i++) {
+        if (!hud.jobs[i]) {
+            continue;
+        }
+
+        if (len > HUD_TYPE_LINE_CHARS) {
+            _hudPushText(HUD_X + HUD_PADDING, y, line, Silver);
+            y += hud.line_height;
+            len = 0;
+        }
+
+        len += snprintf(line + len, HUD_LINE_LEN - len, "%s %u  ",
+                        draw_job_names[i], hud.jobs[i]);
+        if (len >= HUD_LINE_LEN) {
+            len = HUD_LINE_LEN - 1;
+        }
+    }
+    if (len) {
+        _hudPushText(HUD_X + HUD_PADDING, y, line, Silver);
+        y += hud.line_height;
+    }
+
+    if (!gfxFUtilProfilerGetLatest(&hud.sample)) {
+        // Partial selection sort of the busiest tasks
+        for (i = 0; i < hud.sample.task_count; i++) {
+            order[i] = i;
+        }
+
+        for (i = 0; i < hud.sample.task_count && i < HUD_MAX_TASK_LINES;
+             i++) {
+            for (j = i + 1; j < hud.sample.task_count; j++)
+                if (hud.sample.tasks[order[j]].cpu_share >
+                    hud.sample.tasks[order[i]].cpu_share) {
+                    unsigned int tmp = order[i];
+                    order[i] = order[j];
+                    order[j] = tmp;
+                }
+
+            snprintf(line, HUD_LINE_LEN, "%-16s %5.1f %%",
+                     hud.sample.tasks[order[i]].name,
+                     hud.sample.tasks[order[i]].cpu_share);
+            _hudPushText(HUD_X + HUD_PADDING, y, line, Yellow);
+            y += hud.line_height;
+        }
+    }
+    else {
+        _hudPushText(HUD_X + HUD_PADDING, y, "task profiler stopped", Gray);
+        y += hud.line_height;
+    }
+
+    hud.graph_y = y + HUD_PADDING;
+    hud.text_quads = hud.quads;
+
+    _hudSetQuad(0, HUD_X, HUD_Y, HUD_WIDTH,
+                hud.graph_y + HUD_GRAPH_HEIGHT + HUD_PADDING - HUD_Y, NULL,
+                Black, HUD_BACKGROUND_ALPHA);
+}
+
+static void _hudPushGraph(void)
+{
+    float x = HUD_X + HUD_PADDING, h, ms;
+    float bottom = hud.graph_y + HUD_GRAPH_HEIGHT;
+    unsigned int i;
+
+    // Target frame time marker
+    _hudPushQuad(x, bottom - HUD_TARGET_FRAME_MS / HUD_GRAPH_MAX_MS *
+                 HUD_GRAPH_HEIGHT,
+                 HUD_GRAPH_LEN * HUD_GRAPH_BAR_WIDTH, 1, NULL, Gray);
+
+    // Oldest to newest
+    for (i = 0; i < HUD_GRAPH_LEN; i++) {
+        ms = hud.frame_ms[(hud.frame_idx + i) % HUD_GRAPH_LEN];
+        h = (ms > HUD_GRAPH_MAX_MS ? 1 : ms / HUD_GRAPH_MAX_MS) *
+            HUD_GRAPH_HEIGHT;
+
+        if (h > 0) {
+            _hudPushQuad(x, bottom - h, HUD_GRAPH_BAR_WIDTH, h, NULL,
+                         ms <= HUD_TARGET_FRAME_MS ? Green :
+                         ms <= 2 * HUD_TARGET_FRAME_MS ? Yellow : Red);
+        }
+        x += HUD_GRAPH_BAR_WIDTH;
+    }
+}
+
+void gfxHUDRender(void)
+{
+    struct timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (hud.atlas == NULL) {
+        if (_hudCreateAtlas()) {
+            PRINT_ERROR("HUD disabled");
+            __atomic_store_n(&hud.shown, 0, __ATOMIC_RELAXED);
+            return;
+        }
+        hud.refresh = 0;
+    }
+
+    if (!hud.refresh--) {
+        _hudUpdateText();
+        hud.refresh = HUD_TEXT_REFRESH_FRAMES;
+    }
+
+    hud.quads = hud.text_quads;
+    _hudPushGraph();
+
+    SDL_RenderGeometry(renderer, hud.atlas, hud.verts, hud.quads * 4,
+                       hud.indices, hud.quads * 6);
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    hud.hud_ms = gfxDrawTimespecDiffMs(&start, &stop);
+}
+
+void gfxHUDRecordFrame(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (hud.last_present.tv_sec || hud.last_present.tv_nsec) {
+        hud.frame_ms[hud.frame_idx] =
+            gfxDrawTimespecDiffMs(&hud.last_present, &now);
+        hud.frame_idx = (hud.frame_idx + 1) % HUD_GRAPH_LEN;
+    }
+
+    hud.last_present = now;
+}
+
+void gfxHUDResetJobs(void)
+{
+    memset(hud.jobs, 0, sizeof(hud.jobs));
+    hud.jobs_total = 0;
+}
+
+void gfxHUDCountJob(unsigned int type)
+{
+    if (type < DRAW_JOB_TYPE_COUNT) {
+        hud.jobs[type]++;
+    }
+    hud.jobs_total++;
+}
+
+// The atlas texture was destroyed along with the renderer, it is recreated
+// on the next draw
+void gfxHUDForgetTexture(void)
+{
+    hud.atlas = NULL;
+}
+
+void gfxHUDFree(void)
+{
+    if (hud.atlas_surf) {
+        SDL_FreeSurface(hud.atlas_surf);
+        hud.atlas_surf = NULL;
+    }
+}
+
+void gfxDrawHUDShow(unsigned char show)
+{
+    __atomic_store_n(&hud.shown, show ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+void gfxDrawHUDToggle(void)
+{
+    __atomic_xor_fetch(&hud.shown, 1, __ATOMIC_RELAXED);
+}
+
+unsigned char gfxDrawHUDIsShown(void)
+{
+    return __atomic_load_n(&hud.shown, __ATOMIC_RELAXED);
+}
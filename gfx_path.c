@@ -0,0 +1,698 @@
+/**
+ * @file gfx_path.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Vector paths built from line, curve and arc segments, that are
+ * flattened into contours and tessellated into meshes for gfx_draw
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include <pthread.h>
+
+#include "gfx_draw_internal.h"
+#include "gfx_path.h"
+#include "gfx_print.h"
+#include "gfx_utils.h"
+
+typedef struct path_contour {
+    unsigned int start;
+    unsigned int n;
+    unsigned char closed;
+} path_contour_t;
+
+struct path {
+    SDL_FPoint *points; // Flattened contours, stored back to back
+    unsigned int n_points;
+    unsigned int points_size;
+    path_contour_t *contours;
+    unsigned int n_contours;
+    unsigned int contours_size;
+    unsigned char open; // Last contour can still be extended
+    SDL_FPoint pen;
+    unsigned int version; // Incremented each time the path changes
+
+    // Meshes are only touched by the GL thread
+    struct geometry_batch stroke;
+    unsigned int stroke_version;
+    unsigned char stroke_thickness;
+    struct geometry_batch fill;
+    unsigned int fill_version;
+    enum gfx_path_fill_rule fill_rule;
+    pthread_mutex_t lock;
+};
+
+GFX_LOCK_STATS(path_lock_stats, "path.lock");
+
+#define PATH_MAX_DEPTH 16 // Deepest subdivision when flattening a curve
+
+// Appends a point to the path's last contour
+static int _pathAppend(path_t *path, float x, float y)
+{
+    path_contour_t *contour = &path->contours[path->n_contours - 1];
+
+    if (contour->n && path->pen.x == x && path->pen.y == y) {
+        return 0;
+    }
+
+    if (path->n_points == path->points_size) {
+        unsigned int size = path->points_size ? path->points_size * 2 : 64;
+        SDL_FPoint *points = realloc(path->points, size * sizeof(SDL_FPoint));
+
+        if (points == NULL) {
+            PRINT_ERROR("Failed to grow path points");
+            return -1;
+        }
+        path->points = points;
+        path->points_size = size;
+    }
+
+    path->points[path->n_points++] = (SDL_FPoint) {
+        x, y
+    };
+    contour->n++;
+    path->pen = (SDL_FPoint) {
+        x, y
+    };
+
+    return 0;
+}
+
+static int _pathStartContour(path_t *path, float x, float y)
+{
+    // A contour holding a lone point draws nothing and can be replaced
+    if (path->open && path->contours[path->n_contours - 1].n < 2) {
+        path->n_points -= path->contours[path->n_contours - 1].n;
+        path->n_contours--;
+    }
+
+    if (path->n_contours == path->contours_size) {
+        unsigned int size =
+            path->contours_size ? path->contours_size * 2 : 8;
+        path_contour_t *contours =
+            realloc(path->contours, size * sizeof(path_contour_t));
+
+        if (contours == NULL) {
+            PRINT_ERROR("Failed to grow path contours");
+            return -1;
+        }
+        path->contours = contours;
+        path->contours_size = size;
+    }
+
+    path->contours[path->n_contours++] = (path_contour_t) {
+        path->n_points, 0, 0
+    };
+    path->open = 1;
+
+    return _pathAppend(path, x, y);
+}
+
+// Segments added after a contour is closed start a new one at the pen
+static int _pathContinue(path_t *path)
+{
+    if (path->open) {
+        return 0;
+    }
+
+    return _pathStartContour(path, path->pen.x, path->pen.y);
+}
+
+// Subdivides the curve until its control points lie within the tolerance of
+// its chord
+static int _pathCubic(path_t *path, float x0, float y0, float x1, float y1,
+                      float x2, float y2, float x3, float y3,
+                      unsigned int depth)
+{
+    float dx = x3 - x0, dy = y3 - y0;
+    float chord = dx * dx + dy * dy;
+    unsigned char flat;
+
+    if (chord > 1e-6) {
+        float d1 = fabsf((x1 - x3) * dy - (y1 - y3) * dx);
+        float d2 = fabsf((x2 - x3) * dy - (y2 - y3) * dx);
+
+        flat = (d1 + d2) * (d1 + d2) <=
+               TESS_TOLERANCE * TESS_TOLERANCE * chord;
+    }
+    else { // End points meet, the control points alone give the extent
+        float d1 = (x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0);
+        float d2 = (x2 - x0) * (x2 - x0) + (y2 - y0) * (y2 - y0);
+
+        flat = d1 <= TESS_TOLERANCE * TESS_TOLERANCE &&
+               d2 <= TESS_TOLERANCE * TESS_TOLERANCE;
+    }
+
+    if (flat || depth == PATH_MAX_DEPTH) {
+        return _pathAppend(path, x3, y3);
+    }
+
+    float x01 = (x0 + x1) / 2, y01 = (y0 + y1) / 2;
+    float x12 = (x1 + x2) / 2, y12 = (y1 + y2) / 2;
+    float x23 = (x2 + x3) / 2, y23 = (y2 + y3) / 2;
+    float x012 = (x01 + x12) / 2, y012 = (y01 + y12) / 2;
+    float x123 = (x12 + x23) / 2, y123 = (y12 + y23) / 2;
+    float xm = (x012 + x123) / 2, ym = (y012 + y123) / 2;
+
+    if (_pathCubic(path, x0, y0, x01, y01, x012, y012, xm, ym, depth + 1)) {
+        return -1;
+    }
+
+    return _pathCubic(path, xm, ym, x123, y123, x23, y23, x3, y3, depth + 1);
+}
+
+static int _pathArc(path_t *path, float cx, float cy, float radius,
+                    float start, float end)
+{
+    float from = start * TESS_PI / 180, sweep = (end - start) * TESS_PI / 180;
+    unsigned int i, segments = gfxDrawTessSegments(radius, fabsf(sweep));
+    float x = cx + radius * cosf(from), y = cy + radius * sinf(from);
+
+    // An open contour is joined to the start of the arc by a line
+    if (path->open ? _pathAppend(path, x, y) :
+        _pathStartContour(path, x, y)) {
+        return -1;
+    }
+
+    for (i = 1; i <= segments; i++) {
+        float a = from + sweep * i / segments;
+
+        if (_pathAppend(path, cx + radius * cosf(a), cy + radius * sinf(a))) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int _strokePath(path_t *path, unsigned char thickness)
+{
+    SDL_Color c = { 0xFF, 0xFF, 0xFF, ALPHA_SOLID }; // Set when drawn
+    unsigned int i, n;
+
+    path->stroke.n_verts = 0;
+    path->stroke.n_indices = 0;
+
+    for (i = 0; i < path->n_contours; i++) {
+        path_contour_t *contour = &path->contours[i];
+
+        n = gfxDrawUniquePoints(&path->points[contour->start], contour->n,
+                                contour->closed);
+        if (n > 1 && gfxDrawStrokePoints(&path->stroke,
+                                         &path->points[contour->start], n,
+                                         contour->closed, thickness, c)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+typedef struct path_crossing {
+    int x;
+    int winding; // Direction of the edge, 1 heading down, -1 heading up
+} path_crossing_t;
+
+static struct path_fill_buffer {
+    path_crossing_t *crossings;
+    unsigned int *rows; // Quads ending on the previous and current rows
+    unsigned int size;
+} path_fill_buf = { 0 };
+
+// Emits a span of a single pixel row, extending the quad directly above it
+// where that quad covers the very same columns
+static int _pathFillSpan(struct geometry_batch *mesh, int x0, int x1, int y,
+                         unsigned int *above, unsigned int n_above,
+                         unsigned int *next_above, unsigned int *row,
+                         unsigned int *n_row)
+{
+    SDL_Color c = { 0xFF, 0xFF, 0xFF, ALPHA_SOLID }; // Set when drawn
+
+    for (; *next_above < n_above; (*next_above)++) {
+        SDL_Vertex *quad = &mesh->verts[above[*next_above]];
+
+        if (quad[0].position.x > x0) {
+            break;
+        }
+
+        if (quad[0].position.x == x0 && quad[1].position.x == x1) {
+            quad[2].position.y = y + 1;
+            quad[3].position.y = y + 1;
+            row[(*n_row)++] = above[(*next_above)++];
+            return 0;
+        }
+    }
+
+    if (gfxDrawReserveMesh(mesh, 4, 6)) {
+        return -1;
+    }
+
+    unsigned int base = mesh->n_verts;
+    SDL_Vertex *v = &mesh->verts[base];
+    int *indices = &mesh->indices[mesh->n_indices];
+
+    v[0] = (SDL_Vertex) {
+        { x0, y }, c, { 0, 0 }
+    };
+    v[1] = (SDL_Vertex) {
+        { x1, y }, c, { 0, 0 }
+    };
+    v[2] = (SDL_Vertex) {
+        { x0, y + 1 }, c, { 0, 0 }
+    };
+    v[3] = (SDL_Vertex) {
+        { x1, y + 1 }, c, { 0, 0 }
+    };
+
+    indices[0] = base;
+    indices[1] = base + 1;
+    indices[2] = base + 2;
+    indices[3] = base + 1;
+    indices[4] = base + 3;
+    indices[5] = base + 2;
+
+    mesh->n_verts += 4;
+    mesh->n_indices += 6;
+    row[(*n_row)++] = base;
+
+    return 0;
+}
+
+// Scanline fill of all contours, sampling each row at its pixel centres
+static int _fillPath(path_t *path, enum gfx_path_fill_rule rule)
+{
+    struct geometry_batch *mesh = &path->fill;
+    unsigned int i, j, k, c, count, n_above = 0, n_row;
+    float min_y = INFINITY, max_y = -INFINITY;
+    int y;
+
+    mesh->n_verts = 0;
+    mesh->n_indices = 0;
+
+    if (path->n_points * 2 > path_fill_buf.size) {
+        unsigned int size = path->n_points * 2;
+        path_crossing_t *crossings =
+            realloc(path_fill_buf.crossings, size * sizeof(path_crossing_t));
+
+        if (crossings == NULL) {
+            goto err;
+        }
+        path_fill_buf.crossings = crossings;
+
+        unsigned int *rows =
+            realloc(path_fill_buf.rows, size * sizeof(unsigned int));
+
+        if (rows == NULL) {
+            goto err;
+        }
+        path_fill_buf.rows = rows;
+        path_fill_buf.size = size;
+    }
+
+    // Each row can hold at most one span per two crossings
+    unsigned int *above = path_fill_buf.rows;
+    unsigned int *row = path_fill_buf.rows + path->n_points;
+
+    for (i = 0; i < path->n_points; i++) {
+        if (path->points[i].y < min_y) {
+            min_y = path->points[i].y;
+        }
+        if (path->points[i].y > max_y) {
+            max_y = path->points[i].y;
+        }
+    }
+
+    for (y = floorf(min_y); y < ceilf(max_y); y++) {
+        path_crossing_t *crossings = path_fill_buf.crossings;
+        float scan_y = y + 0.5;
+        unsigned int next_above = 0;
+        int winding = 0, x0 = 0;
+
+        for (count = 0, c = 0; c < path->n_contours; c++) {
+            const SDL_FPoint *p = &path->points[path->contours[c].start];
+            unsigned int n = path->contours[c].n;
+
+            for (i = 0, j = n - 1; i < n; j = i++)
+                if ((p[j].y <= scan_y) != (p[i].y <= scan_y)) {
+                    float x = p[j].x + (scan_y - p[j].y) *
+                              (p[i].x - p[j].x) / (p[i].y - p[j].y);
+
+                    crossings[count++] = (path_crossing_t) {
+                        ceilf(x - 0.5), p[i].y > p[j].y ? 1 : -1
+                    };
+                }
+        }
+
+        for (i = 1; i < count; i++) {
+            path_crossing_t crossing = crossings[i];
+
+            for (k = i; k && crossings[k - 1].x > crossing.x; k--) {
+                crossings[k] = crossings[k - 1];
+            }
+            crossings[k] = crossing;
+        }
+
+        for (n_row = 0, i = 0; i < count; i++) {
+            unsigned char was_inside = rule == GFX_PATH_FILL_EVEN_ODD ?
+                                       winding & 1 : winding != 0;
+
+            winding += crossings[i].winding;
+
+            unsigned char inside = rule == GFX_PATH_FILL_EVEN_ODD ?
+                                   winding & 1 : winding != 0;
+
+            if (inside && !was_inside) {
+                x0 = crossings[i].x;
+            }
+            else if (!inside && was_inside && crossings[i].x > x0)
+                if (_pathFillSpan(mesh, x0, crossings[i].x, y, above,
+                                  n_above, &next_above, row, &n_row)) {
+                    return -1;
+                }
+        }
+
+        unsigned int *swap = above;
+
+        above = row;
+        row = swap;
+        n_above = n_row;
+    }
+
+    return 0;
+
+err:
+    PRINT_ERROR("Failed to grow path fill buffer");
+    return -1;
+}
+
+// Returns the mesh the path is drawn with, holding the path's lock
+struct geometry_batch *gfxPathLockMesh(path_data_t *data)
+{
+    path_t *path = data->path;
+
+    GFX_MUTEX_LOCK(&path->lock, path_lock_stats);
+
+    // Meshes are rebuilt only once the path or how it is drawn changes
+    if (data->fill) {
+        if (path->fill_version != path->version ||
+            path->fill_rule != data->rule) {
+            path->fill_version = 0;
+            if (_fillPath(path, data->rule)) {
+                goto err;
+            }
+            path->fill_version = path->version;
+            path->fill_rule = data->rule;
+        }
+        return &path->fill;
+    }
+
+    if (path->stroke_version != path->version ||
+        path->stroke_thickness != data->thickness) {
+        path->stroke_version = 0;
+        if (_strokePath(path, data->thickness)) {
+            goto err;
+        }
+        path->stroke_version = path->version;
+        path->stroke_thickness = data->thickness;
+    }
+    return &path->stroke;
+
+err:
+    GFX_MUTEX_UNLOCK(&path->lock, path_lock_stats);
+    return NULL;
+}
+
+void gfxPathUnlockMesh(path_t *path)
+{
+    GFX_MUTEX_UNLOCK(&path->lock, path_lock_stats);
+}
+
+int gfxPathGetBounds(path_t *path, SDL_FPoint *min, SDL_FPoint *max)
+{
+    unsigned int i;
+    int ret = -1;
+
+    *min = (SDL_FPoint) {
+        INFINITY, INFINITY
+    };
+    *max = (SDL_FPoint) {
+        -INFINITY, -INFINITY
+    };
+
+    GFX_MUTEX_LOCK(&path->lock, path_lock_stats);
+    for (i = 0; i < path->n_points; i++) {
+        min->x = fminf(min->x, path->points[i].x);
+        min->y = fminf(min->y, path->points[i].y);
+        max->x = fmaxf(max->x, path->points[i].x);
+        max->y = fmaxf(max->y, path->points[i].y);
+    }
+    if (path->n_points) {
+        ret = 0;
+    }
+    GFX_MUTEX_UNLOCK(&path->lock, path_lock_stats);
+
+    return ret;
+}
+
+void gfxPathFree(path_t *path)
+{
+    pthread_mutex_destroy(&path->lock);
+    free(path->stroke.verts);
+    free(path->stroke.indices);
+    free(path->fill.verts);
+    free(path->fill.indices);
+    free(path->contours);
+    free(path->points);
+    free(path);
+}
+
+gfx_path_handle_t gfxDrawPathCreate(void)
+{
+    path_t *ret = calloc(1, sizeof(path_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Could not allocate path");
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&ret->lock, NULL)) {
+        PRINT_ERROR("Could not create path lock");
+        free(ret);
+        return NULL;
+    }
+
+    ret->version = 1;
+
+    return (gfx_path_handle_t)ret;
+}
+
+int gfxDrawPathDelete(gfx_path_handle_t path)
+{
+    if (path == NULL) {
+        PRINT_ERROR("Path handle is not valid");
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_PATH);
+
+    job->data->path.path = (path_t *)path;
+    job->data->path.release = 1;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
+
+static path_t *_lockPath(gfx_path_handle_t path)
+{
+    if (path == NULL) {
+        PRINT_ERROR("Path handle is not valid");
+        return NULL;
+    }
+
+    GFX_MUTEX_LOCK(&((path_t *)path)->lock, path_lock_stats);
+
+    return (path_t *)path;
+}
+
+// Any change to the path invalidates its cached meshes
+static int _unlockPath(path_t *path, int ret)
+{
+    path->version++;
+    GFX_MUTEX_UNLOCK(&path->lock, path_lock_stats);
+
+    return ret;
+}
+
+int gfxDrawPathClear(gfx_path_handle_t path)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    p->n_points = 0;
+    p->n_contours = 0;
+    p->open = 0;
+    p->pen = (SDL_FPoint) {
+        0, 0
+    };
+
+    return _unlockPath(p, 0);
+}
+
+int gfxDrawPathMoveTo(gfx_path_handle_t path, float x, float y)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    return _unlockPath(p, _pathStartContour(p, x, y));
+}
+
+int gfxDrawPathLineTo(gfx_path_handle_t path, float x, float y)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    if (_pathContinue(p)) {
+        return _unlockPath(p, -1);
+    }
+
+    return _unlockPath(p, _pathAppend(p, x, y));
+}
+
+int gfxDrawPathQuadTo(gfx_path_handle_t path, float cx, float cy, float x,
+                      float y)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    if (_pathContinue(p)) {
+        return _unlockPath(p, -1);
+    }
+
+    // Raised to the cubic tracing the very same curve
+    float x0 = p->pen.x, y0 = p->pen.y;
+
+    return _unlockPath(p, _pathCubic(p, x0, y0, x0 + (cx - x0) * 2 / 3,
+                                     y0 + (cy - y0) * 2 / 3,
+                                     x + (cx - x) * 2 / 3,
+                                     y + (cy - y) * 2 / 3, x, y, 0));
+}
+
+int gfxDrawPathCubicTo(gfx_path_handle_t path, float c1x, float c1y,
+                       float c2x, float c2y, float x, float y)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    if (_pathContinue(p)) {
+        return _unlockPath(p, -1);
+    }
+
+    return _unlockPath(p, _pathCubic(p, p->pen.x, p->pen.y, c1x, c1y, c2x,
+                                     c2y, x, y, 0));
+}
+
+int gfxDrawPathArc(gfx_path_handle_t path, float cx, float cy, float radius,
+                   float start, float end)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    if (radius <= 0) {
+        PRINT_ERROR("Path arc requires a positive radius");
+        return _unlockPath(p, -1);
+    }
+
+    return _unlockPath(p, _pathArc(p, cx, cy, radius, start, end));
+}
+
+int gfxDrawPathClose(gfx_path_handle_t path)
+{
+    path_t *p = _lockPath(path);
+
+    if (p == NULL) {
+        return -1;
+    }
+
+    if (p->open) {
+        path_contour_t *contour = &p->contours[p->n_contours - 1];
+
+        contour->closed = 1;
+        p->pen = p->points[contour->start];
+        p->open = 0;
+    }
+
+    return _unlockPath(p, 0);
+}
+
+static int _pushPathJob(gfx_path_handle_t path, int x, int y,
+                        unsigned char fill, unsigned char thickness,
+                        enum gfx_path_fill_rule rule, unsigned int colour)
+{
+    if (path == NULL) {
+        PRINT_ERROR("Path handle is not valid");
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_PATH);
+
+    job->data->path.path = (path_t *)path;
+    job->data->path.x = x;
+    job->data->path.y = y;
+    job->data->path.fill = fill;
+    job->data->path.thickness = thickness;
+    job->data->path.rule = rule;
+    job->data->path.colour = colour;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
+
+int gfxDrawPathStroke(gfx_path_handle_t path, int x, int y,
+                      unsigned char thickness, unsigned int colour)
+{
+    return _pushPathJob(path, x, y, 0, thickness, GFX_PATH_FILL_NON_ZERO,
+                        colour);
+}
+
+int gfxDrawPathFill(gfx_path_handle_t path, int x, int y,
+                    enum gfx_path_fill_rule rule, unsigned int colour)
+{
+    return _pushPathJob(path, x, y, 1, 0, rule, colour);
+}
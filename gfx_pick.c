@@ -0,0 +1,204 @@
+/**
+ * @file gfx_pick.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Grid index of the bounding boxes of tagged draw jobs, used to find
+ * which job is topmost at a pixel of the presented frame
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include <pthread.h>
+
+#include "gfx_draw_internal.h"
+#include "gfx_pick.h"
+#include "gfx_print.h"
+#include "gfx_utils.h"
+
+// ID that jobs queued by the calling thread are tagged with
+static __thread unsigned int pick_id = GFX_PICK_NONE;
+
+#define PICK_COLS ((SCREEN_WIDTH + GFX_PICK_CELL_SIZE - 1) / GFX_PICK_CELL_SIZE)
+#define PICK_ROWS \
+    ((SCREEN_HEIGHT + GFX_PICK_CELL_SIZE - 1) / GFX_PICK_CELL_SIZE)
+#define PICK_CELLS (PICK_COLS * PICK_ROWS)
+
+typedef struct pick_entry {
+    SDL_Rect box; // Clipped to the screen
+    unsigned int id;
+} pick_entry_t;
+
+typedef struct pick_index {
+    pick_entry_t *entries; // In the order they were drawn
+    unsigned int n_entries;
+    unsigned int entries_size;
+    unsigned int *refs; // Entries overlapping each cell, cell after cell
+    unsigned int refs_size;
+    unsigned int cells[PICK_CELLS + 1]; // Offset of each cell's refs
+} pick_index_t;
+
+static struct pick {
+    pick_index_t frames[2];
+    pick_index_t *building; // Tagged jobs of the frame being drawn
+    pick_index_t *presented; // Tagged jobs of the last presented frame
+    pthread_mutex_t lock; // Guards presented
+} pick = { .building = &pick.frames[0], .presented = &pick.frames[1],
+           .lock = PTHREAD_MUTEX_INITIALIZER
+         };
+GFX_LOCK_STATS(pick_lock_stats, "pick.lock");
+
+// Adds a tagged job's bounding box, clipped to the screen, to the frame
+// being drawn
+void gfxPickAdd(const SDL_Rect *bounds, unsigned int id)
+{
+    pick_index_t *index = pick.building;
+    SDL_Rect box, screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+    if (!SDL_IntersectRect(bounds, &screen, &box)) {
+        return;
+    }
+
+    if (index->n_entries == index->entries_size) {
+        unsigned int size = index->entries_size ? index->entries_size * 2 : 64;
+        pick_entry_t *entries =
+            realloc(index->entries, size * sizeof(pick_entry_t));
+
+        if (entries == NULL) {
+            PRINT_ERROR("Failed to grow pick index");
+            return;
+        }
+        index->entries = entries;
+        index->entries_size = size;
+    }
+
+    index->entries[index->n_entries++] = (pick_entry_t) {
+        box, id
+    };
+}
+
+// Sorts the frame's tagged boxes into the grid cells they overlap
+static int _pickBuildIndex(pick_index_t *index)
+{
+    unsigned int fill[PICK_CELLS];
+    unsigned int i;
+    int col, row; // Boxes are clipped to the screen, so never negative
+
+    memset(index->cells, 0, sizeof(index->cells));
+
+    for (i = 0; i < index->n_entries; i++) {
+        SDL_Rect *box = &index->entries[i].box;
+
+        for (row = box->y / GFX_PICK_CELL_SIZE;
+             row <= (box->y + box->h - 1) / GFX_PICK_CELL_SIZE; row++)
+            for (col = box->x / GFX_PICK_CELL_SIZE;
+                 col <= (box->x + box->w - 1) / GFX_PICK_CELL_SIZE; col++) {
+                index->cells[row * PICK_COLS + col + 1]++;
+            }
+    }
+
+    for (i = 0; i < PICK_CELLS; i++) {
+        index->cells[i + 1] += index->cells[i];
+    }
+
+    if (index->cells[PICK_CELLS] > index->refs_size) {
+        unsigned int *refs = realloc(index->refs, index->cells[PICK_CELLS] *
+                                     2 * sizeof(unsigned int));
+
+        if (refs == NULL) {
+            PRINT_ERROR("Failed to grow pick index");
+            index->n_entries = 0;
+            memset(index->cells, 0, sizeof(index->cells));
+            return -1;
+        }
+        index->refs = refs;
+        index->refs_size = index->cells[PICK_CELLS] * 2;
+    }
+
+    memcpy(fill, index->cells, sizeof(fill));
+
+    for (i = 0; i < index->n_entries; i++) {
+        SDL_Rect *box = &index->entries[i].box;
+
+        for (row = box->y / GFX_PICK_CELL_SIZE;
+             row <= (box->y + box->h - 1) / GFX_PICK_CELL_SIZE; row++)
+            for (col = box->x / GFX_PICK_CELL_SIZE;
+                 col <= (box->x + box->w - 1) / GFX_PICK_CELL_SIZE; col++) {
+                index->refs[fill[row * PICK_COLS + col]++] = i;
+            }
+    }
+
+    return 0;
+}
+
+// Makes the index of the frame just presented the one used for picking
+void gfxPickPresentFrame(void)
+{
+    pick_index_t *built = pick.building;
+
+    _pickBuildIndex(built);
+
+    GFX_MUTEX_LOCK(&pick.lock, pick_lock_stats);
+    pick.building = pick.presented;
+    pick.presented = built;
+    GFX_MUTEX_UNLOCK(&pick.lock, pick_lock_stats);
+
+    pick.building->n_entries = 0;
+}
+
+void gfxDrawSetPickID(unsigned int id)
+{
+    pick_id = id;
+}
+
+unsigned int gfxDrawGetPickID(void)
+{
+    return pick_id;
+}
+
+unsigned int gfxDrawPickPresented(signed short x, signed short y)
+{
+    unsigned int i, ret = GFX_PICK_NONE;
+
+    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
+        return GFX_PICK_NONE;
+    }
+
+    GFX_MUTEX_LOCK(&pick.lock, pick_lock_stats);
+
+    pick_index_t *index = pick.presented;
+    unsigned int cell = (y / GFX_PICK_CELL_SIZE) * PICK_COLS +
+                        x / GFX_PICK_CELL_SIZE;
+    SDL_Point point = { x, y };
+
+    // Later jobs are drawn over earlier ones
+    for (i = index->cells[cell + 1]; i > index->cells[cell]; i--) {
+        pick_entry_t *entry = &index->entries[index->refs[i - 1]];
+
+        if (SDL_PointInRect(&point, &entry->box)) {
+            ret = entry->id;
+            break;
+        }
+    }
+
+    GFX_MUTEX_UNLOCK(&pick.lock, pick_lock_stats);
+
+    return ret;
+}
@@ -22,24 +22,46 @@
  @endverbatim
  */
 
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
 #include <stdarg.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "FreeRTOS.h"
-#include "queue.h"
 #include "task.h"
 #include "semphr.h"
 
 #include "gfx_print.h"
 #include "gfx_utils.h"
 
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#endif // _STDC_NO_ATOMICS__
+
 struct error_print_msg {
 #ifdef SAFE_PRINT_DEBUG
     UBaseType_t debug_id;
 #endif // SAFE_PRINT_DEBUG
     FILE *__restrict stream; // Either stdout, stderr or user defined file
+    size_t len;
     char msg[SAFE_PRINT_MAX_MSG_LEN];
 };
 
+struct safe_print_stats {
+    _Atomic unsigned long printed;
+    _Atomic unsigned long dropped;
+    _Atomic unsigned long truncated;
+    _Atomic unsigned long writes;
+    _Atomic unsigned long suppressed;
+};
+
+_Static_assert(!(SAFE_PRINT_INPUT_BUFFER_COUNT &
+                 (SAFE_PRINT_INPUT_BUFFER_COUNT - 1)),
+               "SAFE_PRINT_INPUT_BUFFER_COUNT must be a power of two");
+
 char rbuf_buffer[sizeof(struct error_print_msg) *
                  SAFE_PRINT_INPUT_BUFFER_COUNT] = { 0 };
 
@@ -49,27 +71,36 @@ xSemaphoreHandle input_debug_count = NULL;
 
 rbuf_handle_t input_rbuf = NULL;
 
-xQueueHandle safePrintQueue = NULL;
 xTaskHandle safePrintTaskHandle = NULL;
 
+static struct safe_print_stats print_stats = { 0 };
+
+int safe_print_level = SAFE_PRINT_DEFAULT_LEVEL;
+
 static void _vfprints(FILE *__restrict __stream, const char *__format,
                       va_list args)
 {
     struct error_print_msg *tmp_msg;
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    int len;
 
     if ((__stream == NULL) || (__format == NULL)) {
         return;
     }
 
-    // Queue is not ready, lets risk it and just print
-    if (safePrintQueue == NULL) {
+    // Print task is not ready, lets risk it and just print
+    if (safePrintTaskHandle == NULL) {
         vfprintf(__stream, __format, args);
         return;
     }
 
     tmp_msg = (struct error_print_msg *)gfxRbufGetBuffer(input_rbuf);
 
+    if (tmp_msg == NULL) {
+        atomic_fetch_add(&print_stats.dropped, 1);
+        return;
+    }
+
 #ifdef SAFE_PRINT_DEBUG
     if (xSemaphoreGive(input_debug_count) == pdTRUE) {
         tmp_msg->debug_id = uxSemaphoreGetCount(input_debug_count);
@@ -79,16 +110,24 @@ static void _vfprints(FILE *__restrict __stream, const char *__format,
     }
 #endif // SAFE_PRINT_DEBUG
 
-    if (tmp_msg == NULL) {
-        return;
+    tmp_msg->stream = __stream;
+    len = vsnprintf((char *)tmp_msg->msg, SAFE_PRINT_MAX_MSG_LEN, __format,
+                    args);
+
+    if (len < 0) {
+        len = 0;
+    }
+    else if (len >= SAFE_PRINT_MAX_MSG_LEN) {
+        len = SAFE_PRINT_MAX_MSG_LEN - 1;
+        atomic_fetch_add(&print_stats.truncated, 1);
     }
 
-    tmp_msg->stream = __stream;
-    vsnprintf((char *)tmp_msg->msg, SAFE_PRINT_MAX_MSG_LEN, __format, args);
+    tmp_msg->len = len;
 
-    xQueueSendFromISR(safePrintQueue, tmp_msg, &xHigherPriorityTaskWoken);
+    // Message is consumed in place by the print task once published
+    gfxRbufPutBuffer(input_rbuf, tmp_msg);
 
-    gfxRbufPutBuffer(input_rbuf);
+    vTaskNotifyGiveFromISR(safePrintTaskHandle, &xHigherPriorityTaskWoken);
 
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
@@ -109,36 +148,236 @@ void prints(const char *__format, ...)
     va_end(args);
 }
 
-static void safePrintTask(void *pvParameters)
+// Returns how many of the iovecs were written completely
+static int _writevAll(int fd, struct iovec *iov, int iovcnt)
 {
-    struct error_print_msg msgToPrint = { 0 };
+    ssize_t written;
+    int ret = 0;
 
-    while (1) {
-        if (safePrintQueue)
-            if (xQueueReceive(safePrintQueue, &msgToPrint,
-                              portMAX_DELAY) == pdTRUE) {
-                fprintf(msgToPrint.stream, "%s",
-                        msgToPrint.msg);
+    while (iovcnt) {
+        written = writev(fd, iov, iovcnt > IOV_MAX ? IOV_MAX : iovcnt);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            return ret;
+        }
+
+        atomic_fetch_add(&print_stats.writes, 1);
+
+        // Skip what was written, a partial write can end mid iovec
+        while (iovcnt && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+            ret++;
+        }
+
+        if (iovcnt) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
     }
+
+    return ret;
 }
 
-int gfxSafePrintInit(void)
+// Streams without a file descriptor, such as memory streams, go through stdio
+static int _fwriteAll(FILE *stream, struct iovec *iov, int iovcnt)
 {
-    safePrintQueue =
-        xQueueCreate(SAFE_PRINT_QUEUE_LEN, SAFE_PRINT_MAX_MSG_LEN);
+    int ret = 0;
+    int i;
 
-    if (safePrintQueue == NULL) {
-        return -1;
+    for (i = 0; i < iovcnt; i++)
+        if (fwrite(iov[i].iov_base, 1, iov[i].iov_len, stream) ==
+            iov[i].iov_len) {
+            ret++;
+        }
+
+    if (fflush(stream) == 0) {
+        atomic_fetch_add(&print_stats.writes, 1);
+    }
+    else {
+        ret = 0;
     }
 
-    xTaskCreate(safePrintTask, "Print", SAFE_PRINT_STACK_SIZE, NULL,
-                SAFE_PRINT_PRIORITY, &safePrintTaskHandle);
+    return ret;
+}
 
-    if (safePrintTaskHandle == NULL) {
-        return -1;
+/**
+ * @brief Writes all messages that are ready, in place from the input ring
+ * buffer, with one write per output stream
+ */
+static void _flushPendingMessages(void)
+{
+    struct error_print_msg *msgs[SAFE_PRINT_INPUT_BUFFER_COUNT];
+    struct iovec iov[SAFE_PRINT_INPUT_BUFFER_COUNT];
+    rbuf_span_t spans[2];
+    size_t count, written, printed = 0, i, j;
+    int iovcnt, done, fd;
+    FILE *stream;
+
+    // Messages are written in order, peeking stops at the first message
+    // that is still being formatted
+    count = gfxRbufPeek(input_rbuf, SAFE_PRINT_INPUT_BUFFER_COUNT, spans);
+    if (!count) {
+        return;
+    }
+
+    for (i = 0, j = 0; j < spans[0].count; j++) {
+        msgs[i++] = (struct error_print_msg *)spans[0].data + j;
+    }
+    for (j = 0; j < spans[1].count; j++) {
+        msgs[i++] = (struct error_print_msg *)spans[1].data + j;
+    }
+
+    // Each pass gathers all the messages of the first unwritten stream
+    for (written = 0; written < count;) {
+        stream = NULL;
+        iovcnt = 0;
+
+        for (i = 0; i < count; i++) {
+            if (msgs[i]->stream == NULL) {
+                continue;
+            }
+            if (stream == NULL) {
+                stream = msgs[i]->stream;
+            }
+            if (msgs[i]->stream != stream) {
+                continue;
+            }
+
+            iov[iovcnt].iov_base = msgs[i]->msg;
+            iov[iovcnt].iov_len = msgs[i]->len;
+            iovcnt++;
+
+            msgs[i]->stream = NULL;
+        }
+
+        fd = fileno(stream);
+        if (fd < 0) {
+            done = _fwriteAll(stream, iov, iovcnt);
+        }
+        else {
+            // Anything buffered by stdio on this stream must go out first
+            fflush(stream);
+            done = _writevAll(fd, iov, iovcnt);
+        }
+
+        // Messages cut short by a failed write are lost
+        if (done < iovcnt) {
+            atomic_fetch_add(&print_stats.dropped, iovcnt - done);
+        }
+
+        printed += done;
+        written += iovcnt;
+    }
+
+    atomic_fetch_add(&print_stats.printed, printed);
+
+    gfxRbufRelease(input_rbuf, count);
+}
+
+static void safePrintTask(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        _flushPendingMessages();
+    }
+}
+
+void gfxSafePrintSetLevel(int level)
+{
+    __atomic_store_n(&safe_print_level, level, __ATOMIC_RELAXED);
+}
+
+int gfxSafePrintGetLevel(void)
+{
+    return __atomic_load_n(&safe_print_level, __ATOMIC_RELAXED);
+}
+
+#define TOKEN_SCALE 1000
+
+static unsigned long _getMonotonicMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000UL + now.tv_nsec / 1000000UL;
+}
+
+long gfxSafePrintSiteAllow(safe_print_site_t *site)
+{
+    unsigned long now, refill;
+    long ret = -1;
+
+    if (!SAFE_PRINT_RATE_PER_SEC) {
+        return 0;
+    }
+
+    now = _getMonotonicMs();
+
+    while (__atomic_test_and_set(&site->lock, __ATOMIC_ACQUIRE))
+        ;
+
+    if (!site->initialized) {
+        site->tokens = SAFE_PRINT_RATE_BURST * TOKEN_SCALE;
+        site->last_refill_ms = now;
+        site->initialized = 1;
+    }
+
+    // SAFE_PRINT_RATE_PER_SEC tokens per second is that many thousandths/ms
+    refill = (now - site->last_refill_ms) * SAFE_PRINT_RATE_PER_SEC;
+    site->last_refill_ms = now;
+    site->tokens += refill;
+    if (site->tokens > SAFE_PRINT_RATE_BURST * TOKEN_SCALE) {
+        site->tokens = SAFE_PRINT_RATE_BURST * TOKEN_SCALE;
+    }
+
+    if (site->tokens >= TOKEN_SCALE) {
+        site->tokens -= TOKEN_SCALE;
+        ret = site->suppressed;
+        site->suppressed = 0;
     }
+    else {
+        site->suppressed++;
+    }
+
+    __atomic_clear(&site->lock, __ATOMIC_RELEASE);
+
+    if (ret < 0) {
+        atomic_fetch_add(&print_stats.suppressed, 1);
+    }
+
+    return ret;
+}
+
+void gfxSafePrintGetStats(gfx_print_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->printed = atomic_load(&print_stats.printed);
+    stats->dropped = atomic_load(&print_stats.dropped);
+    stats->truncated = atomic_load(&print_stats.truncated);
+    stats->writes = atomic_load(&print_stats.writes);
+    stats->suppressed = atomic_load(&print_stats.suppressed);
+}
 
+void gfxSafePrintResetStats(void)
+{
+    atomic_store(&print_stats.printed, 0);
+    atomic_store(&print_stats.dropped, 0);
+    atomic_store(&print_stats.truncated, 0);
+    atomic_store(&print_stats.writes, 0);
+    atomic_store(&print_stats.suppressed, 0);
+}
+
+int gfxSafePrintInit(void)
+{
     input_rbuf = gfxRbufInitStatic(sizeof(struct error_print_msg),
                                    SAFE_PRINT_INPUT_BUFFER_COUNT, (void *)rbuf_buffer);
 
@@ -154,12 +393,23 @@ int gfxSafePrintInit(void)
     }
 #endif // SAFE_PRINT_DEBUG
 
+    xTaskCreate(safePrintTask, "Print", SAFE_PRINT_STACK_SIZE, NULL,
+                SAFE_PRINT_PRIORITY, &safePrintTaskHandle);
+
+    if (safePrintTaskHandle == NULL) {
+        return -1;
+    }
+
     return 0;
 }
 
 void gfxSafePrintExit(void)
 {
-    vTaskDelete(safePrintTaskHandle);
+    xTaskHandle print_task = safePrintTaskHandle;
+
+    safePrintTaskHandle = NULL;
+    vTaskDelete(print_task);
 
-    vQueueDelete(safePrintQueue);
+    // Write out whatever was still pending when the task was stopped
+    _flushPendingMessages();
 }
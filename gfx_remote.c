@@ -0,0 +1,923 @@
+/**
+ * @file gfx_remote.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Shared memory frame channel between the emulator and a viewer
+ * process, and the viewer's replay of the frames it receives
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <SDL2/SDL.h>
+
+#include "gfx_draw_internal.h"
+#include "gfx_font.h"
+#include "gfx_remote.h"
+#include "gfx_print.h"
+
+#define CAST_REMOTE(remote) ((struct remote *)remote)
+
+#define REMOTE_MAGIC 0x47465852 // "GFXR"
+#define REMOTE_VERSION 1
+#define REMOTE_CACHE_LINE_SIZE 64
+#define REMOTE_ALIGN 8
+#define REMOTE_ALIGNED(SIZE) (((SIZE) + REMOTE_ALIGN - 1) & ~(REMOTE_ALIGN - 1))
+
+// Marks the unused end of the ring, the frame is found at its beginning
+#define REMOTE_PAD UINT32_MAX
+
+// Frames are stored contiguously, each behind a header. head and tail are
+// free running byte counters, head is only written by the emulator and tail
+// only by the viewer, on separate cache lines.
+struct remote_ring {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size; // Bytes of data, a power of two
+    uint64_t head __attribute__((aligned(REMOTE_CACHE_LINE_SIZE)));
+    uint64_t tail __attribute__((aligned(REMOTE_CACHE_LINE_SIZE)));
+    unsigned char data[] __attribute__((aligned(REMOTE_CACHE_LINE_SIZE)));
+};
+
+struct remote_frame_header {
+    uint32_t size;
+    uint32_t reserved;
+};
+
+struct remote {
+    int listen_fd; // Emulator only
+    int fd; // Connection to the other end, -1 while there is none
+    struct remote_ring *ring;
+    size_t map_size;
+    size_t ring_size; // Data bytes of the rings the emulator creates, or of
+                      // the ring the viewer mapped
+    uint64_t frame_end; // Viewer only, tail once the frame is released
+    char *socket_path; // Emulator only, removed when closed
+};
+
+static size_t _roundUpPow2(size_t val)
+{
+    size_t ret = REMOTE_CACHE_LINE_SIZE;
+
+    while (ret < val) {
+        ret <<= 1;
+    }
+
+    return ret;
+}
+
+static int _socketAddress(const char *socket_path, struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(addr->sun_path)) {
+        PRINT_ERROR("Socket path '%s' is too long", socket_path);
+        return -1;
+    }
+
+    strcpy(addr->sun_path, socket_path);
+
+    return 0;
+}
+
+static void _disconnect(struct remote *remote)
+{
+    if (remote->ring) {
+        munmap(remote->ring, remote->map_size);
+        remote->ring = NULL;
+    }
+
+    if (remote->fd >= 0) {
+        close(remote->fd);
+        remote->fd = -1;
+    }
+}
+
+gfx_remote_handle_t gfxRemoteListen(const char *socket_path, size_t ring_size)
+{
+    struct sockaddr_un addr;
+    struct remote *ret;
+
+    if (_socketAddress(socket_path, &addr)) {
+        goto err_address;
+    }
+
+    ret = calloc(1, sizeof(struct remote));
+    if (ret == NULL) {
+        PRINT_ERROR("Failed to allocate remote");
+        goto err_alloc;
+    }
+
+    ret->fd = -1;
+    ret->ring_size = _roundUpPow2(ring_size);
+    ret->map_size = sizeof(struct remote_ring) + ret->ring_size;
+
+    ret->socket_path = strdup(socket_path);
+    if (ret->socket_path == NULL) {
+        PRINT_ERROR("Failed to allocate socket path");
+        goto err_path;
+    }
+
+    ret->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK |
+                            SOCK_CLOEXEC, 0);
+    if (ret->listen_fd < 0) {
+        PRINT_ERROR("Failed to create socket");
+        goto err_socket;
+    }
+
+    unlink(socket_path);
+
+    if (bind(ret->listen_fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        PRINT_ERROR("Failed to bind socket '%s'", socket_path);
+        goto err_bind;
+    }
+
+    if (listen(ret->listen_fd, 1)) {
+        PRINT_ERROR("Failed to listen on socket '%s'", socket_path);
+        goto err_listen;
+    }
+
+    return (gfx_remote_handle_t)ret;
+
+err_listen:
+    unlink(socket_path);
+err_bind:
+    close(ret->listen_fd);
+err_socket:
+    free(ret->socket_path);
+err_path:
+    free(ret);
+err_alloc:
+err_address:
+    return NULL;
+}
+
+// Creates a ring in shared memory and passes its file descriptor to the
+// viewer that just connected
+static int _shareRing(struct remote *remote)
+{
+    char byte = 0;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control = { 0 };
+    struct msghdr msg = { .msg_iov = &iov,
+               .msg_iovlen = 1,
+               .msg_control = control.buf,
+               .msg_controllen = sizeof(control.buf)
+    };
+    struct cmsghdr *cmsg;
+    int fd;
+
+    fd = memfd_create("gfx_remote", MFD_CLOEXEC);
+    if (fd < 0) {
+        PRINT_ERROR("Failed to create shared memory");
+        goto err_memfd;
+    }
+
+    if (ftruncate(fd, remote->map_size)) {
+        PRINT_ERROR("Failed to size shared memory");
+        goto err_truncate;
+    }
+
+    remote->ring = mmap(NULL, remote->map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    if (remote->ring == MAP_FAILED) {
+        remote->ring = NULL;
+        PRINT_ERROR("Failed to map shared memory");
+        goto err_truncate;
+    }
+
+    remote->ring->magic = REMOTE_MAGIC;
+    remote->ring->version = REMOTE_VERSION;
+    remote->ring->size = remote->ring_size;
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    if (sendmsg(remote->fd, &msg, MSG_NOSIGNAL) != 1) {
+        PRINT_ERROR("Failed to pass shared memory to viewer");
+        goto err_send;
+    }
+
+    // The mapping keeps the memory alive
+    close(fd);
+
+    return 0;
+
+err_send:
+    munmap(remote->ring, remote->map_size);
+    remote->ring = NULL;
+err_truncate:
+    close(fd);
+err_memfd:
+    return -1;
+}
+
+int gfxRemoteAccept(gfx_remote_handle_t remote)
+{
+    struct remote *r = CAST_REMOTE(remote);
+    struct pollfd pfd;
+
+    if (r->fd >= 0) {
+        pfd = (struct pollfd) {
+            .fd = r->fd, .events = 0
+        };
+        if (poll(&pfd, 1, 0) <= 0 ||
+            !(pfd.revents & (POLLHUP | POLLERR))) {
+            return 0;
+        }
+        _disconnect(r);
+    }
+
+    r->fd = accept4(r->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (r->fd < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    if (_shareRing(r)) {
+        _disconnect(r);
+        return -1;
+    }
+
+    return 1;
+}
+
+enum gfx_remote_status gfxRemoteSendFrame(gfx_remote_handle_t remote,
+        const void *frame, size_t size)
+{
+    struct remote *r = CAST_REMOTE(remote);
+    struct remote_ring *ring = r->ring;
+    struct remote_frame_header *header;
+    uint64_t head, tail, pos, pad = 0;
+    size_t need = sizeof(struct remote_frame_header) + REMOTE_ALIGNED(size);
+
+    if (ring == NULL) {
+        return GFX_REMOTE_NO_VIEWER;
+    }
+
+    if (need > ring->size / 2) {
+        return GFX_REMOTE_DROPPED;
+    }
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    pos = head & (ring->size - 1);
+
+    if (pos + need > ring->size) {
+        pad = ring->size - pos;
+    }
+
+    if (ring->size - (head - tail) < pad + need) {
+        return GFX_REMOTE_DROPPED;
+    }
+
+    if (pad) {
+        header = (struct remote_frame_header *)&ring->data[pos];
+        header->size = REMOTE_PAD;
+        pos = 0;
+    }
+
+    header = (struct remote_frame_header *)&ring->data[pos];
+    header->size = size;
+    memcpy(header + 1, frame, size);
+
+    __atomic_store_n(&ring->head, head + pad + need, __ATOMIC_RELEASE);
+
+    // A full socket buffer still holds wake-ups the viewer has yet to read
+    send(r->fd, "", 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    return GFX_REMOTE_SENT;
+}
+
+ssize_t gfxRemoteReceiveMessage(gfx_remote_handle_t remote, void *msg,
+                                size_t size)
+{
+    struct remote *r = CAST_REMOTE(remote);
+    ssize_t ret;
+
+    if (r->fd < 0) {
+        return 0;
+    }
+
+    ret = recv(r->fd, msg, size, MSG_DONTWAIT);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    // End of file, gfxRemoteAccept() drops the viewer next frame
+    return ret ? ret : -1;
+}
+
+// Receives the file descriptor of the ring passed by _shareRing()
+static int _receiveRing(struct remote *remote)
+{
+    char byte;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr msg = { .msg_iov = &iov,
+               .msg_iovlen = 1,
+               .msg_control = control.buf,
+               .msg_controllen = sizeof(control.buf)
+    };
+    struct cmsghdr *cmsg;
+    struct stat st;
+    int fd;
+
+    if (recvmsg(remote->fd, &msg, MSG_CMSG_CLOEXEC) != 1) {
+        PRINT_ERROR("Failed to receive shared memory");
+        goto err_recv;
+    }
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS) {
+        PRINT_ERROR("Emulator did not pass shared memory");
+        goto err_recv;
+    }
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(struct remote_ring)) {
+        PRINT_ERROR("Shared memory is too small");
+        goto err_map;
+    }
+
+    remote->map_size = st.st_size;
+    remote->ring = mmap(NULL, remote->map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    if (remote->ring == MAP_FAILED) {
+        remote->ring = NULL;
+        PRINT_ERROR("Failed to map shared memory");
+        goto err_map;
+    }
+
+    if (remote->ring->magic != REMOTE_MAGIC ||
+        remote->ring->version != REMOTE_VERSION ||
+        sizeof(struct remote_ring) + remote->ring->size !=
+        remote->map_size ||
+        remote->ring->size & (remote->ring->size - 1)) {
+        PRINT_ERROR("Emulator uses an incompatible frame channel");
+        goto err_version;
+    }
+
+    // The ring's header lives in shared memory, only trust it once
+    remote->ring_size = remote->ring->size;
+
+    close(fd);
+
+    remote->frame_end = __atomic_load_n(&remote->ring->tail,
+                                        __ATOMIC_RELAXED);
+
+    return 0;
+
+err_version:
+    munmap(remote->ring, remote->map_size);
+    remote->ring = NULL;
+err_map:
+    close(fd);
+err_recv:
+    return -1;
+}
+
+gfx_remote_handle_t gfxRemoteConnect(const char *socket_path)
+{
+    struct sockaddr_un addr;
+    struct remote *ret;
+
+    if (_socketAddress(socket_path, &addr)) {
+        goto err_address;
+    }
+
+    ret = calloc(1, sizeof(struct remote));
+    if (ret == NULL) {
+        PRINT_ERROR("Failed to allocate remote");
+        goto err_alloc;
+    }
+
+    ret->listen_fd = -1;
+
+    ret->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (ret->fd < 0) {
+        PRINT_ERROR("Failed to create socket");
+        goto err_socket;
+    }
+
+    // No emulator listening is expected while waiting for one, not an error
+    if (connect(ret->fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        goto err_connect;
+    }
+
+    if (_receiveRing(ret)) {
+        goto err_connect;
+    }
+
+    return (gfx_remote_handle_t)ret;
+
+err_connect:
+    close(ret->fd);
+err_socket:
+    free(ret);
+err_alloc:
+err_address:
+    return NULL;
+}
+
+int gfxRemoteReceiveFrame(gfx_remote_handle_t remote, void **frame,
+                          size_t *size, int timeout_ms)
+{
+    struct remote *r = CAST_REMOTE(remote);
+    struct remote_ring *ring = r->ring;
+    struct remote_frame_header *header;
+    struct pollfd pfd;
+    uint64_t head, tail, pos, avail;
+    uint32_t frame_size;
+    char buf[64];
+    ssize_t len;
+
+    while (1) {
+        tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        if (tail != head) {
+            pos = tail & (r->ring_size - 1);
+            header = (struct remote_frame_header *)&ring->data[pos];
+            frame_size = header->size;
+
+            // Frames never wrap around the end of the ring
+            avail = r->ring_size - pos;
+            if (head - tail < avail) {
+                avail = head - tail;
+            }
+
+            if (frame_size == REMOTE_PAD) {
+                if (r->ring_size - pos > avail) {
+                    goto err_corrupt;
+                }
+                __atomic_store_n(&ring->tail, tail + r->ring_size - pos,
+                                 __ATOMIC_RELEASE);
+                continue;
+            }
+
+            if (avail < sizeof(struct remote_frame_header) ||
+                REMOTE_ALIGNED((uint64_t)frame_size) >
+                avail - sizeof(struct remote_frame_header)) {
+                goto err_corrupt;
+            }
+
+            *frame = header + 1;
+            *size = frame_size;
+            r->frame_end = tail + sizeof(struct remote_frame_header) +
+                           REMOTE_ALIGNED(frame_size);
+            return 1;
+        }
+
+        pfd = (struct pollfd) {
+            .fd = r->fd, .events = POLLIN
+        };
+        if (poll(&pfd, 1, timeout_ms) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+
+        if (!pfd.revents) {
+            return 0;
+        }
+
+        // Drains the wake-ups, end of file once the emulator is gone
+        len = recv(r->fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+            return -1;
+        }
+    }
+
+err_corrupt:
+    PRINT_ERROR("Received a frame that overruns the ring");
+    return -1;
+}
+
+int gfxRemoteSendMessage(gfx_remote_handle_t remote, const void *msg,
+                         size_t size)
+{
+    struct remote *r = CAST_REMOTE(remote);
+
+    // Dropped rather than stalling the viewer if the emulator is not reading
+    if (send(r->fd, msg, size, MSG_DONTWAIT | MSG_NOSIGNAL) !=
+        (ssize_t)size) {
+        return -1;
+    }
+
+    return 0;
+}
+
+unsigned char gfxRemoteFramePending(gfx_remote_handle_t remote)
+{
+    struct remote *r = CAST_REMOTE(remote);
+
+    return __atomic_load_n(&r->ring->head, __ATOMIC_ACQUIRE) != r->frame_end;
+}
+
+void gfxRemoteReleaseFrame(gfx_remote_handle_t remote)
+{
+    struct remote *r = CAST_REMOTE(remote);
+
+    __atomic_store_n(&r->ring->tail, r->frame_end, __ATOMIC_RELEASE);
+}
+
+void gfxRemoteClose(gfx_remote_handle_t remote)
+{
+    struct remote *r = CAST_REMOTE(remote);
+
+    if (r == NULL) {
+        return;
+    }
+
+    _disconnect(r);
+
+    if (r->listen_fd >= 0) {
+        close(r->listen_fd);
+        unlink(r->socket_path);
+    }
+
+    free(r->socket_path);
+    free(r);
+}
+
+// Images defined by the emulator a viewer is connected to
+static struct viewer {
+    struct viewer_image {
+        uint32_t id;
+        gfx_image_handle_t img; // NULL if the image failed to load
+        unsigned char stale; // Not defined again since the last reset
+    } *images;
+    unsigned int n_images;
+    unsigned int images_size;
+} viewer = { 0 };
+
+static struct viewer_image *_viewerFindImage(uint32_t id)
+{
+    unsigned int i;
+
+    for (i = 0; i < viewer.n_images; i++)
+        if (viewer.images[i].id == id) {
+            return &viewer.images[i];
+        }
+
+    return NULL;
+}
+
+static void _viewerFreeImage(struct viewer_image *image)
+{
+    if (image->img) {
+        gfxDrawFreeLoadedImage(&image->img);
+    }
+    *image = viewer.images[--viewer.n_images];
+}
+
+// Frees the images that were not defined again since the last reset, or all
+static void _viewerSweepImages(unsigned char all)
+{
+    unsigned int i = 0;
+
+    while (i < viewer.n_images) {
+        if (all || viewer.images[i].stale) {
+            _viewerFreeImage(&viewer.images[i]);
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+// Size of a string in a record including its terminator, 0 if it overruns
+static size_t _viewerStringSize(const char *str, size_t left)
+{
+    const char *end = memchr(str, '\0', left);
+
+    return end ? end - str + 1 : 0;
+}
+
+// Loads an image the emulator defined, -1 if the record is malformed
+static int _viewerDefineImage(struct remote_record *record)
+{
+    struct remote_image *define = (struct remote_image *)(record + 1);
+    struct viewer_image *image;
+    struct viewer_image *images;
+    unsigned int size;
+
+    if (record->size < sizeof(*define) ||
+        !_viewerStringSize((char *)(define + 1),
+                           record->size - sizeof(*define))) {
+        return -1;
+    }
+
+    image = _viewerFindImage(define->id);
+
+    // IDs are not reused, the image is still the one loaded before the reset
+    if (image) {
+        image->stale = 0;
+        return 0;
+    }
+
+    if (viewer.n_images == viewer.images_size) {
+        size = viewer.images_size ? viewer.images_size * 2 : 16;
+        images = realloc(viewer.images, size * sizeof(struct viewer_image));
+        if (images == NULL) {
+            PRINT_ERROR("Failed to allocate viewer images");
+            return 0;
+        }
+        viewer.images = images;
+        viewer.images_size = size;
+    }
+
+    viewer.images[viewer.n_images++] = (struct viewer_image) {
+        .id = define->id,
+         .img = gfxDrawLoadScaledImage((char *)(define + 1), define->scale),
+    };
+
+    return 0;
+}
+
+// Rebuilds a job from its record and draws it
+static int _viewerDrawRecord(struct remote_record *record)
+{
+    union data_u *payload = (union data_u *)(record + 1);
+    unsigned char *extra = (unsigned char *)(payload + 1);
+    struct viewer_image *image = NULL;
+    struct remote_text *text;
+    struct remote_mesh *mesh = NULL;
+    draw_job_type_t type = record->type;
+    size_t size = 0, left, name_size;
+    SDL_FPoint *points;
+    char *font_name;
+    unsigned int i;
+
+    if (record->size < sizeof(union data_u)) {
+        goto err_malformed;
+    }
+    left = record->size - sizeof(union data_u); // Bytes at extra
+
+    // Counts in the payload are checked against the bytes that follow it
+    switch (type) {
+        case DRAW_POLYLINE:
+        case DRAW_POLY:
+        case DRAW_FILLED_POLY:
+            if (payload->poly.n > left / (2 * sizeof(Sint16))) {
+                goto err_malformed;
+            }
+            size = 2 * payload->poly.n * sizeof(Sint16);
+            break;
+        case DRAW_TEXT:
+            if (left < sizeof(struct remote_text)) {
+                goto err_malformed;
+            }
+            left -= sizeof(struct remote_text);
+            font_name = (char *)extra + sizeof(struct remote_text);
+            name_size = _viewerStringSize(font_name, left);
+            if (!name_size ||
+                !_viewerStringSize(font_name + name_size,
+                                   left - name_size)) {
+                goto err_malformed;
+            }
+            break;
+        case DRAW_IMAGE:
+        case DRAW_SCALED_IMAGE:
+            if (!_viewerStringSize((char *)extra, left)) {
+                goto err_malformed;
+            }
+            break;
+        case DRAW_LOADED_IMAGE:
+        case DRAW_LOADED_IMAGE_CROP:
+        case DRAW_SPRITE_BATCH:
+            if (left < sizeof(uint32_t)) {
+                goto err_malformed;
+            }
+            left -= sizeof(uint32_t);
+            if (type == DRAW_SPRITE_BATCH &&
+                payload->sprite_batch.n > left / (2 * sizeof(SDL_Rect))) {
+                goto err_malformed;
+            }
+            image = _viewerFindImage(*(uint32_t *)extra);
+            if (image == NULL || image->img == NULL) {
+                return -1;
+            }
+            extra += sizeof(uint32_t);
+            break;
+        case DRAW_PATH:
+            if (left < sizeof(struct remote_mesh)) {
+                goto err_malformed;
+            }
+            left -= sizeof(struct remote_mesh);
+            mesh = (struct remote_mesh *)extra;
+            if (mesh->n_verts > left / sizeof(SDL_FPoint) ||
+                mesh->n_indices >
+                (left - mesh->n_verts * sizeof(SDL_FPoint)) / sizeof(int)) {
+                goto err_malformed;
+            }
+            size = mesh->n_verts * sizeof(SDL_Vertex) +
+                   mesh->n_indices * sizeof(int);
+            type = DRAW_MESH;
+            break;
+        case DRAW_TILEMAP:
+        case DRAW_CHART:
+        case DRAW_MESH:
+            // Never sent, their data would be pointers into the emulator
+            goto err_malformed;
+        default:
+            break;
+    }
+
+    INIT_JOB_EXTRA(job, type, size);
+    union data_u *data = job->data;
+
+    if (mesh == NULL) {
+        memcpy(data, payload, sizeof(union data_u));
+    }
+
+    switch (type) {
+        case DRAW_POLYLINE:
+        case DRAW_POLY:
+        case DRAW_FILLED_POLY:
+            data->poly.x = (Sint16 *)(data + 1);
+            data->poly.y = data->poly.x + data->poly.n;
+            memcpy(data->poly.x, extra, size);
+            break;
+        case DRAW_TEXT:
+            text = (struct remote_text *)extra;
+            font_name = (char *)(text + 1);
+            data->text.font = gfxFontGetFont(font_name, text->font_size);
+            data->text.str = strdup(font_name + strlen(font_name) + 1);
+            if (data->text.font == NULL || data->text.str == NULL) {
+                if (data->text.font) {
+                    gfxFontPutFont(data->text.font);
+                }
+                free(data->text.str);
+                gfxDrawDiscardJob(job);
+                return -1;
+            }
+            break;
+        case DRAW_IMAGE:
+        case DRAW_SCALED_IMAGE:
+            data->image.filename = strdup((char *)extra);
+            break;
+        case DRAW_LOADED_IMAGE:
+            vGetLoadedImage(image->img);
+            data->loaded_image.img = image->img;
+            break;
+        case DRAW_LOADED_IMAGE_CROP:
+            vGetLoadedImage(image->img);
+            data->loaded_image_crop.image = image->img;
+            break;
+        case DRAW_SPRITE_BATCH:
+            data->sprite_batch.rects =
+                malloc(2 * data->sprite_batch.n * sizeof(SDL_Rect));
+            if (data->sprite_batch.rects == NULL) {
+                gfxDrawDiscardJob(job);
+                return -1;
+            }
+            memcpy(data->sprite_batch.rects, extra,
+                   2 * data->sprite_batch.n * sizeof(SDL_Rect));
+            vGetLoadedImage(image->img);
+            data->sprite_batch.image = image->img;
+            break;
+        case DRAW_MESH:
+            data->mesh = (mesh_data_t) {
+                .mesh = {
+                    .verts = (SDL_Vertex *)(data + 1),
+                    .n_verts = mesh->n_verts,
+                    .n_indices = mesh->n_indices,
+                },
+                .x = payload->path.x,
+                .y = payload->path.y,
+                .colour = payload->path.colour,
+            };
+            data->mesh.mesh.indices =
+                (int *)(data->mesh.mesh.verts + mesh->n_verts);
+
+            points = (SDL_FPoint *)(mesh + 1);
+            for (i = 0; i < mesh->n_verts; i++) {
+                data->mesh.mesh.verts[i].position = points[i];
+            }
+            memcpy(data->mesh.mesh.indices, points + mesh->n_verts,
+                   mesh->n_indices * sizeof(int));
+            break;
+        default:
+            break;
+    }
+
+    return gfxDrawReplayJob(job, record->x_offset, record->y_offset);
+
+err_malformed:
+    PRINT_ERROR("Received a malformed %u record", record->type);
+    return -1;
+}
+
+int gfxRemoteViewerDecodeFrame(unsigned char *frame, size_t size,
+                               unsigned char draw)
+{
+    struct remote_record *record;
+    struct viewer_image *image;
+    unsigned char reset = 0;
+    size_t pos;
+    unsigned int i;
+    int ret = 0;
+
+    for (pos = 0; pos + sizeof(*record) <= size;
+         pos += REMOTE_RECORD_SIZE(record->size)) {
+        record = (struct remote_record *)&frame[pos];
+
+        if (record->size > size - pos - sizeof(*record) ||
+            REMOTE_RECORD_SIZE(record->size) > size - pos) {
+            PRINT_ERROR("Received a truncated %u record", record->type);
+            return -1;
+        }
+
+        switch (record->type) {
+            case REMOTE_FRAME:
+                if (record->size < sizeof(struct remote_frame)) {
+                    goto err_malformed;
+                }
+                gfxDrawHUDShow(((struct remote_frame *)(record + 1))->hud);
+                break;
+            case REMOTE_RESET:
+                for (i = 0; i < viewer.n_images; i++) {
+                    viewer.images[i].stale = 1;
+                }
+                reset = 1;
+                break;
+            case REMOTE_IMAGE_DEFINE:
+                if (_viewerDefineImage(record)) {
+                    goto err_malformed;
+                }
+                break;
+            case REMOTE_IMAGE_RELEASE:
+                if (record->size < sizeof(struct remote_image)) {
+                    goto err_malformed;
+                }
+                image = _viewerFindImage(
+                            ((struct remote_image *)(record + 1))->id);
+                if (image) {
+                    _viewerFreeImage(image);
+                }
+                break;
+            default:
+                if (!draw || record->type >= DRAW_JOB_TYPE_COUNT) {
+                    break;
+                }
+                gfxHUDCountJob(record->type);
+                if (_viewerDrawRecord(record)) {
+                    ret = -1;
+                }
+                break;
+        }
+    }
+
+    if (reset) {
+        _viewerSweepImages(0);
+    }
+
+    return ret;
+
+err_malformed:
+    PRINT_ERROR("Received a malformed %u record", record->type);
+    return -1;
+}
+
+void gfxRemoteViewerFreeImages(void)
+{
+    _viewerSweepImages(1);
+}
@@ -38,9 +38,14 @@
 #define MIXING_CHANNELS 4
 #define GEN_FULL_SAMPLE_PATH(SAMPLE) \
     SAMPLE_FOLDER #SAMPLE ".wav",
+#define GEN_SAMPLE_NAME(SAMPLE) #SAMPLE ".wav",
 
 Mix_Chunk *samples[NUM_WAVEFORMS] = { 0 };
 
+// Guards the samples against being replaced by a hot-reload while played
+static pthread_mutex_t samples_lock = PTHREAD_MUTEX_INITIALIZER;
+GFX_LOCK_STATS(samples_lock_stats, "sound samples_lock");
+
 static char gfxSound_online = 0;
 
 typedef struct loaded_sample {
@@ -57,11 +62,64 @@ void gfxSoundExit(void)
     unsigned int i;
 
     for (i = 0; i < NUM_WAVEFORMS; i++) {
+        gfxUtilMemSub(GFX_MEM_SAMPLES, samples[i]->alen);
         Mix_FreeChunk(samples[i]);
     }
 #endif /* DOCKER */
 }
 
+#ifndef DOCKER
+static const char *sample_names[NUM_WAVEFORMS] = {
+    FOR_EACH_SAMPLE(GEN_SAMPLE_NAME)
+};
+
+static void _reloadSample(Mix_Chunk **sample, const char *path)
+{
+    Mix_Chunk *chunk = Mix_LoadWAV(path), *old;
+
+    if (chunk == NULL) {
+        PRINT_ERROR("Failed to reload sample '%s'", path);
+        return;
+    }
+    gfxUtilMemAdd(GFX_MEM_SAMPLES, chunk->alen);
+
+    GFX_MUTEX_LOCK(&samples_lock, samples_lock_stats);
+    old = *sample;
+    *sample = chunk;
+    GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
+
+    // Halts any channel still playing the old sample
+    if (old) {
+        gfxUtilMemSub(GFX_MEM_SAMPLES, old->alen);
+        Mix_FreeChunk(old);
+    }
+}
+
+// Resource listener, reloads the samples loaded from a changed file
+static void _reloadChangedSample(const char *name, const char *path)
+{
+    loaded_sample_t *iterator;
+    unsigned int i;
+
+    for (i = 0; i < NUM_WAVEFORMS; i++)
+        if (!strcmp(sample_names[i], name)) {
+            _reloadSample(&samples[i], path);
+        }
+
+    GFX_MUTEX_LOCK(&samples_lock, samples_lock_stats);
+    for (iterator = user_samples.next; iterator; iterator = iterator->next)
+        if (!strcmp(iterator->name, name)) {
+            break;
+        }
+    GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
+
+    // User samples are never removed from the list
+    if (iterator) {
+        _reloadSample(&iterator->sample, path);
+    }
+}
+#endif /* DOCKER */
+
 int gfxSoundInit(char *bin_dir_str)
 {
 #ifndef DOCKER
@@ -69,7 +127,7 @@ int gfxSoundInit(char *bin_dir_str)
 
     char *fullWaveFileNames[NUM_WAVEFORMS] = { 0 };
 
-    int ret;
+    int ret, phase;
     size_t bin_dir_len = strlen(bin_dir_str);
     unsigned int i, j;
 
@@ -86,11 +144,14 @@ int gfxSoundInit(char *bin_dir_str)
         strcat(fullWaveFileNames[i], waveFileNames[i]);
     }
 
+    phase = gfxUtilInitPhaseBegin("audio open");
     if (Mix_OpenAudio(22050, AUDIO_S16SYS, AUDIO_CHANNELS, 512)) {
         PRINT_ERROR("Failed to open audio with #%d channels",
                     AUDIO_CHANNELS);
+        gfxUtilInitPhaseEnd(phase);
         goto err_open_audio;
     }
+    gfxUtilInitPhaseEnd(phase);
 
     if ((ret = Mix_AllocateChannels(MIXING_CHANNELS)) != MIXING_CHANNELS) {
         PRINT_ERROR("Failed to allocate %d channels, only %d allocated",
@@ -98,15 +159,19 @@ int gfxSoundInit(char *bin_dir_str)
         goto err_allocate_channels;
     }
 
+    phase = gfxUtilInitPhaseBegin("sample decode");
     for (i = 0; i < NUM_WAVEFORMS; i++) {
         samples[i] = Mix_LoadWAV(
                          gfxUtilFindResourcePath(fullWaveFileNames[i]));
         if (!samples[i]) {
             PRINT_ERROR("Failed to load WAV: %s",
                         fullWaveFileNames[i]);
+            gfxUtilInitPhaseEnd(phase);
             goto err_loadWAV;
         }
+        gfxUtilMemAdd(GFX_MEM_SAMPLES, samples[i]->alen);
     }
+    gfxUtilInitPhaseEnd(phase);
 
     for (j = 0; j < i; j++) {
         free(fullWaveFileNames[j]);
@@ -116,10 +181,13 @@ int gfxSoundInit(char *bin_dir_str)
 
     atexit(gfxSoundExit);
 
+    gfxUtilAddResourceListener(_reloadChangedSample);
+
     return 0;
 
 err_loadWAV:
     for (j = 0; j < i; j++) {
+        gfxUtilMemSub(GFX_MEM_SAMPLES, samples[j]->alen);
         Mix_FreeChunk(samples[j]);
     }
 err_allocate_channels:
@@ -141,7 +209,9 @@ void gfxSoundPlaySample(unsigned char index)
 {
 #ifndef DOCKER
     if (gfxSound_online) {
+        GFX_MUTEX_LOCK(&samples_lock, samples_lock_stats);
         Mix_PlayChannel(-1, samples[index], 0);
+        GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
     }
 #endif /* DOCKER */
 }
@@ -176,6 +246,9 @@ int gfxSoundLoadUserSample(const char *filepath)
         PRINT_ERROR("Count not load sample '%s'", filepath);
         goto err_sample;
     }
+    gfxUtilMemAdd(GFX_MEM_SAMPLES, new_sample->sample->alen);
+
+    GFX_MUTEX_LOCK(&samples_lock, samples_lock_stats);
 
     loaded_sample_t *iterator = &user_samples;
 
@@ -184,6 +257,8 @@ int gfxSoundLoadUserSample(const char *filepath)
 
     iterator->next = new_sample;
 
+    GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
+
     return 0;
 err_sample:
     free(new_sample->name);
@@ -199,6 +274,8 @@ int gfxSoundPlayUserSample(const char *filename)
         return -1;
     }
 
+    GFX_MUTEX_LOCK(&samples_lock, samples_lock_stats);
+
     loaded_sample_t *iterator = &user_samples;
 
     for (; iterator; iterator = iterator->next)
@@ -206,14 +283,17 @@ int gfxSoundPlayUserSample(const char *filename)
             goto found_sample;
         }
 
+    GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
     return -1;
 
 found_sample:
     if (!iterator->sample) {
         PRINT_ERROR("Sample '%s' does not have a loaded sample",
                     iterator->name ? iterator->name : "NULL");
+        GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
         return -1;
     }
     Mix_PlayChannel(-1, iterator->sample, 0);
+    GFX_MUTEX_UNLOCK(&samples_lock, samples_lock_stats);
     return 0;
 }
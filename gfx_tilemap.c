@@ -0,0 +1,471 @@
+/**
+ * @file gfx_tilemap.c
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Tilemaps pre-rendered in chunks of tiles, with animated tiles drawn
+ * over the chunks
+ *
+ * @verbatim
+   ----------------------------------------------------------------------
+    Copyright (C) Alexander Hoffman, 2019
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------
+@endverbatim
+ */
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include <pthread.h>
+
+#include "gfx_draw_internal.h"
+#include "gfx_print.h"
+#include "gfx_utils.h"
+
+typedef struct tilemap_animation {
+    unsigned index;
+    unsigned frames;
+    unsigned frame_period_ms;
+} tilemap_animation_t;
+
+typedef struct tilemap_chunk {
+    SDL_Texture *tex; // Static tiles, only touched by the GL thread
+    unsigned char dirty;
+    unsigned animated_count;
+    unsigned short animated[GFX_TILEMAP_CHUNK_TILES * GFX_TILEMAP_CHUNK_TILES];
+} tilemap_chunk_t;
+
+struct tilemap {
+    spritesheet_t *sheet;
+    unsigned cols;
+    unsigned rows;
+    unsigned chunk_cols;
+    unsigned chunk_rows;
+    unsigned *tiles;
+    tilemap_chunk_t *chunks;
+    unsigned generation; // Renderer the chunk textures were created on
+    unsigned image_version; // Version of the tileset the chunks show
+    unsigned animation_count;
+    tilemap_animation_t animations[GFX_TILEMAP_MAX_ANIMATIONS];
+    pthread_mutex_t lock;
+};
+
+GFX_LOCK_STATS(tilemap_lock_stats, "tilemap.lock");
+
+static tilemap_animation_t *_tilemapAnimation(tilemap_t *map, unsigned index)
+{
+    unsigned i;
+
+    for (i = 0; i < map->animation_count; i++)
+        if (map->animations[i].index == index) {
+            return &map->animations[i];
+        }
+
+    return NULL;
+}
+
+static int _bakeTilemapChunk(tilemap_t *map, tilemap_chunk_t *chunk,
+                             unsigned chunk_col, unsigned chunk_row,
+                             SDL_Texture *sheet_tex)
+{
+    spritesheet_t *sheet = map->sheet;
+    unsigned cells = sheet->sprite_cols * sheet->sprite_rows;
+
+    if (chunk->tex == NULL) {
+        chunk->tex = gfxDrawTrackTexture(SDL_CreateTexture(
+                         renderer, SDL_PIXELFORMAT_RGBA8888,
+                         SDL_TEXTUREACCESS_TARGET,
+                         GFX_TILEMAP_CHUNK_TILES * sheet->sprite_width,
+                         GFX_TILEMAP_CHUNK_TILES * sheet->sprite_height));
+        if (chunk->tex == NULL) {
+            PRINT_SDL_ERROR("Failed to create tilemap chunk texture");
+            return -1;
+        }
+        SDL_SetTextureBlendMode(chunk->tex, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Texture *prev_target = SDL_GetRenderTarget(renderer);
+
+    if (SDL_SetRenderTarget(renderer, chunk->tex)) {
+        PRINT_SDL_ERROR("Failed to render to tilemap chunk");
+        return -1;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, ZERO_ALPHA);
+    SDL_RenderClear(renderer);
+
+    unsigned col, row;
+
+    chunk->animated_count = 0;
+
+    for (row = 0; row < GFX_TILEMAP_CHUNK_TILES; row++)
+        for (col = 0; col < GFX_TILEMAP_CHUNK_TILES; col++) {
+            unsigned map_col = chunk_col * GFX_TILEMAP_CHUNK_TILES + col;
+            unsigned map_row = chunk_row * GFX_TILEMAP_CHUNK_TILES + row;
+
+            if (map_col >= map->cols || map_row >= map->rows) {
+                continue;
+            }
+
+            unsigned index = map->tiles[map_row * map->cols + map_col];
+
+            if (index >= cells) {
+                continue;
+            }
+
+            // Animated tiles are drawn over the chunk every frame
+            if (_tilemapAnimation(map, index)) {
+                chunk->animated[chunk->animated_count++] =
+                    row * GFX_TILEMAP_CHUNK_TILES + col;
+                continue;
+            }
+
+            SDL_Rect dst = { col * sheet->sprite_width,
+                             row * sheet->sprite_height, sheet->sprite_width,
+                             sheet->sprite_height
+                           };
+            SDL_RenderCopy(renderer, sheet_tex, &sheet->cells[index], &dst);
+        }
+
+    SDL_SetRenderTarget(renderer, prev_target);
+    chunk->dirty = 0;
+
+    return 0;
+}
+
+int gfxTilemapRender(tilemap_t *map, int x, int y)
+{
+    spritesheet_t *sheet = map->sheet;
+    int chunk_w = GFX_TILEMAP_CHUNK_TILES * sheet->sprite_width;
+    int chunk_h = GFX_TILEMAP_CHUNK_TILES * sheet->sprite_height;
+    SDL_Texture *sheet_tex = gfxDrawGetImageTexture(sheet->image);
+    unsigned cells = sheet->sprite_cols * sheet->sprite_rows;
+    unsigned now = gfxDrawFrameClockGetMs();
+    int ret = 0;
+
+    if (sheet_tex == NULL || !chunk_w || !chunk_h) {
+        return -1;
+    }
+
+    // Only visible chunks are drawn
+    if (x >= SCREEN_WIDTH || y >= SCREEN_HEIGHT) {
+        return 0;
+    }
+
+    int first_col = x < 0 ? -x / chunk_w : 0;
+    int first_row = y < 0 ? -y / chunk_h : 0;
+    int last_col = (SCREEN_WIDTH - 1 - x) / chunk_w;
+    int last_row = (SCREEN_HEIGHT - 1 - y) / chunk_h;
+
+    if (last_col >= (int)map->chunk_cols) {
+        last_col = map->chunk_cols - 1;
+    }
+    if (last_row >= (int)map->chunk_rows) {
+        last_row = map->chunk_rows - 1;
+    }
+
+    GFX_MUTEX_LOCK(&map->lock, tilemap_lock_stats);
+
+    // Chunk textures were destroyed along with a previous renderer
+    if (map->generation != renderer_generation) {
+        unsigned i;
+
+        for (i = 0; i < map->chunk_cols * map->chunk_rows; i++) {
+            map->chunks[i].tex = NULL;
+            map->chunks[i].dirty = 1;
+        }
+        map->generation = renderer_generation;
+    }
+
+    // The tileset was hot-reloaded
+    if (map->image_version != gfxDrawGetImageVersion(sheet->image)) {
+        unsigned i;
+
+        for (i = 0; i < map->chunk_cols * map->chunk_rows; i++) {
+            map->chunks[i].dirty = 1;
+        }
+        map->image_version = gfxDrawGetImageVersion(sheet->image);
+    }
+
+    int chunk_col, chunk_row;
+
+    for (chunk_row = first_row; chunk_row <= last_row; chunk_row++)
+        for (chunk_col = first_col; chunk_col <= last_col; chunk_col++) {
+            tilemap_chunk_t *chunk =
+                &map->chunks[chunk_row * map->chunk_cols + chunk_col];
+            int chunk_x = x + chunk_col * chunk_w;
+            int chunk_y = y + chunk_row * chunk_h;
+
+            if (chunk->dirty &&
+                _bakeTilemapChunk(map, chunk, chunk_col, chunk_row,
+                                  sheet_tex)) {
+                ret = -1;
+                continue;
+            }
+
+            SDL_Rect dst = { chunk_x, chunk_y, chunk_w, chunk_h };
+            SDL_RenderCopy(renderer, chunk->tex, NULL, &dst);
+
+            unsigned i;
+
+            for (i = 0; i < chunk->animated_count; i++) {
+                unsigned col = chunk->animated[i] % GFX_TILEMAP_CHUNK_TILES;
+                unsigned row = chunk->animated[i] / GFX_TILEMAP_CHUNK_TILES;
+                unsigned map_col = chunk_col * GFX_TILEMAP_CHUNK_TILES + col;
+                unsigned map_row = chunk_row * GFX_TILEMAP_CHUNK_TILES + row;
+                unsigned index = map->tiles[map_row * map->cols + map_col];
+                tilemap_animation_t *anim = _tilemapAnimation(map, index);
+
+                if (anim == NULL) {
+                    continue;
+                }
+
+                index += (now / anim->frame_period_ms) % anim->frames;
+                if (index >= cells) {
+                    continue;
+                }
+
+                SDL_Rect tile = { chunk_x + col * sheet->sprite_width,
+                                  chunk_y + row * sheet->sprite_height,
+                                  sheet->sprite_width, sheet->sprite_height
+                                };
+                SDL_RenderCopy(renderer, sheet_tex, &sheet->cells[index],
+                               &tile);
+            }
+        }
+
+    GFX_MUTEX_UNLOCK(&map->lock, tilemap_lock_stats);
+
+    return ret;
+}
+
+void gfxTilemapGetSize(tilemap_t *map, unsigned int *width,
+                       unsigned int *height)
+{
+    *width = map->cols * map->sheet->sprite_width;
+    *height = map->rows * map->sheet->sprite_height;
+}
+
+void gfxTilemapFree(tilemap_t *map)
+{
+    unsigned i;
+
+    if (map->generation == renderer_generation)
+        for (i = 0; i < map->chunk_cols * map->chunk_rows; i++)
+            if (map->chunks[i].tex) {
+                gfxDrawDestroyTexture(map->chunks[i].tex);
+            }
+
+    vPutLoadedImage(map->sheet->image);
+    pthread_mutex_destroy(&map->lock);
+    free(map->chunks);
+    free(map->tiles);
+    free(map);
+}
+
+gfx_tilemap_handle_t gfxDrawTilemapCreate(gfx_spritesheet_handle_t spritesheet,
+                                          unsigned cols, unsigned rows)
+{
+    if (spritesheet == NULL) {
+        PRINT_ERROR("Tilemap requires a valid spritesheet");
+        goto err;
+    }
+
+    if (!cols || !rows) {
+        PRINT_ERROR("Tilemap requires at least one column and row");
+        goto err;
+    }
+
+    tilemap_t *ret = calloc(1, sizeof(tilemap_t));
+    if (ret == NULL) {
+        PRINT_ERROR("Could not allocate tilemap");
+        goto err;
+    }
+
+    ret->sheet = (spritesheet_t *)spritesheet;
+    ret->cols = cols;
+    ret->rows = rows;
+    ret->chunk_cols = (cols + GFX_TILEMAP_CHUNK_TILES - 1) /
+                      GFX_TILEMAP_CHUNK_TILES;
+    ret->chunk_rows = (rows + GFX_TILEMAP_CHUNK_TILES - 1) /
+                      GFX_TILEMAP_CHUNK_TILES;
+
+    ret->tiles = malloc(cols * rows * sizeof(unsigned));
+    if (ret->tiles == NULL) {
+        PRINT_ERROR("Could not allocate %ux%u tilemap tiles", cols, rows);
+        goto err_tiles;
+    }
+
+    unsigned i;
+
+    for (i = 0; i < cols * rows; i++) {
+        ret->tiles[i] = GFX_TILEMAP_EMPTY;
+    }
+
+    ret->chunks =
+        calloc(ret->chunk_cols * ret->chunk_rows, sizeof(tilemap_chunk_t));
+    if (ret->chunks == NULL) {
+        PRINT_ERROR("Could not allocate tilemap chunks");
+        goto err_chunks;
+    }
+
+    for (i = 0; i < ret->chunk_cols * ret->chunk_rows; i++) {
+        ret->chunks[i].dirty = 1;
+    }
+
+    if (pthread_mutex_init(&ret->lock, NULL)) {
+        PRINT_ERROR("Could not create tilemap lock");
+        goto err_lock;
+    }
+
+    ret->generation = renderer_generation;
+    ret->image_version = gfxDrawGetImageVersion(ret->sheet->image);
+    vGetLoadedImage(ret->sheet->image);
+
+    return (gfx_tilemap_handle_t)ret;
+
+err_lock:
+    free(ret->chunks);
+err_chunks:
+    free(ret->tiles);
+err_tiles:
+    free(ret);
+err:
+    return NULL;
+}
+
+int gfxDrawTilemapDelete(gfx_tilemap_handle_t tilemap)
+{
+    if (tilemap == NULL) {
+        PRINT_ERROR("Tilemap handle is not valid");
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_TILEMAP);
+
+    job->data->tilemap.map = (tilemap_t *)tilemap;
+    job->data->tilemap.release = 1;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
+
+int gfxDrawTilemapSetTile(gfx_tilemap_handle_t tilemap, unsigned col,
+                          unsigned row, unsigned index)
+{
+    tilemap_t *map = (tilemap_t *)tilemap;
+
+    if (map == NULL) {
+        PRINT_ERROR("Tilemap handle is not valid");
+        return -1;
+    }
+
+    if (col >= map->cols || row >= map->rows) {
+        PRINT_ERROR("Tile %u,%u is outside of the tilemap", col, row);
+        return -1;
+    }
+
+    GFX_MUTEX_LOCK(&map->lock, tilemap_lock_stats);
+
+    if (map->tiles[row * map->cols + col] != index) {
+        unsigned chunk = (row / GFX_TILEMAP_CHUNK_TILES) * map->chunk_cols +
+                         col / GFX_TILEMAP_CHUNK_TILES;
+
+        map->tiles[row * map->cols + col] = index;
+        map->chunks[chunk].dirty = 1;
+    }
+
+    GFX_MUTEX_UNLOCK(&map->lock, tilemap_lock_stats);
+
+    return 0;
+}
+
+unsigned gfxDrawTilemapGetTile(gfx_tilemap_handle_t tilemap, unsigned col,
+                               unsigned row)
+{
+    tilemap_t *map = (tilemap_t *)tilemap;
+    unsigned ret;
+
+    if (map == NULL || col >= map->cols || row >= map->rows) {
+        return GFX_TILEMAP_EMPTY;
+    }
+
+    GFX_MUTEX_LOCK(&map->lock, tilemap_lock_stats);
+    ret = map->tiles[row * map->cols + col];
+    GFX_MUTEX_UNLOCK(&map->lock, tilemap_lock_stats);
+
+    return ret;
+}
+
+int gfxDrawTilemapAnimateTile(gfx_tilemap_handle_t tilemap, unsigned index,
+                              unsigned frames, unsigned frame_period_ms)
+{
+    tilemap_t *map = (tilemap_t *)tilemap;
+
+    if (map == NULL) {
+        PRINT_ERROR("Tilemap handle is not valid");
+        return -1;
+    }
+
+    if (!frames || !frame_period_ms) {
+        PRINT_ERROR("Tile animation requires frames and a frame period");
+        return -1;
+    }
+
+    GFX_MUTEX_LOCK(&map->lock, tilemap_lock_stats);
+
+    tilemap_animation_t *anim = _tilemapAnimation(map, index);
+
+    if (anim == NULL) {
+        if (map->animation_count == GFX_TILEMAP_MAX_ANIMATIONS) {
+            GFX_MUTEX_UNLOCK(&map->lock, tilemap_lock_stats);
+            PRINT_ERROR("Tilemap already has %d tile animations",
+                        GFX_TILEMAP_MAX_ANIMATIONS);
+            return -1;
+        }
+        anim = &map->animations[map->animation_count++];
+    }
+
+    anim->index = index;
+    anim->frames = frames;
+    anim->frame_period_ms = frame_period_ms;
+
+    // Tiles showing the index must be removed from the cached chunks
+    unsigned i;
+
+    for (i = 0; i < map->chunk_cols * map->chunk_rows; i++) {
+        map->chunks[i].dirty = 1;
+    }
+
+    GFX_MUTEX_UNLOCK(&map->lock, tilemap_lock_stats);
+
+    return 0;
+}
+
+int gfxDrawTilemapDraw(gfx_tilemap_handle_t tilemap, int x, int y)
+{
+    if (tilemap == NULL) {
+        PRINT_ERROR("Tilemap handle is not valid");
+        return -1;
+    }
+
+    INIT_JOB(job, DRAW_TILEMAP);
+
+    job->data->tilemap.map = (tilemap_t *)tilemap;
+    job->data->tilemap.x = x;
+    job->data->tilemap.y = y;
+
+    gfxDrawPushJob(job);
+
+    return 0;
+}
@@ -24,16 +24,24 @@
 #define _GNU_SOURCE
 #include <assert.h>
 #include <dirent.h>
+#include <errno.h>
 #include <libgen.h>
+#include <poll.h>
 #include <pthread.h>
 #include <regex.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "FreeRTOS.h"
+#include "semphr.h"
+
 #include "gfx_print.h"
 #include "gfx_utils.h"
 
@@ -45,333 +53,1546 @@
 
 #define CAST_RBUF(rbuf) ((struct ring_buf*)rbuf)
 
+#ifndef RBUF_CACHE_LINE_SIZE
+#define RBUF_CACHE_LINE_SIZE 64
+#endif // RBUF_CACHE_LINE_SIZE
+
+#define RBUF_TYPE_MPMC 0
+#define RBUF_TYPE_SPSC 1
+
 // Ring buffer
+//
+// head and tail are free running counters, the slot of a position is found by
+// masking the position with the power of two sized buffer. Producer and
+// consumer state are kept on separate cache lines to avoid false sharing.
+//
+// SPSC buffers publish slots through head/tail alone. MPMC buffers keep a
+// sequence number per slot, a slot at position pos being free when its
+// sequence is pos and holding data when its sequence is pos + 1. Producers
+// and consumers claim positions by CAS on head or tail respectively.
 struct ring_buf {
-    void *buffer;
-    _Atomic int head; // Next free slot
-    _Atomic int tail; // Last stored value
+    // Producer state
+    _Alignas(RBUF_CACHE_LINE_SIZE) _Atomic size_t head; // Next free slot
+    size_t tail_cache; // SPSC producer's last seen tail
+
+    // Consumer state
+    _Alignas(RBUF_CACHE_LINE_SIZE) _Atomic size_t tail; // Oldest stored slot
+    size_t head_cache; // SPSC consumer's last seen head
+
+    // Read only after init
+    _Alignas(RBUF_CACHE_LINE_SIZE) void *buffer;
+    _Atomic size_t *seq; // MPMC slot sequence numbers
     size_t size;
+    size_t mask;
     size_t item_size;
-    unsigned char full;
+    unsigned char type;
+    unsigned char static_buffer;
 };
 
-static pthread_mutex_t GL_thread_lock = PTHREAD_MUTEX_INITIALIZER;
-static pid_t cur_GL_thread = 0;
+// GL ownership
+//
+// Every hand-off increments the owner generation and the new owner stores
+// the generation it received in thread local storage. A thread holds the GL
+// context while its stored generation is still the current one, generation
+// 0 is never handed out so threads that never took ownership fail the check.
+
+static unsigned long GL_owner_generation = 0;
+static __thread unsigned long GL_thread_generation = 0;
 
 int gfxUtilIsCurGLThread(void)
 {
-    int ret = 0;
+    unsigned long generation = GL_thread_generation;
+
+    return (generation && generation == __atomic_load_n(
+                &GL_owner_generation, __ATOMIC_ACQUIRE)) ? 0 : -1;
+}
+
+void gfxUtilSetGLThread(void)
+{
+    GL_thread_generation = __atomic_add_fetch(&GL_owner_generation, 1,
+                                              __ATOMIC_ACQ_REL);
+}
+
+// Lock profiling
+//
+// Statistics are only written while the lock is held, apart from the
+// contended and failed counters, but are read by the report at any time so
+// all accesses are relaxed atomics. Stats register themselves in a lock-free
+// list on their first acquisition.
+
+static gfx_lock_stats_t *lock_stats_list = NULL;
+
+static unsigned long long _lockClockNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned int _lockHistBucket(unsigned long long ns)
+{
+    unsigned long long us = ns / 1000;
+    unsigned int bucket;
+
+    if (!us) {
+        return 0;
+    }
+
+    bucket = 64 - __builtin_clzll(us);
+
+    return bucket < GFX_LOCK_HIST_BUCKETS ? bucket
+           : GFX_LOCK_HIST_BUCKETS - 1;
+}
+
+static void _lockRegister(gfx_lock_stats_t *stats)
+{
+    gfx_lock_stats_t *head;
+
+    if (__atomic_load_n(&stats->registered, __ATOMIC_ACQUIRE) ||
+        __atomic_exchange_n(&stats->registered, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    head = __atomic_load_n(&lock_stats_list, __ATOMIC_RELAXED);
+    do {
+        stats->next = head;
+    }
+    while (!__atomic_compare_exchange_n(&lock_stats_list, &head, stats, 1,
+                                        __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+}
+
+static void _lockRecord(unsigned long long *total, unsigned long long *max,
+                        unsigned long *hist, unsigned long long ns)
+{
+    __atomic_fetch_add(total, ns, __ATOMIC_RELAXED);
+    if (ns > __atomic_load_n(max, __ATOMIC_RELAXED)) {
+        __atomic_store_n(max, ns, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&hist[_lockHistBucket(ns)], 1, __ATOMIC_RELAXED);
+}
+
+static void _lockAcquired(gfx_lock_stats_t *stats, unsigned long long start)
+{
+    unsigned long long now = _lockClockNs();
+
+    __atomic_fetch_add(&stats->acquisitions, 1, __ATOMIC_RELAXED);
+    _lockRecord(&stats->wait_ns, &stats->max_wait_ns, stats->wait_hist,
+                now - start);
+    __atomic_store_n(&stats->acquired_at, now, __ATOMIC_RELAXED);
+}
+
+static void _lockReleasing(gfx_lock_stats_t *stats)
+{
+    _lockRecord(&stats->hold_ns, &stats->max_hold_ns, stats->hold_hist,
+                _lockClockNs() -
+                __atomic_load_n(&stats->acquired_at, __ATOMIC_RELAXED));
+}
+
+int gfxUtilProfMutexLock(pthread_mutex_t *mutex, gfx_lock_stats_t *stats)
+{
+    unsigned long long start;
+    int ret;
+
+    _lockRegister(stats);
+
+    start = _lockClockNs();
+
+    ret = pthread_mutex_trylock(mutex);
+    if (ret == EBUSY) {
+        __atomic_fetch_add(&stats->contended, 1, __ATOMIC_RELAXED);
+        ret = pthread_mutex_lock(mutex);
+    }
+
+    if (ret) {
+        __atomic_fetch_add(&stats->failed, 1, __ATOMIC_RELAXED);
+        return ret;
+    }
+
+    _lockAcquired(stats, start);
+
+    return 0;
+}
+
+int gfxUtilProfMutexUnlock(pthread_mutex_t *mutex, gfx_lock_stats_t *stats)
+{
+    _lockReleasing(stats);
+
+    return pthread_mutex_unlock(mutex);
+}
+
+long gfxUtilProfSemaphoreTake(void *sem, unsigned long ticks,
+                              gfx_lock_stats_t *stats)
+{
+    unsigned long long start;
+
+    _lockRegister(stats);
+
+    start = _lockClockNs();
+
+    if (xSemaphoreTake((SemaphoreHandle_t)sem, 0) != pdTRUE) {
+        __atomic_fetch_add(&stats->contended, 1, __ATOMIC_RELAXED);
+
+        if (!ticks ||
+            xSemaphoreTake((SemaphoreHandle_t)sem, ticks) != pdTRUE) {
+            __atomic_fetch_add(&stats->failed, 1, __ATOMIC_RELAXED);
+            return pdFALSE;
+        }
+    }
+
+    _lockAcquired(stats, start);
+
+    return pdTRUE;
+}
+
+long gfxUtilProfSemaphoreGive(void *sem, gfx_lock_stats_t *stats)
+{
+    _lockReleasing(stats);
+
+    return xSemaphoreGive((SemaphoreHandle_t)sem);
+}
+
+#define LOCK_LOAD(FIELD) __atomic_load_n(&FIELD, __ATOMIC_RELAXED)
+
+static void _lockReportHist(FILE *file, const char *label,
+                            unsigned long *hist)
+{
+    unsigned int i;
+
+    fprintf(file, "    %s", label);
+    for (i = 0; i < GFX_LOCK_HIST_BUCKETS; i++)
+        if (LOCK_LOAD(hist[i])) {
+            if (i == GFX_LOCK_HIST_BUCKETS - 1)
+                fprintf(file, " >=%luus:%lu", 1UL << (i - 1),
+                        LOCK_LOAD(hist[i]));
+            else
+                fprintf(file, " <%luus:%lu", 1UL << i,
+                        LOCK_LOAD(hist[i]));
+        }
+    fprintf(file, "\n");
+}
+
+void gfxUtilLockStatsReport(FILE *file)
+{
+    gfx_lock_stats_t *iterator =
+        __atomic_load_n(&lock_stats_list, __ATOMIC_ACQUIRE);
+    unsigned long acquisitions;
+
+    if (!GFX_LOCK_PROFILING) {
+        fprintf(file,
+                "Lock profiling disabled, set GFX_LOCK_PROFILING to 1\n");
+        return;
+    }
+
+    fprintf(file, "%-20s %10s %10s %6s %18s %18s\n", "LOCK", "ACQUIRED",
+            "CONTENDED", "FAILED", "WAIT AVG/MAX us", "HOLD AVG/MAX us");
+
+    for (; iterator; iterator = iterator->next) {
+        acquisitions = LOCK_LOAD(iterator->acquisitions);
+        if (!acquisitions) {
+            continue;
+        }
+
+        fprintf(file, "%-20s %10lu %10lu %6lu %9.1f/%-8.1f %9.1f/%-8.1f\n",
+                iterator->name, acquisitions,
+                LOCK_LOAD(iterator->contended),
+                LOCK_LOAD(iterator->failed),
+                LOCK_LOAD(iterator->wait_ns) / 1000.0 / acquisitions,
+                LOCK_LOAD(iterator->max_wait_ns) / 1000.0,
+                LOCK_LOAD(iterator->hold_ns) / 1000.0 / acquisitions,
+                LOCK_LOAD(iterator->max_hold_ns) / 1000.0);
+        _lockReportHist(file, "wait", iterator->wait_hist);
+        _lockReportHist(file, "hold", iterator->hold_hist);
+    }
+}
+
+void gfxUtilLockStatsReset(void)
+{
+    gfx_lock_stats_t *iterator =
+        __atomic_load_n(&lock_stats_list, __ATOMIC_ACQUIRE);
+    unsigned int i;
+
+    for (; iterator; iterator = iterator->next) {
+        __atomic_store_n(&iterator->acquisitions, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&iterator->contended, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&iterator->failed, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&iterator->wait_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&iterator->max_wait_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&iterator->hold_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&iterator->max_hold_ns, 0, __ATOMIC_RELAXED);
+        for (i = 0; i < GFX_LOCK_HIST_BUCKETS; i++) {
+            __atomic_store_n(&iterator->wait_hist[i], 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&iterator->hold_hist[i], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static struct mem_stats {
+    size_t bytes[GFX_MEM_CATEGORY_COUNT];
+    size_t peak[GFX_MEM_CATEGORY_COUNT];
+} mem_stats = { 0 };
+
+static const char *mem_category_names[GFX_MEM_CATEGORY_COUNT] = {
+    [GFX_MEM_TEXTURES] = "textures",
+    [GFX_MEM_SURFACES] = "surfaces",
+    [GFX_MEM_FONTS] = "fonts",
+    [GFX_MEM_SAMPLES] = "samples",
+    [GFX_MEM_JOBS] = "jobs",
+};
+
+void gfxUtilMemAdd(enum gfx_mem_category category, size_t bytes)
+{
+    size_t now = __atomic_add_fetch(&mem_stats.bytes[category], bytes,
+                                    __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&mem_stats.peak[category],
+                                  __ATOMIC_RELAXED);
+
+    while (now > peak &&
+           !__atomic_compare_exchange_n(&mem_stats.peak[category], &peak,
+                                        now, 1, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+        ;
+}
+
+void gfxUtilMemSub(enum gfx_mem_category category, size_t bytes)
+{
+    __atomic_sub_fetch(&mem_stats.bytes[category], bytes, __ATOMIC_RELAXED);
+}
+
+size_t gfxUtilMemTotal(void)
+{
+    size_t ret = 0;
+    unsigned int i;
+
+    for (i = 0; i < GFX_MEM_CATEGORY_COUNT; i++) {
+        ret += __atomic_load_n(&mem_stats.bytes[i], __ATOMIC_RELAXED);
+    }
+
+    return ret;
+}
+
+void gfxUtilMemStatsGet(gfx_mem_stats_t *stats)
+{
+    unsigned int i;
+
+    stats->total = 0;
+
+    for (i = 0; i < GFX_MEM_CATEGORY_COUNT; i++) {
+        stats->bytes[i] =
+            __atomic_load_n(&mem_stats.bytes[i], __ATOMIC_RELAXED);
+        stats->peak[i] = __atomic_load_n(&mem_stats.peak[i], __ATOMIC_RELAXED);
+        stats->total += stats->bytes[i];
+    }
+}
+
+void gfxUtilMemStatsReport(FILE *file)
+{
+    gfx_mem_stats_t stats;
+    unsigned int i;
+
+    gfxUtilMemStatsGet(&stats);
+
+    fprintf(file, "%-20s %12s %12s\n", "MEMORY", "KiB", "PEAK KiB");
+
+    for (i = 0; i < GFX_MEM_CATEGORY_COUNT; i++)
+        fprintf(file, "%-20s %12.1f %12.1f\n", mem_category_names[i],
+                stats.bytes[i] / 1024.0, stats.peak[i] / 1024.0);
+
+    fprintf(file, "%-20s %12.1f\n", "total", stats.total / 1024.0);
+}
+
+// Startup profiling
+//
+// Phases claim a slot with an atomic counter and only ever write their own
+// slot, publishing it once filled in. Threads are numbered in the order they
+// record their first phase.
+
+static struct init_phases {
+    struct init_phase {
+        const char *name;
+        unsigned int thread;
+        unsigned long long start;
+        unsigned long long end;
+        unsigned char published; // name, thread and start are set
+    } phases[GFX_INIT_PHASES_MAX];
+    unsigned int count;
+    unsigned int threads;
+} init_phases = { 0 };
+
+static __thread unsigned int init_thread = 0;
+
+int gfxUtilInitPhaseBegin(const char *name)
+{
+    unsigned int phase = __atomic_fetch_add(&init_phases.count, 1,
+                                            __ATOMIC_RELAXED);
+
+    if (phase >= GFX_INIT_PHASES_MAX) {
+        return -1;
+    }
+
+    if (!init_thread) {
+        init_thread = __atomic_add_fetch(&init_phases.threads, 1,
+                                         __ATOMIC_RELAXED);
+    }
+
+    init_phases.phases[phase].name = name;
+    init_phases.phases[phase].thread = init_thread - 1;
+    init_phases.phases[phase].start = _lockClockNs();
+    __atomic_store_n(&init_phases.phases[phase].published, 1,
+                     __ATOMIC_RELEASE);
+
+    return phase;
+}
+
+void gfxUtilInitPhaseEnd(int phase)
+{
+    if (phase >= 0) {
+        __atomic_store_n(&init_phases.phases[phase].end, _lockClockNs(),
+                         __ATOMIC_RELEASE);
+    }
+}
+
+void gfxUtilInitReport(FILE *file)
+{
+    unsigned int count = __atomic_load_n(&init_phases.count,
+                                         __ATOMIC_RELAXED);
+    unsigned long long first = 0, last = 0, sum = 0, end;
+    unsigned char published[GFX_INIT_PHASES_MAX];
+    struct init_phase *phase;
+    unsigned int i;
+
+    if (count > GFX_INIT_PHASES_MAX) {
+        count = GFX_INIT_PHASES_MAX;
+    }
+
+    fprintf(file, "%-20s %6s %10s %10s\n", "INIT PHASE", "THREAD",
+            "START ms", "TIME ms");
+
+    // Slots claimed by phases still being begun are skipped, the same slots
+    // in both passes such that no phase starts before the first
+    for (i = 0; i < count; i++) {
+        phase = &init_phases.phases[i];
+        published[i] = __atomic_load_n(&phase->published, __ATOMIC_ACQUIRE);
+        if (published[i] && (!first || phase->start < first)) {
+            first = phase->start;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        phase = &init_phases.phases[i];
+        if (!published[i]) {
+            continue;
+        }
+        end = __atomic_load_n(&phase->end, __ATOMIC_ACQUIRE);
+
+        if (!end) {
+            fprintf(file, "%-20s %6u %10.1f %10s\n", phase->name,
+                    phase->thread, (phase->start - first) / 1e6,
+                    "running");
+            continue;
+        }
+
+        fprintf(file, "%-20s %6u %10.1f %10.1f\n", phase->name, phase->thread,
+                (phase->start - first) / 1e6, (end - phase->start) / 1e6);
+
+        sum += end - phase->start;
+        if (end > last) {
+            last = end;
+        }
+    }
+
+    fprintf(file, "%-20s %6s %10s %10.1f\n", "wall clock", "", "",
+            last ? (last - first) / 1e6 : 0.0);
+    fprintf(file, "%-20s %6s %10s %10.1f\n", "sum of phases", "", "",
+            sum / 1e6);
+}
+
+char *gfxUtilPrependPath(const char *path, char *file)
+{
+    char *ret = calloc(1, sizeof(char) * (strlen(path) + strlen(file) + 2));
+    if (!ret) {
+        fprintf(stderr, "[ERROR] prepend_bin_path malloc failed\n");
+        return NULL;
+    }
+
+    strcpy(ret, path);
+    strcat(ret, file);
+
+    return ret;
+}
+
+char *gfxUtilGetBinFolderPath(char *bin_path)
+{
+    char *dir_name = dirname(bin_path);
+
+    char *ret = calloc(1, sizeof(char) * (strlen(dir_name) + 1));
+    assert(ret);
+
+    strcpy(ret, dir_name);
+
+    return ret;
+}
+
+#define INCLUDE_DIR_NAMES 0b1
+
+/**
+ * @brief Finds and returns the full path of a file searched for in a target
+ * directory and its sub-directories
+ *
+ * The found filename is stored in a statically allocated buffer and can be
+ * overwritten by subsequent calls to the functions
+ *
+ * @param dir_name Target root directory to be searched
+ * @param filename The file that is to be searched for
+ * @return A reference to the statically allocated buffer where the filename
+ * is being stored, else NULL
+ */
+static char *_recurseDirName(const char *dir_name, char *filename, char flags)
+{
+    char *ret = NULL;
+    struct dirent *dirp;
+    DIR *dp;
+    static char wdir[PATH_MAX];
+    char path[PATH_MAX];
+    dp = opendir(dir_name);
+
+    if (dp == NULL) {
+        PRINT_ERROR(
+            "Could not open resource directory '%s'", RESOURCES_DIRECTORY);
+        goto err;
+    }
+
+    while ((dirp = readdir(dp)) != NULL) {
+        switch (dirp->d_type) {
+            case DT_DIR:
+                if (!strcmp(dirp->d_name, ".") || !strcmp(dirp->d_name, "..")) {
+                    continue;
+                }
+                if (flags & INCLUDE_DIR_NAMES)
+                    if (!strcmp(filename, dirp->d_name)) {
+                        goto found;
+                    }
+                snprintf(path, PATH_MAX, "%s/%s", dir_name, dirp->d_name);
+                ret = _recurseDirName(path, filename, flags);
+                if (ret) {
+                    closedir(dp);
+                    return ret;
+                }
+                break;
+            case DT_REG:
+                if (!strcmp(filename, dirp->d_name)) {
+found:
+                    snprintf(wdir, PATH_MAX, "%s/%s", dir_name, filename);
+                    closedir(dp);
+                    return wdir;
+                }
+                break;
+            default:
+                printf("Found file of type %d", dirp->d_type);
+                break;
+        }
+    }
+    closedir(dp);
+    return ret;
+
+err:
+    return NULL;
+}
+
+// Resource index
+//
+// The resource directory is searched for and indexed once, by whichever
+// thread first looks up a resource. The index is sorted by file name and
+// never modified afterwards so it is read without locking. Files that are
+// not in the index, eg. as they were created later, are searched for on
+// disk and remembered in a list of late entries.
+
+struct resource_entry {
+    char *name;
+    char *path;
+    size_t order; // Keeps the first file found first among equal names
+    struct resource_entry *next; // Late entries only
+};
+
+static struct resource_index {
+    pthread_once_t once;
+    char dir[PATH_MAX];
+    struct resource_entry *entries;
+    size_t count;
+    size_t size;
+    struct resource_entry *late;
+    pthread_mutex_t late_lock;
+} resource_index = { .once = PTHREAD_ONCE_INIT,
+                     .late_lock = PTHREAD_MUTEX_INITIALIZER
+                   };
+
+static int _indexResourceFile(const char *dir_name, const char *filename)
+{
+    struct resource_entry *entry;
+    char *path;
+
+    if (resource_index.count == resource_index.size) {
+        size_t size = resource_index.size ? resource_index.size * 2 : 64;
+
+        entry = realloc(resource_index.entries, size * sizeof(*entry));
+        if (entry == NULL) {
+            return -1;
+        }
+        resource_index.entries = entry;
+        resource_index.size = size;
+    }
+
+    entry = &resource_index.entries[resource_index.count];
+    entry->name = strdup(filename);
+    entry->path = gfxUtilPrependPath(dir_name, "/");
+    if (entry->name == NULL || entry->path == NULL) {
+        goto err_alloc;
+    }
+
+    path = realloc(entry->path, strlen(entry->path) + strlen(filename) + 1);
+    if (path == NULL) {
+        goto err_alloc;
+    }
+    entry->path = path;
+    strcat(entry->path, filename);
+
+    entry->order = resource_index.count++;
+    entry->next = NULL;
+
+    return 0;
+
+err_alloc:
+    free(entry->name);
+    free(entry->path);
+    return -1;
+}
+
+static void _indexResourceDir(const char *dir_name)
+{
+    char path[PATH_MAX];
+    struct dirent *dirp;
+    DIR *dp;
+
+    dp = opendir(dir_name);
+    if (dp == NULL) {
+        PRINT_ERROR("Could not open resource directory '%s'", dir_name);
+        return;
+    }
+
+    while ((dirp = readdir(dp)) != NULL) {
+        switch (dirp->d_type) {
+            case DT_DIR:
+                if (!strcmp(dirp->d_name, ".") || !strcmp(dirp->d_name, "..")) {
+                    continue;
+                }
+                if (snprintf(path, PATH_MAX, "%s/%s", dir_name,
+                             dirp->d_name) < PATH_MAX) {
+                    _indexResourceDir(path);
+                }
+                break;
+            case DT_REG:
+                if (_indexResourceFile(dir_name, dirp->d_name)) {
+                    PRINT_ERROR("Failed to index resource '%s'",
+                                dirp->d_name);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    closedir(dp);
+}
+
+static int _compareResourceEntries(const void *a, const void *b)
+{
+    const struct resource_entry *entry_a = a, *entry_b = b;
+    int ret = strcmp(entry_a->name, entry_b->name);
+
+    if (ret) {
+        return ret;
+    }
+
+    return entry_a->order < entry_b->order ? -1 : 1;
+}
+
+static void _buildResourceIndex(void)
+{
+    int phase = gfxUtilInitPhaseBegin("resource index");
+    char *found;
+
+    if (access(RESOURCES_DIRECTORY, F_OK) != -1) {
+        strcpy(resource_index.dir, RESOURCES_DIRECTORY);
+    }
+    else {
+        found = _recurseDirName(".", basename(RESOURCES_DIRECTORY),
+                                INCLUDE_DIR_NAMES);
+        if (found) {
+            strcpy(resource_index.dir, found);
+        }
+    }
+
+    if (resource_index.dir[0]) {
+        _indexResourceDir(resource_index.dir);
+        qsort(resource_index.entries, resource_index.count,
+              sizeof(struct resource_entry), _compareResourceEntries);
+    }
+
+    gfxUtilInitPhaseEnd(phase);
+}
+
+static int _compareResourceName(const void *key, const void *entry)
+{
+    return strcmp(key, ((const struct resource_entry *)entry)->name);
+}
+
+static char *_lookupResource(char *resource_name)
+{
+    struct resource_entry *entry;
+    char *name = basename(resource_name);
+    char *found;
+
+    pthread_once(&resource_index.once, _buildResourceIndex);
+
+    entry = bsearch(name, resource_index.entries, resource_index.count,
+                    sizeof(struct resource_entry), _compareResourceName);
+    if (entry) {
+        while (entry > resource_index.entries &&
+               !strcmp(entry[-1].name, name)) {
+            entry--;
+        }
+        return entry->path;
+    }
+
+    pthread_mutex_lock(&resource_index.late_lock);
+
+    for (entry = resource_index.late; entry; entry = entry->next)
+        if (!strcmp(entry->name, name)) {
+            goto out;
+        }
+
+    found = _recurseDirName(resource_index.dir, name, 0);
+    if (found == NULL) {
+        goto out;
+    }
+
+    entry = calloc(1, sizeof(struct resource_entry));
+    if (entry == NULL) {
+        goto out;
+    }
+
+    entry->name = strdup(name);
+    entry->path = strdup(found);
+    if (entry->name == NULL || entry->path == NULL) {
+        free(entry->name);
+        free(entry->path);
+        free(entry);
+        entry = NULL;
+        goto out;
+    }
+
+    entry->next = resource_index.late;
+    resource_index.late = entry;
+
+out:
+    pthread_mutex_unlock(&resource_index.late_lock);
+
+    return entry ? entry->path : NULL;
+}
+
+void gfxUtilIndexResources(void)
+{
+    pthread_once(&resource_index.once, _buildResourceIndex);
+}
+
+const char *gfxUtilFindResourceDirectory(void)
+{
+    pthread_once(&resource_index.once, _buildResourceIndex);
+
+    return resource_index.dir;
+}
+
+FILE *gfxUtilFindResource(char *resource_name, const char *mode)
+{
+    char *path;
+
+    if (!resource_name) {
+        PRINT_ERROR("Cannot find invalid resource name");
+        return NULL;
+    }
+    if (access(resource_name, F_OK) != -1) {
+        return fopen(resource_name, mode);
+    }
+
+    path = _lookupResource(resource_name);
+
+    return path ? fopen(path, mode) : NULL;
+}
+
+char *gfxUtilFindResourcePath(char *resource_name)
+{
+    if (!resource_name) {
+        PRINT_ERROR("Cannot find invalid resource name");
+        return NULL;
+    }
+
+    if (access(resource_name, F_OK) != -1) {
+        return resource_name;
+    }
+
+    return _lookupResource(resource_name);
+}
+
+// Resource watching
+//
+// inotify watches are not recursive, every directory of the resource tree is
+// watched on its own and directories created later are added as they
+// appear. The watching thread blocks in poll() on the inotify descriptor and
+// an eventfd used to stop it, costing nothing while no files change.
+
+#define RESOURCE_WATCH_EVENTS                                                  \
+    (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+static struct resource_watch {
+    int fd;
+    int stop_fd;
+    pthread_t thread;
+    unsigned char running;
+    struct watched_dir {
+        int wd;
+        char *path;
+    } *dirs;
+    size_t dir_count;
+    size_t dir_size;
+    void (*listeners[GFX_RESOURCE_LISTENERS_MAX])(const char *name,
+            const char *path);
+    unsigned int listener_count;
+    pthread_mutex_t lock;
+} resource_watch = { .fd = -1,
+                     .stop_fd = -1,
+                     .lock = PTHREAD_MUTEX_INITIALIZER
+                   };
+
+static void _watchResourceDir(const char *dir_name)
+{
+    struct watched_dir *dir;
+    char path[PATH_MAX];
+    struct dirent *dirp;
+    DIR *dp;
+    int wd;
+
+    wd = inotify_add_watch(resource_watch.fd, dir_name,
+                           RESOURCE_WATCH_EVENTS);
+    if (wd < 0) {
+        PRINT_ERROR("Could not watch directory '%s'", dir_name);
+        return;
+    }
+
+    if (resource_watch.dir_count == resource_watch.dir_size) {
+        size_t size = resource_watch.dir_size ? resource_watch.dir_size * 2
+                      : 16;
+
+        dir = realloc(resource_watch.dirs, size * sizeof(*dir));
+        if (dir == NULL) {
+            goto err_alloc;
+        }
+        resource_watch.dirs = dir;
+        resource_watch.dir_size = size;
+    }
+
+    dir = &resource_watch.dirs[resource_watch.dir_count];
+    dir->wd = wd;
+    dir->path = strdup(dir_name);
+    if (dir->path == NULL) {
+        goto err_alloc;
+    }
+    resource_watch.dir_count++;
+
+    dp = opendir(dir_name);
+    if (dp == NULL) {
+        return;
+    }
+
+    while ((dirp = readdir(dp)) != NULL)
+        if (dirp->d_type == DT_DIR && strcmp(dirp->d_name, ".") &&
+            strcmp(dirp->d_name, "..") &&
+            snprintf(path, PATH_MAX, "%s/%s", dir_name, dirp->d_name) <
+            PATH_MAX) {
+            _watchResourceDir(path);
+        }
+
+    closedir(dp);
+
+    return;
+
+err_alloc:
+    inotify_rm_watch(resource_watch.fd, wd);
+    PRINT_ERROR("Failed to allocate watch of directory '%s'", dir_name);
+}
+
+static const char *_watchedDirPath(int wd)
+{
+    size_t i;
+
+    for (i = 0; i < resource_watch.dir_count; i++)
+        if (resource_watch.dirs[i].wd == wd) {
+            return resource_watch.dirs[i].path;
+        }
+
+    return NULL;
+}
+
+static void _resourceChanged(const struct inotify_event *event)
+{
+    char path[PATH_MAX];
+    const char *dir;
+    unsigned int i;
+
+    dir = _watchedDirPath(event->wd);
+    if (dir == NULL ||
+        snprintf(path, PATH_MAX, "%s/%s", dir, event->name) >= PATH_MAX) {
+        return;
+    }
+
+    if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            _watchResourceDir(path);
+        }
+        return;
+    }
+
+    // Files are only complete once written and closed, or moved into place
+    if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) {
+        return;
+    }
+
+    pthread_mutex_lock(&resource_watch.lock);
+    for (i = 0; i < resource_watch.listener_count; i++) {
+        resource_watch.listeners[i](event->name, path);
+    }
+    pthread_mutex_unlock(&resource_watch.lock);
+}
+
+static void *_watchResources(void *arg)
+{
+    char buf[4096]
+    __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd fds[2] = { { .fd = resource_watch.fd, .events = POLLIN },
+        { .fd = resource_watch.stop_fd, .events = POLLIN }
+    };
+    const struct inotify_event *event;
+    ssize_t len;
+    char *ptr;
+
+    (void)arg;
+
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[1].revents) {
+            break;
+        }
+
+        len = read(resource_watch.fd, buf, sizeof(buf));
+        if (len <= 0) {
+            if (len < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            break;
+        }
+
+        for (ptr = buf; ptr < buf + len;
+             ptr += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event *)ptr;
+            if (event->len) {
+                _resourceChanged(event);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int gfxUtilAddResourceListener(void (*changed)(const char *name,
+                               const char *path))
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&resource_watch.lock);
+
+    if (resource_watch.listener_count == GFX_RESOURCE_LISTENERS_MAX) {
+        PRINT_ERROR("Only %d resource listeners can be added",
+                    GFX_RESOURCE_LISTENERS_MAX);
+        ret = -1;
+    }
+    else {
+        resource_watch.listeners[resource_watch.listener_count++] = changed;
+    }
+
+    pthread_mutex_unlock(&resource_watch.lock);
+
+    return ret;
+}
+
+int gfxUtilWatchResources(void)
+{
+    const char *dir = gfxUtilFindResourceDirectory();
+
+    if (resource_watch.running) {
+        return 0;
+    }
+
+    if (!dir[0]) {
+        PRINT_ERROR("No resource directory to watch");
+        goto err_dir;
+    }
+
+    resource_watch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (resource_watch.fd < 0) {
+        PRINT_ERROR("Failed to initialise inotify");
+        goto err_inotify;
+    }
+
+    resource_watch.stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (resource_watch.stop_fd < 0) {
+        PRINT_ERROR("Failed to create eventfd");
+        goto err_eventfd;
+    }
+
+    _watchResourceDir(dir);
+
+    if (pthread_create(&resource_watch.thread, NULL, _watchResources,
+                       NULL)) {
+        PRINT_ERROR("Failed to create resource watching thread");
+        goto err_thread;
+    }
+
+    resource_watch.running = 1;
+
+    return 0;
+
+err_thread:
+    close(resource_watch.stop_fd);
+err_eventfd:
+    close(resource_watch.fd);
+err_inotify:
+    while (resource_watch.dir_count) {
+        free(resource_watch.dirs[--resource_watch.dir_count].path);
+    }
+err_dir:
+    return -1;
+}
+
+void gfxUtilUnwatchResources(void)
+{
+    uint64_t stop = 1;
+
+    if (!resource_watch.running) {
+        return;
+    }
+
+    if (write(resource_watch.stop_fd, &stop, sizeof(stop)) !=
+        sizeof(stop)) {
+        PRINT_ERROR("Failed to stop resource watching thread");
+        return;
+    }
+
+    pthread_join(resource_watch.thread, NULL);
+
+    close(resource_watch.stop_fd);
+    close(resource_watch.fd);
+
+    while (resource_watch.dir_count) {
+        free(resource_watch.dirs[--resource_watch.dir_count].path);
+    }
+
+    resource_watch.running = 0;
+}
+
+static size_t _roundUpPow2(size_t val)
+{
+    size_t ret = 1;
+
+    while (ret < val) {
+        ret <<= 1;
+    }
+
+    return ret;
+}
+
+#define SLOT(RB, POS) ((char *)(RB)->buffer + ((POS) & (RB)->mask) * (RB)->item_size)
+
+static void _initSequences(struct ring_buf *rb)
+{
+    size_t i;
+
+    if (rb->seq) {
+        for (i = 0; i < rb->size; i++) {
+            atomic_store_explicit(&rb->seq[i], i, memory_order_relaxed);
+        }
+    }
+}
+
+static struct ring_buf *_rbufCreate(size_t item_size, size_t item_count,
+                                    void *buffer, unsigned char type)
+{
+    struct ring_buf *ret = NULL;
+
+    if (!item_size || !item_count) {
+        goto err_args;
+    }
+
+    // A slot's sequence cannot tell full from free if it is the only slot
+    if (type == RBUF_TYPE_MPMC && item_count < 2) {
+        if (buffer) {
+            goto err_args;
+        }
+        item_count = 2;
+    }
+
+    // Static buffers cannot be grown to the next power of two
+    if (buffer && (item_count & (item_count - 1))) {
+        goto err_args;
+    }
+
+    if (posix_memalign((void **)&ret, RBUF_CACHE_LINE_SIZE,
+                       sizeof(struct ring_buf))) {
+        goto err_alloc_rbuf;
+    }
+
+    memset(ret, 0, sizeof(struct ring_buf));
+
+    ret->size = _roundUpPow2(item_count);
+    ret->mask = ret->size - 1;
+    ret->item_size = item_size;
+    ret->type = type;
+
+    if (buffer) {
+        ret->buffer = buffer;
+        ret->static_buffer = 1;
+    }
+    else {
+        ret->buffer = calloc(ret->size, item_size);
+        if (ret->buffer == NULL) {
+            goto err_alloc_buffer;
+        }
+    }
+
+    if (type == RBUF_TYPE_MPMC) {
+        ret->seq = calloc(ret->size, sizeof(size_t));
+        if (ret->seq == NULL) {
+            goto err_alloc_seq;
+        }
+        _initSequences(ret);
+    }
+
+    atomic_init(&ret->head, 0);
+    atomic_init(&ret->tail, 0);
+
+    return ret;
+
+err_alloc_seq:
+    if (!ret->static_buffer) {
+        free(ret->buffer);
+    }
+err_alloc_buffer:
+    free(ret);
+err_alloc_rbuf:
+err_args:
+    return NULL;
+}
+
+rbuf_handle_t gfxRbufInit(size_t item_size, size_t item_count)
+{
+    return (rbuf_handle_t)_rbufCreate(item_size, item_count, NULL,
+                                      RBUF_TYPE_MPMC);
+}
 
-    pthread_mutex_lock(&GL_thread_lock);
-    ret = (cur_GL_thread == syscall(SYS_gettid)) ? 0 : -1;
-    pthread_mutex_unlock(&GL_thread_lock);
+rbuf_handle_t gfxRbufInitStatic(
+    size_t item_size, size_t item_count, void *buffer)
+{
+    if (buffer == NULL) {
+        return NULL;
+    }
 
-    return ret;
+    return (rbuf_handle_t)_rbufCreate(item_size, item_count, buffer,
+                                      RBUF_TYPE_MPMC);
 }
 
-void gfxUtilSetGLThread(void)
+rbuf_handle_t gfxRbufInitSPSC(size_t item_size, size_t item_count)
 {
-    pthread_mutex_lock(&GL_thread_lock);
-    cur_GL_thread = syscall(SYS_gettid);
-    pthread_mutex_unlock(&GL_thread_lock);
+    return (rbuf_handle_t)_rbufCreate(item_size, item_count, NULL,
+                                      RBUF_TYPE_SPSC);
 }
 
-char *gfxUtilPrependPath(const char *path, char *file)
+rbuf_handle_t gfxRbufInitSPSCStatic(
+    size_t item_size, size_t item_count, void *buffer)
 {
-    char *ret = calloc(1, sizeof(char) * (strlen(path) + strlen(file) + 2));
-    if (!ret) {
-        fprintf(stderr, "[ERROR] prepend_bin_path malloc failed\n");
+    if (buffer == NULL) {
         return NULL;
     }
 
-    strcpy(ret, path);
-    strcat(ret, file);
-
-    return ret;
+    return (rbuf_handle_t)_rbufCreate(item_size, item_count, buffer,
+                                      RBUF_TYPE_SPSC);
 }
 
-char *gfxUtilGetBinFolderPath(char *bin_path)
+// Destroy
+void gfxRbufFree(rbuf_handle_t rbuf)
 {
-    char *dir_name = dirname(bin_path);
-
-    char *ret = calloc(1, sizeof(char) * (strlen(dir_name) + 1));
-    assert(ret);
+    if (rbuf == NULL) {
+        return;
+    }
 
-    strcpy(ret, dir_name);
+    struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    return ret;
+    if (!rb->static_buffer) {
+        free(rb->buffer);
+    }
+    free(rb->seq);
+    free(rb);
 }
 
-#define INCLUDE_DIR_NAMES 0b1
+// Reset
+void gfxRbufReset(rbuf_handle_t rbuf)
+{
+    if (rbuf == NULL) {
+        return;
+    }
+
+    struct ring_buf *rb = CAST_RBUF(rbuf);
+
+    atomic_store(&rb->head, 0);
+    atomic_store(&rb->tail, 0);
+    rb->tail_cache = 0;
+    rb->head_cache = 0;
+    _initSequences(rb);
+}
 
 /**
- * @brief Finds and returns the full path of a file searched for in a target
- * directory and its sub-directories
- *
- * The found filename is stored in a statically allocated buffer and can be
- * overwritten by subsequent calls to the functions
+ * @brief Claims up to count free slots for the producer
  *
- * @param dir_name Target root directory to be searched
- * @param filename The file that is to be searched for
- * @return A reference to the statically allocated buffer where the filename
- * is being stored, else NULL
+ * @param rb Ring buffer to be claimed from
+ * @param count Maximum number of slots wanted
+ * @param pos Reference where the position of the first claimed slot is stored
+ * @return Number of claimed slots
  */
-static char *_recurseDirName(const char *dir_name, char *filename, char flags)
+static size_t _claimProducer(struct ring_buf *rb, size_t count, size_t *pos)
 {
-    char *ret = NULL;
-    struct dirent *dirp;
-    DIR *dp;
-    static char wdir[PATH_MAX];
-    dp = opendir(dir_name);
+    size_t head, avail, i;
+    intptr_t diff = 0;
 
-    if (dp == NULL) {
-        PRINT_ERROR(
-            "Could not open resource directory '%s'", RESOURCES_DIRECTORY);
-        goto err;
+    if (rb->type == RBUF_TYPE_SPSC) {
+        head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+        avail = rb->size - (head - rb->tail_cache);
+
+        if (avail < count) {
+            rb->tail_cache =
+                atomic_load_explicit(&rb->tail, memory_order_acquire);
+            avail = rb->size - (head - rb->tail_cache);
+        }
+
+        *pos = head;
+        return (avail < count) ? avail : count;
     }
 
-    while ((dirp = readdir(dp)) != NULL) {
-        switch (dirp->d_type) {
-            case DT_DIR:
-                if (!strcmp(dirp->d_name, ".") || !strcmp(dirp->d_name, "..")) {
-                    continue;
-                }
-                if (flags & INCLUDE_DIR_NAMES)
-                    if (!strcmp(filename, dirp->d_name)) {
-                        goto found;
-                    }
-                strcpy(wdir, dir_name);
-                strcat(wdir, "/");
-                strcat(wdir, dirp->d_name);
-                ret = _recurseDirName(wdir, filename, flags);
-                if (ret) {
-                    return ret;
-                }
-                break;
-            case DT_REG:
-                if (!strcmp(filename, dirp->d_name)) {
-found:
-                    strcpy(wdir, dir_name);
-                    strcat(wdir, "/");
-                    strcat(wdir, filename);
-                    return wdir;
-                }
-                break;
-            default:
-                printf("Found file of type %d", dirp->d_type);
+    head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+
+    while (1) {
+        for (i = 0; i < count; i++) {
+            diff = (intptr_t)atomic_load_explicit(
+                       &rb->seq[(head + i) & rb->mask],
+                       memory_order_acquire) -
+                   (intptr_t)(head + i);
+            if (diff) {
                 break;
+            }
         }
-    }
-    return ret;
 
-err:
-    return NULL;
+        if (i) {
+            // Slots free at head cannot be taken while head is unchanged
+            if (atomic_compare_exchange_weak_explicit(
+                    &rb->head, &head, head + i, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                *pos = head;
+                return i;
+            }
+        }
+        else if (diff < 0) {
+            return 0; // Full
+        }
+        else {
+            head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+        }
+    }
 }
 
-static FILE *_recurseDirFile(
-    const char *dir_name, char *filename, const char *mode)
+/**
+ * @brief Publishes count slots, starting at pos, to the consumer
+ */
+static void _commitProducer(struct ring_buf *rb, size_t pos, size_t count)
 {
-    return fopen(_recurseDirName(dir_name, filename, 0), mode);
+    size_t i;
+
+    if (rb->type == RBUF_TYPE_SPSC) {
+        atomic_store_explicit(&rb->head, pos + count, memory_order_release);
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+        atomic_store_explicit(&rb->seq[(pos + i) & rb->mask], pos + i + 1,
+                              memory_order_release);
 }
 
-const char *gfxUtilFindResourceDirectory(void)
+/**
+ * @brief Claims up to count stored slots for the consumer
+ */
+static size_t _claimConsumer(struct ring_buf *rb, size_t count, size_t *pos)
 {
-    static char ret_dir[PATH_MAX];
+    size_t tail, avail, i;
+    intptr_t diff = 0;
 
-    if (access(RESOURCES_DIRECTORY, F_OK) != -1) {
-        strcpy(ret_dir, RESOURCES_DIRECTORY);
-        return ret_dir;
+    if (rb->type == RBUF_TYPE_SPSC) {
+        tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+        avail = rb->head_cache - tail;
+
+        if (avail < count) {
+            rb->head_cache =
+                atomic_load_explicit(&rb->head, memory_order_acquire);
+            avail = rb->head_cache - tail;
+        }
+
+        *pos = tail;
+        return (avail < count) ? avail : count;
     }
-    else {
-        strcpy(ret_dir,
-               _recurseDirName(
-                   ".", basename(RESOURCES_DIRECTORY), INCLUDE_DIR_NAMES));
-        return ret_dir;
+
+    tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+
+    while (1) {
+        for (i = 0; i < count; i++) {
+            diff = (intptr_t)atomic_load_explicit(
+                       &rb->seq[(tail + i) & rb->mask],
+                       memory_order_acquire) -
+                   (intptr_t)(tail + i + 1);
+            if (diff) {
+                break;
+            }
+        }
+
+        if (i) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &rb->tail, &tail, tail + i, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                *pos = tail;
+                return i;
+            }
+        }
+        else if (diff < 0) {
+            return 0; // Empty
+        }
+        else {
+            tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+        }
     }
 }
 
-FILE *gfxUtilFindResource(char *resource_name, const char *mode)
+/**
+ * @brief Returns count consumed slots, starting at pos, to the producer
+ */
+static void _releaseConsumer(struct ring_buf *rb, size_t pos, size_t count)
 {
-    if (!resource_name) {
-        PRINT_ERROR("Cannot find invalid resource name");
-        return NULL;
-    }
-    if (access(resource_name, F_OK) != -1) {
-        return fopen(resource_name, mode);
+    size_t i;
+
+    if (rb->type == RBUF_TYPE_SPSC) {
+        atomic_store_explicit(&rb->tail, pos + count, memory_order_release);
+        return;
     }
-    else
-        return _recurseDirFile(
-                   gfxUtilFindResourceDirectory(), basename(resource_name), mode);
+
+    for (i = 0; i < count; i++)
+        atomic_store_explicit(&rb->seq[(pos + i) & rb->mask],
+                              pos + i + rb->size, memory_order_release);
 }
 
-char *gfxUtilFindResourcePath(char *resource_name)
+static void _fillSpans(struct ring_buf *rb, size_t pos, size_t count,
+                       rbuf_span_t spans[2])
 {
-    if (!resource_name) {
-        PRINT_ERROR("Cannot find invalid resource name");
-        return NULL;
-    }
+    size_t first = rb->size - (pos & rb->mask);
 
-    if (access(resource_name, F_OK) != -1) {
-        return resource_name;
+    if (first > count) {
+        first = count;
     }
-    else
-        return _recurseDirName(
-                   gfxUtilFindResourceDirectory(), basename(resource_name), 0);
+
+    spans[0].data = count ? SLOT(rb, pos) : NULL;
+    spans[0].count = first;
+    spans[1].data = (count - first) ? rb->buffer : NULL;
+    spans[1].count = count - first;
 }
 
-static void _inc_buf(rbuf_handle_t rbuf)
+/**
+ * @brief Copies count items between a linear array and the ring buffer's
+ * slots starting at pos, splitting the copy at the buffer's wrap around
+ */
+static void _copySlots(struct ring_buf *rb, size_t pos, size_t count,
+                       void *data, unsigned char to_ring)
 {
-    if (rbuf == NULL) {
-        return;
-    }
-
-    struct ring_buf *rb = CAST_RBUF(rbuf);
+    rbuf_span_t spans[2];
+    size_t first_len;
 
-    if (rb->full) {
-        rb->tail += 1;
-        rb->tail %= rb->size;
+    _fillSpans(rb, pos, count, spans);
+    first_len = spans[0].count * rb->item_size;
 
-        rb->head = rb->tail;
+    if (to_ring) {
+        memcpy(spans[0].data, data, first_len);
+        if (spans[1].count) {
+            memcpy(spans[1].data, (char *)data + first_len,
+                   spans[1].count * rb->item_size);
+        }
     }
     else {
-        rb->head += 1;
-        rb->head %= rb->size;
+        memcpy(data, spans[0].data, first_len);
+        if (spans[1].count) {
+            memcpy((char *)data + first_len, spans[1].data,
+                   spans[1].count * rb->item_size);
+        }
     }
-
-    rb->full = (rb->head == rb->tail);
 }
 
-static void _dec_buf(rbuf_handle_t rbuf)
+size_t gfxRbufReserve(rbuf_handle_t rbuf, size_t count,
+                      rbuf_reservation_t *reservation)
 {
-    if (rbuf == NULL) {
-        return;
+    if (rbuf == NULL || reservation == NULL || !count) {
+        return 0;
     }
 
     struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    rb->full = 0;
-    rb->tail += 1;
-    rb->tail %= rb->size;
+    reservation->count = _claimProducer(rb, count, &reservation->pos);
+    _fillSpans(rb, reservation->pos, reservation->count,
+               reservation->spans);
+
+    return reservation->count;
 }
 
-rbuf_handle_t gfxRbufInit(size_t item_size, size_t item_count)
+int gfxRbufCommit(rbuf_handle_t rbuf, rbuf_reservation_t *reservation,
+                  size_t count)
 {
-    struct ring_buf *ret = (struct ring_buf *)calloc(1, sizeof(struct ring_buf));
-
-    if (ret == NULL) {
-        goto err_alloc_rbuf;
+    if (rbuf == NULL || reservation == NULL) {
+        return -1;
     }
 
-    ret->buffer = calloc(item_count, item_size);
+    struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    if (ret->buffer == NULL) {
-        goto err_alloc_buffer;
+    if (count > reservation->count) {
+        return -1;
     }
 
-    ret->head = 0;
-    ret->tail = 0;
-    ret->size = item_count;
-    ret->item_size = item_size;
+    _commitProducer(rb, reservation->pos, count);
 
-    return (rbuf_handle_t)ret;
+    // Whatever was not committed stays reserved for a following commit
+    reservation->pos += count;
+    reservation->count -= count;
+    _fillSpans(rb, reservation->pos, reservation->count,
+               reservation->spans);
 
-err_alloc_buffer:
-    free(ret);
-err_alloc_rbuf:
-    return NULL;
+    return 0;
 }
 
-rbuf_handle_t gfxRbufInitStatic(
-    size_t item_size, size_t item_count, void *buffer)
+size_t gfxRbufPeek(rbuf_handle_t rbuf, size_t count, rbuf_span_t spans[2])
 {
-    if (buffer == NULL) {
-        goto err_buffer;
-    }
-
-    struct ring_buf *ret = (struct ring_buf *)calloc(1, sizeof(struct ring_buf));
+    size_t tail, avail;
 
-    if (ret == NULL) {
-        goto err_alloc_rbuf;
+    if (rbuf == NULL || spans == NULL) {
+        return 0;
     }
 
-    ret->head = 0;
-    ret->tail = 0;
-    ret->buffer = buffer;
-    ret->size = item_count;
-    ret->item_size = item_size;
+    struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    return (rbuf_handle_t)ret;
+    tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
 
-err_alloc_rbuf:
-err_buffer:
-    return NULL;
-}
+    if (rb->type == RBUF_TYPE_SPSC) {
+        avail = atomic_load_explicit(&rb->head, memory_order_acquire) -
+                tail;
+    }
+    else
+        for (avail = 0; avail < count && avail < rb->size; avail++)
+            if (atomic_load_explicit(&rb->seq[(tail + avail) & rb->mask],
+                                     memory_order_acquire) !=
+                tail + avail + 1) {
+                break;
+            }
 
-// Destroy
-void gfxRbufFree(rbuf_handle_t rbuf)
-{
-    if (rbuf == NULL) {
-        return;
+    if (avail > count) {
+        avail = count;
     }
 
-    free(CAST_RBUF(rbuf)->buffer);
-    free(CAST_RBUF(rbuf));
+    _fillSpans(rb, tail, avail, spans);
+
+    return avail;
 }
 
-// Reset
-void gfxRbufReset(rbuf_handle_t rbuf)
+int gfxRbufRelease(rbuf_handle_t rbuf, size_t count)
 {
+    size_t tail;
+
     if (rbuf == NULL) {
-        return;
+        return -1;
     }
 
     struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    rb->head = 0;
-    rb->tail = 0;
-    rb->full = 0;
-}
-
-// Put pointer to buffer back
-// Works the same as get, using references already put could result in undefined
-// behaviour
-int gfxRbufPutBuffer(rbuf_handle_t rbuf)
-{
-    if (rbuf == NULL) {
+    if (count > gfxRbufSize(rb)) {
         return -1;
     }
 
-    struct ring_buf *rb = CAST_RBUF(rbuf);
+    tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+
+    if (rb->type == RBUF_TYPE_MPMC) {
+        atomic_store_explicit(&rb->tail, tail + count,
+                              memory_order_relaxed);
+    }
 
-    _dec_buf(rb);
+    _releaseConsumer(rb, tail, count);
 
     return 0;
 }
 
-// Add data
-int gfxRbufPut(rbuf_handle_t rbuf, void *data)
+// Commit a slot that was filled in place
+int gfxRbufPutBuffer(rbuf_handle_t rbuf, void *buffer)
 {
-    if (rbuf == NULL) {
+    if (rbuf == NULL || buffer == NULL) {
         return -1;
     }
 
     struct ring_buf *rb = CAST_RBUF(rbuf);
+    size_t slot = ((char *)buffer - (char *)rb->buffer) / rb->item_size;
 
-    if (rb->buffer == NULL) {
-        return -1;
-    }
-
-    if (rb->full) {
-        return -1;
+    if (rb->type == RBUF_TYPE_SPSC) {
+        _commitProducer(rb,
+                        atomic_load_explicit(&rb->head,
+                                             memory_order_relaxed), 1);
+        return 0;
     }
 
-    memcpy(rb->buffer + rb->head *rb->item_size, data, rb->item_size);
-
-    _inc_buf(rb);
+    // A claimed slot's sequence still holds the claimed position
+    _commitProducer(rb,
+                    atomic_load_explicit(&rb->seq[slot],
+                                         memory_order_relaxed), 1);
 
     return 0;
 }
 
+// Add data
+int gfxRbufPut(rbuf_handle_t rbuf, void *data)
+{
+    return (gfxRbufPutBatch(rbuf, data, 1) == 1) ? 0 : -1;
+}
+
 // Add and overwrite
 int gfxRbufFPut(rbuf_handle_t rbuf, void *data)
 {
@@ -379,71 +1600,132 @@ int gfxRbufFPut(rbuf_handle_t rbuf, void *data)
         return -1;
     }
 
-    struct ring_buf *rb = CAST_RBUF(rbuf);
+    // Drop the oldest items until there is space
+    while (gfxRbufPut(rbuf, data))
+        if (gfxRbufGet(rbuf, NULL) && gfxRbufFull(rbuf)) {
+            return -1;
+        }
 
-    if (rb->buffer == NULL) {
-        return -1;
+    return 0;
+}
+
+size_t gfxRbufPutBatch(rbuf_handle_t rbuf, void *data, size_t count)
+{
+    size_t pos, claimed;
+
+    if (rbuf == NULL || data == NULL || !count) {
+        return 0;
     }
 
-    memcpy(rb->buffer + rb->head *rb->item_size, data, rb->item_size);
+    struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    _inc_buf(rb);
+    claimed = _claimProducer(rb, count, &pos);
+    if (claimed) {
+        _copySlots(rb, pos, claimed, data, 1);
+        _commitProducer(rb, pos, claimed);
+    }
 
-    return 0;
+    return claimed;
 }
 
 // Get pointer to buffer slot
-// Works similar to put except it just returns a pointer to the ringbuf slot
+// Claims the next free slot for the caller to fill in place, the slot is only
+// visible to consumers once returned using gfxRbufPutBuffer
 void *gfxRbufGetBuffer(rbuf_handle_t rbuf)
 {
-    static const _Atomic int increment = 1;
+    size_t pos;
+
     if (rbuf == NULL) {
         return NULL;
     }
 
     struct ring_buf *rb = CAST_RBUF(rbuf);
-    void *ret;
 
-    if (rb->buffer == NULL) {
+    if (!_claimProducer(rb, 1, &pos)) {
         return NULL;
     }
 
-    if (rb->full) {
+    return SLOT(rb, pos);
+}
+
+// Get pointer to a stored slot without consuming it
+void *gfxRbufPeekBuffer(rbuf_handle_t rbuf, size_t offset)
+{
+    size_t pos;
+
+    if (rbuf == NULL) {
         return NULL;
     }
 
-    int offset = __sync_fetch_and_add((int *)&rb->head, increment);
+    struct ring_buf *rb = CAST_RBUF(rbuf);
+
+    pos = atomic_load_explicit(&rb->tail, memory_order_relaxed) + offset;
+
+    if (rb->type == RBUF_TYPE_SPSC) {
+        if (offset >= atomic_load_explicit(&rb->head, memory_order_acquire) -
+            (pos - offset)) {
+            return NULL;
+        }
+        return SLOT(rb, pos);
+    }
 
-    ret = rb->buffer + offset * rb->item_size;
+    if (atomic_load_explicit(&rb->seq[pos & rb->mask],
+                             memory_order_acquire) != pos + 1) {
+        return NULL;
+    }
 
-    _inc_buf(rb);
+    return SLOT(rb, pos);
+}
 
-    return ret;
+// Consume slots previously peeked
+int gfxRbufReleaseBuffer(rbuf_handle_t rbuf, size_t count)
+{
+    return gfxRbufRelease(rbuf, count);
 }
 
 // Get data
 int gfxRbufGet(rbuf_handle_t rbuf, void *data)
 {
+    size_t pos;
+
     if (rbuf == NULL) {
         return -1;
     }
 
     struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    if (rb->buffer == NULL) {
+    if (!_claimConsumer(rb, 1, &pos)) {
         return -1;
     }
 
-    if (gfxRbufEmpty(rb)) {
-        return -1;
+    if (data) {
+        memcpy(data, SLOT(rb, pos), rb->item_size);
     }
 
-    memcpy(data, rb->buffer + rb->tail *rb->item_size, rb->item_size);
-    _dec_buf(rb);
+    _releaseConsumer(rb, pos, 1);
 
     return 0;
 }
 
+size_t gfxRbufGetBatch(rbuf_handle_t rbuf, void *data, size_t count)
+{
+    size_t pos, claimed;
+
+    if (rbuf == NULL || data == NULL || !count) {
+        return 0;
+    }
+
+    struct ring_buf *rb = CAST_RBUF(rbuf);
+
+    claimed = _claimConsumer(rb, count, &pos);
+    if (claimed) {
+        _copySlots(rb, pos, claimed, data, 0);
+        _releaseConsumer(rb, pos, claimed);
+    }
+
+    return claimed;
+}
+
 // Check empty or full
 unsigned char gfxRbufEmpty(rbuf_handle_t rbuf)
 {
@@ -451,9 +1733,7 @@ unsigned char gfxRbufEmpty(rbuf_handle_t rbuf)
         return -1;
     }
 
-    struct ring_buf *rb = CAST_RBUF(rbuf);
-
-    return (!rb->full) && (rb->head == rb->tail);
+    return gfxRbufSize(rbuf) == 0;
 }
 
 unsigned char gfxRbufFull(rbuf_handle_t rbuf)
@@ -462,9 +1742,7 @@ unsigned char gfxRbufFull(rbuf_handle_t rbuf)
         return -1;
     }
 
-    struct ring_buf *rb = CAST_RBUF(rbuf);
-
-    return rb->full;
+    return gfxRbufSize(rbuf) >= CAST_RBUF(rbuf)->size;
 }
 
 // Num of elements
@@ -476,16 +1754,15 @@ size_t gfxRbufSize(rbuf_handle_t rbuf)
 
     struct ring_buf *rb = CAST_RBUF(rbuf);
 
-    ssize_t ret = rb->size;
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
 
-    if (!rb->full) {
-        ret = rb->head - rb->tail;
-        if (rb->tail > rb->head) {
-            ret += rb->size;
-        }
+    // Tail can be read before a racing consumer moves it past head
+    if ((intptr_t)(head - tail) < 0) {
+        return 0;
     }
 
-    return (size_t)ret;
+    return (head - tail > rb->size) ? rb->size : head - tail;
 }
 
 // Get max capacity
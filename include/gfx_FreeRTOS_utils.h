@@ -24,6 +24,9 @@
 #ifndef __GFX_FREERTOS_UTILS_H__
 #define __GFX_FREERTOS_UTILS_H__
 
+#include <stddef.h>
+#include <stdio.h>
+
 /**
  * @defgroup gfx_freertos_utils GFX FreeRTOS Utils API
  *
@@ -47,5 +50,140 @@ void gfxFUtilPrintTaskStateList(void);
  */
 void gfxFUtilPrintTaskUtils(void);
 
+/**
+ * @name Task profiler configuration default values
+ *
+ * The task profiler periodically samples the FreeRTOS run time statistics,
+ * requiring configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY, and
+ * stores the CPU share each task had during each sampling interval along with
+ * each task's stack high water mark and the FreeRTOS heap usage.
+ *
+ * @{
+ */
+#ifndef FUTIL_PROFILER_MAX_TASKS
+#define FUTIL_PROFILER_MAX_TASKS 32
+#endif // FUTIL_PROFILER_MAX_TASKS
+#ifndef FUTIL_PROFILER_TASK_NAME_LEN
+#define FUTIL_PROFILER_TASK_NAME_LEN 16
+#endif // FUTIL_PROFILER_TASK_NAME_LEN
+#ifndef FUTIL_PROFILER_STACK_SIZE
+#define FUTIL_PROFILER_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
+#endif // FUTIL_PROFILER_STACK_SIZE
+#ifndef FUTIL_PROFILER_HEAP_STATS
+#define FUTIL_PROFILER_HEAP_STATS 1 /**< Requires heap_4 or heap_5 */
+#endif // FUTIL_PROFILER_HEAP_STATS
+#ifndef FUTIL_PROFILER_PRIORITY
+#define FUTIL_PROFILER_PRIORITY (configMAX_PRIORITIES - 1)
+#endif // FUTIL_PROFILER_PRIORITY
+/** @} */
+
+/**
+ * @brief CPU usage of a single task during one profiler sampling interval
+ */
+typedef struct futil_task_load {
+    char name[FUTIL_PROFILER_TASK_NAME_LEN]; /**< Name of the task */
+    unsigned long task_number; /**< FreeRTOS' unique task number */
+    unsigned long run_time; /**< Run time counts used during the interval */
+    float cpu_share; /**< Percentage of the interval spent in the task */
+    unsigned long stack_high_water_mark; /**< Minimum amount of stack, in
+                                              words, that has remained free
+                                              since the task was started */
+} futil_task_load_t;
+
+/**
+ * @brief A single sample taken by the task profiler
+ */
+typedef struct futil_profile_sample {
+    unsigned long timestamp_ms; /**< Time the sample was taken, in ms since
+                                     the scheduler was started */
+    unsigned long total_run_time; /**< Run time counts in the interval */
+    size_t heap_free; /**< Free FreeRTOS heap in bytes */
+    size_t heap_min_ever_free; /**< Lowest free FreeRTOS heap in bytes */
+    unsigned int task_count; /**< Number of valid entries in tasks */
+    futil_task_load_t tasks[FUTIL_PROFILER_MAX_TASKS];
+} futil_profile_sample_t;
+
+/**
+ * @brief Starts the task profiler, a task that samples the CPU share of each
+ * task every period_ms milliseconds
+ *
+ * @param period_ms Sampling interval in milliseconds
+ * @param history_len Number of samples to be kept, older samples are
+ * overwritten
+ * @return 0 on success
+ */
+int gfxFUtilProfilerStart(unsigned int period_ms, unsigned int history_len);
+
+/**
+ * @brief Stops the task profiler and frees its history
+ */
+void gfxFUtilProfilerStop(void);
+
+/**
+ * @brief Memory margin that caused a memory alarm callback
+ */
+enum futil_memory_alarm {
+    FUTIL_ALARM_STACK, /**< A task's stack high water mark */
+    FUTIL_ALARM_HEAP, /**< The free FreeRTOS heap */
+};
+
+/**
+ * @brief Callback raised by the task profiler when a memory margin drops
+ * below its threshold
+ *
+ * @param alarm The margin that dropped below its threshold
+ * @param task_name Name of the task for FUTIL_ALARM_STACK, otherwise NULL
+ * @param margin Stack high water mark in words or free heap in bytes
+ * @param args Args given to gfxFUtilProfilerSetMemoryAlarm()
+ */
+typedef void (*futil_memory_alarm_cb_t)(enum futil_memory_alarm alarm,
+                                        const char *task_name,
+                                        unsigned long margin, void *args);
+
+/**
+ * @brief Sets the thresholds below which the task profiler raises a memory
+ * alarm
+ *
+ * The callback is run from the profiler task once when a margin drops below
+ * its threshold, it is raised again only once the margin has recovered and
+ * dropped again.
+ *
+ * @param stack_threshold Stack high water mark in words, 0 disables
+ * @param heap_threshold Free heap in bytes, 0 disables
+ * @param callback Callback to be run, NULL disables the alarms
+ * @param args Args passed to the callback
+ */
+void gfxFUtilProfilerSetMemoryAlarm(unsigned long stack_threshold,
+                                    size_t heap_threshold,
+                                    futil_memory_alarm_cb_t callback,
+                                    void *args);
+
+/**
+ * @brief Retrieves a copy of the most recent profiler sample
+ *
+ * @param sample Reference to where the sample should be copied
+ * @return 0 on success, -1 if the profiler is not running or has not yet
+ * taken a sample
+ */
+int gfxFUtilProfilerGetLatest(futil_profile_sample_t *sample);
+
+/**
+ * @brief Writes the profiler's history as CSV, one line per task per sample
+ * with the columns timestamp_ms, task, run_time, cpu_percent,
+ * stack_high_water_mark, heap_free and heap_min_ever_free
+ *
+ * @param file Open file to which the CSV should be written
+ * @return 0 on success
+ */
+int gfxFUtilProfilerExportCSV(FILE *file);
+
+/**
+ * @brief Writes the profiler's history as a JSON array of samples
+ *
+ * @param file Open file to which the JSON should be written
+ * @return 0 on success
+ */
+int gfxFUtilProfilerExportJSON(FILE *file);
+
 /** @} */
 #endif // __GFX__FREERTOS_UTILS_H__
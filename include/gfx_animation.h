@@ -0,0 +1,141 @@
+/**
+ * @file gfx_animation.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Pools of animation sequence instances drawn with a single call
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_ANIMATION_H__
+#define __GFX_ANIMATION_H__
+
+/**
+ * @defgroup gfx_animation GFX Animation Pool API
+ *
+ * @brief Advances and draws many animation sequences at once
+ *
+ * Pools draw the sequences of animations created through @ref gfx_draw, this
+ * header is included by gfx_draw.h once the animation handle is declared.
+ *
+ * @{
+ */
+
+/**
+ * @brief Handle used to reference an animation pool, an invalid pool will
+ * have a NULL handle
+ *
+ * An animation pool holds many animation sequence instances in contiguous
+ * storage and advances and draws all of them with a single call, see
+ * gfxDrawAnimationPoolDraw().
+ */
+typedef void *gfx_animation_pool_handle_t;
+
+/**
+ * @brief Creates a pool that can hold up to a fixed number of animation
+ * sequence instances
+ *
+ * Drawing thousands of animation sequences through gfxDrawAnimationDrawFrame()
+ * queues a draw job per sequence. A pool instead keeps its instances in
+ * contiguous arrays, advances all of them against the frame clock (see
+ * gfxDrawFrameClockGetMs()) and queues a single batched draw job per
+ * spritesheet used by its instances.
+ *
+ * A pool is not thread-safe, it should only be used by one task at a time.
+ *
+ * @param capacity The maximum number of instances the pool can hold
+ * @return A handle to the created pool, NULL otherwise
+ */
+gfx_animation_pool_handle_t gfxDrawAnimationPoolCreate(unsigned capacity);
+
+/**
+ * @brief Deletes an animation pool and all of the instances it holds
+ *
+ * @param pool The pool to be deleted
+ */
+void gfxDrawAnimationPoolDelete(gfx_animation_pool_handle_t pool);
+
+/**
+ * @brief Adds an instance of an animation sequence to an animation pool
+ *
+ * The instance starts playing from its first frame at the current frame clock
+ * time.
+ *
+ * @param pool The pool the instance is to be added to
+ * @param animation The animation object countaining the target spritesheet and
+ * animation sequence
+ * @param sequence_name Ascii string name of the sequence to be instantiated
+ * @param frame_period_ms The number of milliseconds that should transpire
+ * between sprite frames
+ * @param x The X axis location, in pixels, refernced from the top left of the
+ * sprite frame
+ * @param y The Y axis location, in pixels, refernced from the top left of the
+ * sprite frame
+ * @return A non-negative ID referencing the instance within the pool, -1 on
+ * error
+ */
+int gfxDrawAnimationPoolAdd(gfx_animation_pool_handle_t pool,
+                            gfx_animation_handle_t animation,
+                            char *sequence_name, unsigned frame_period_ms,
+                            int x, int y);
+
+/**
+ * @brief Removes an instance from an animation pool
+ *
+ * The instance's ID may be returned again by a later call to
+ * gfxDrawAnimationPoolAdd().
+ *
+ * @param pool The pool holding the instance
+ * @param id ID of the instance, as returned by gfxDrawAnimationPoolAdd()
+ * @return 0 on success
+ */
+int gfxDrawAnimationPoolRemove(gfx_animation_pool_handle_t pool, int id);
+
+/**
+ * @brief Moves an instance held in an animation pool
+ *
+ * @param pool The pool holding the instance
+ * @param id ID of the instance, as returned by gfxDrawAnimationPoolAdd()
+ * @param x The new X axis location, in pixels
+ * @param y The new Y axis location, in pixels
+ * @return 0 on success
+ */
+int gfxDrawAnimationPoolSetPosition(gfx_animation_pool_handle_t pool, int id,
+                                    int x, int y);
+
+/**
+ * @brief Restarts an instance held in an animation pool from its first frame
+ *
+ * @param pool The pool holding the instance
+ * @param id ID of the instance, as returned by gfxDrawAnimationPoolAdd()
+ * @return 0 on success
+ */
+int gfxDrawAnimationPoolReset(gfx_animation_pool_handle_t pool, int id);
+
+/**
+ * @brief Advances all instances held in an animation pool to the current
+ * frame clock time and draws them
+ *
+ * One draw job is queued per spritesheet used by the pool's instances.
+ *
+ * @param pool The pool to be drawn
+ * @return 0 on success
+ */
+int gfxDrawAnimationPoolDraw(gfx_animation_pool_handle_t pool);
+
+/** @} */
+#endif // __GFX_ANIMATION_H__
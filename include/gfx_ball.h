@@ -84,6 +84,8 @@ typedef struct ball {
 
     callback_t callback; /**< Collision callback */
     void *args; /**< Collision callback args */
+
+    unsigned clock_timestamp; /**< Frame clock time of the last update */
 } ball_t;
 
 /**
@@ -304,8 +306,12 @@ signed char gfxCheckBallCollisions(ball_t *ball, callback_t callback, void *args
  * The formula used is as follows:
  * New position += speed * milliseconds passed / milliseconds in a second
  *
+ * Passing GFX_FRAME_CLOCK as the time makes the ball use the frame clock time
+ * passed since its last update, see gfxDrawFrameClockGetMs().
+ *
  * @param ball Reference to the ball object whose position is to be updated
- * @param milli_seconds Milliseconds passed since balls position was last updated
+ * @param milli_seconds Milliseconds passed since balls position was last
+ * updated, or GFX_FRAME_CLOCK
  */
 void gfxUpdateBallPosition(ball_t *ball, unsigned int milli_seconds);
 
@@ -0,0 +1,155 @@
+/**
+ * @file gfx_chart.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Scrolling charts of sample histories, drawn by the draw thread
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_CHART_H__
+#define __GFX_CHART_H__
+
+/**
+ * @defgroup gfx_chart GFX Chart API
+ *
+ * @brief Plots samples as a scrolling chart
+ *
+ * Each chart's samples are added by a single producing thread, which need
+ * not be the thread that draws the chart.
+ *
+ * Charts are drawn through the same job queue as the rest of @ref gfx_draw,
+ * this header is included by gfx_draw.h.
+ *
+ * @{
+ */
+
+/**
+ * @brief Handle used to reference a scrolling chart, an invalid chart will
+ * have a NULL handle
+ *
+ * A chart plots a history of samples, the newest sample on the right, see
+ * gfxDrawChartCreate().
+ */
+typedef void *gfx_chart_handle_t;
+
+/**
+ * @brief Creates a chart plotting a scrolling history of samples
+ *
+ * The history is decimated into one column per pixel, each column showing
+ * the minimum and maximum of the samples falling into it. Samples are
+ * decimated as the chart is drawn and only the columns that changed are
+ * rebuilt, so the cost of drawing the chart does not depend on the length of
+ * its history.
+ *
+ * @param history Number of samples shown across the width of the chart, also
+ * the number of samples that can be added between two draws of the chart
+ * @param width Width of the chart in pixels
+ * @param height Height of the chart in pixels
+ * @param min Sample value shown at the bottom of the chart
+ * @param max Sample value shown at the top of the chart
+ * @return A handle to the created chart, NULL otherwise
+ */
+gfx_chart_handle_t gfxDrawChartCreate(unsigned int history,
+                                      unsigned int width, unsigned int height,
+                                      float min, float max);
+
+/**
+ * @brief Deletes a chart
+ *
+ * The chart is released by gfxDrawUpdateScreen() once all previously queued
+ * draws of the chart have been handled.
+ *
+ * @param chart The chart to be deleted
+ * @return 0 on success
+ */
+int gfxDrawChartDelete(gfx_chart_handle_t chart);
+
+/**
+ * @brief Adds a sample to the chart's history
+ *
+ * Samples are passed to the chart through a single-producer single-consumer
+ * ring buffer, a chart's samples must thus all be added from the same
+ * thread.
+ *
+ * @param chart The chart to which the sample is added
+ * @param value Value of the sample
+ * @return 0 on success, -1 if the chart has not been drawn since its
+ * history's worth of samples was added
+ */
+int gfxDrawChartAddSample(gfx_chart_handle_t chart, float value);
+
+/**
+ * @brief Adds a number of samples to the chart's history
+ *
+ * @param chart The chart to which the samples are added
+ * @param values Array of the sample values, oldest first
+ * @param count Number of samples in the values array
+ * @return Number of samples that were added
+ */
+unsigned int gfxDrawChartAddSamples(gfx_chart_handle_t chart,
+                                    float *values, unsigned int count);
+
+/**
+ * @brief Sets the range of sample values shown by a chart
+ *
+ * @param chart The chart whose range is set
+ * @param min Sample value shown at the bottom of the chart
+ * @param max Sample value shown at the top of the chart
+ * @return 0 on success
+ */
+int gfxDrawChartSetRange(gfx_chart_handle_t chart, float min, float max);
+
+/**
+ * @brief Shows a frame and grid lines behind a chart
+ *
+ * The axes are rendered once into a texture that is reused for every draw of
+ * the chart until the axes are changed.
+ *
+ * @param chart The chart whose axes are shown
+ * @param colour RGB colour of the axes
+ * @param x_divisions Number of sections the vertical grid lines divide the
+ * chart into, 0 or 1 for no vertical grid lines
+ * @param y_divisions Number of sections the horizontal grid lines divide the
+ * chart into, 0 or 1 for no horizontal grid lines
+ * @return 0 on success
+ */
+int gfxDrawChartSetAxes(gfx_chart_handle_t chart, unsigned int colour,
+                        unsigned int x_divisions, unsigned int y_divisions);
+
+/**
+ * @brief Stops showing the axes of a chart
+ *
+ * @param chart The chart whose axes are hidden
+ * @return 0 on success
+ */
+int gfxDrawChartHideAxes(gfx_chart_handle_t chart);
+
+/**
+ * @brief Draws a chart
+ *
+ * @param chart The chart to be drawn
+ * @param x The X axis location, in pixels, of the chart's top left corner
+ * @param y The Y axis location, in pixels, of the chart's top left corner
+ * @param colour RGB colour of the plotted samples
+ * @return 0 on success
+ */
+int gfxDrawChartDraw(gfx_chart_handle_t chart, int x, int y,
+                     unsigned int colour);
+
+/** @} */
+#endif // __GFX_CHART_H__
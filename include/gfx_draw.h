@@ -49,7 +49,13 @@
  * @{
  */
 
+#include <limits.h>
+
 #include "EmulatorConfig.h"
+#include "gfx_chart.h"
+#include "gfx_hud.h"
+#include "gfx_path.h"
+#include "gfx_pick.h"
 
 /**
  * The string that is shown on the window's status bar
@@ -149,6 +155,69 @@ typedef void *gfx_animation_handle_t;
  */
 typedef void *gfx_sequence_handle_t;
 
+/**
+ * @brief Number of downscaled variants, each half the size of the previous,
+ * that can be generated for a loaded image
+ *
+ * Variants are generated the first time a loaded image is drawn at or below
+ * the variant's size, and the smallest variant still at least as large as the
+ * drawn size is then used for the draw.
+ */
+#ifndef GFX_IMAGE_MIP_LEVELS
+#define GFX_IMAGE_MIP_LEVELS 6
+#endif // GFX_IMAGE_MIP_LEVELS
+
+/**
+ * @brief Maximum number of circle, ellipse and arc outlines whose
+ * tessellation is cached, see gfxDrawTessCacheGetStats()
+ */
+#ifndef GFX_TESS_CACHE_SIZE
+#define GFX_TESS_CACHE_SIZE 64
+#endif // GFX_TESS_CACHE_SIZE
+
+/**
+ * @brief Statistics of the tessellation cache
+ *
+ * Circles, ellipses and arcs are tessellated once per distinct size into a
+ * cached mesh. Each draw translates the mesh into a geometry batch that is
+ * submitted once a job draws something else. When the cache is full, the
+ * least recently used mesh is evicted.
+ */
+typedef struct gfx_tess_stats {
+    unsigned long hits; /**< Draws that reused a cached mesh */
+    unsigned long misses; /**< Draws that had to tessellate their shape */
+    unsigned long evictions; /**< Meshes evicted to make room */
+    unsigned long batches; /**< Geometry batches submitted */
+    unsigned int entries; /**< Meshes currently cached */
+    unsigned long vertices; /**< Vertices held by the cached meshes */
+} gfx_tess_stats_t;
+
+/**
+ * @brief Maximum number of tasks that can be added using
+ * gfxDrawAddInitTask()
+ */
+#ifndef GFX_INIT_TASKS_MAX
+#define GFX_INIT_TASKS_MAX 8
+#endif // GFX_INIT_TASKS_MAX
+
+/**
+ * @brief When set to 1, gfxDrawInit() prints the timed phases of the
+ * initialisation to stdout once done, see gfxUtilInitReport()
+ */
+#ifndef GFX_INIT_REPORT
+#define GFX_INIT_REPORT 0
+#endif // GFX_INIT_REPORT
+
+/**
+ * @brief How gfxDrawInit() runs work that does not depend on the window
+ */
+enum gfx_init_mode {
+    GFX_INIT_SERIAL, /**< Everything runs on the calling thread */
+    GFX_INIT_PARALLEL, /**< Font loading, resource indexing and tasks added
+                            using gfxDrawAddInitTask() run on worker threads
+                            while the window and context are created */
+};
+
 /**
  * @brief Returns an instance of a spritesheet
  *
@@ -157,6 +226,9 @@ typedef void *gfx_sequence_handle_t;
  */
 typedef void *gfx_spritesheet_handle_t;
 
+#include "gfx_animation.h"
+#include "gfx_tilemap.h"
+
 /**
  * @brief Returns a string error message from the gfx_draw back end
  *
@@ -164,9 +236,92 @@ typedef void *gfx_spritesheet_handle_t;
  */
 char *gfxGetErrorMessage(void);
 
+/**
+ * @brief Sets how gfxDrawInit() runs its work, GFX_INIT_SERIAL by default
+ *
+ * @param mode The mode used by the next call to gfxDrawInit()
+ */
+void gfxDrawSetInitMode(enum gfx_init_mode mode);
+
+/**
+ * @brief Adds a task to be run by gfxDrawInit()
+ *
+ * Tasks are meant for initialisation that does not need the window, eg.
+ * gfxSoundInit() or preloading images with gfxDrawLoadImage(). They run
+ * after SDL is initialised, on a worker thread each in GFX_INIT_PARALLEL
+ * mode, and have all finished when gfxDrawInit() returns. Each task is timed
+ * as an init phase of the given name.
+ *
+ * @param name Name of the task, must stay valid until the report is printed
+ * @param task Function run by the task, returning 0 on success
+ * @param arg Argument passed to the function
+ * @return 0 on success, -1 if GFX_INIT_TASKS_MAX tasks were already added
+ */
+int gfxDrawAddInitTask(const char *name, int (*task)(void *), void *arg);
+
+/**
+ * @brief Milliseconds gfxDrawViewerRun() waits between attempts to connect to
+ * an emulator
+ */
+#ifndef GFX_VIEWER_RETRY_MS
+#define GFX_VIEWER_RETRY_MS 250
+#endif // GFX_VIEWER_RETRY_MS
+
+/**
+ * @brief Milliseconds gfxDrawViewerRun() waits for a frame before handling
+ * the window's events
+ */
+#ifndef GFX_VIEWER_POLL_MS
+#define GFX_VIEWER_POLL_MS 10
+#endif // GFX_VIEWER_POLL_MS
+
+/**
+ * @brief Puts the next call to gfxDrawInit() into split mode, where drawing
+ * is done by a separate viewer process
+ *
+ * In split mode gfxDrawInit() creates no window. Instead it listens on the
+ * given Unix socket for a viewer, see gfxDrawViewerRun(). Each frame's draw
+ * jobs are then sent to the viewer by gfxDrawUpdateScreen() through shared
+ * memory, see @ref gfx_remote, and the viewer's keyboard and mouse input is
+ * received by @ref gfx_event as usual. Frames are dropped while no viewer is
+ * connected or the viewer falls behind, so the emulator never waits on it.
+ *
+ * The viewer must be built from the same sources. Tilemaps and charts are not
+ * drawn in split mode.
+ *
+ * @param socket_path Path of the Unix socket, must remain valid until
+ * gfxDrawInit() returns
+ */
+void gfxDrawSetViewerSocket(const char *socket_path);
+
+/**
+ * @brief Runs a viewer process, drawing the frames of an emulator in split
+ * mode, see gfxDrawSetViewerSocket()
+ *
+ * Must be called after gfxDrawInit(), from the same thread. Connects to the
+ * emulator, reconnecting whenever the emulator is restarted, until the
+ * viewer's window is closed. Only the newest frame is drawn if the viewer
+ * falls behind.
+ *
+ * @param socket_path Path of the Unix socket the emulator listens on
+ * @return 0 once the window is closed, -1 on error
+ */
+int gfxDrawViewerRun(const char *socket_path);
+
+/**
+ * @brief Returns the number of frames that were dropped in split mode as the
+ * viewer had fallen behind
+ *
+ * @return Number of dropped frames
+ */
+unsigned long gfxDrawGetViewerFramesDropped(void);
+
 /**
  * @brief Initializes the gfx_draw backend
  *
+ * Fails if any task added using gfxDrawAddInitTask() fails, the work done by
+ * tasks that succeeded is not undone.
+ *
  * @param path Path to the folder's location where the program's binary is
  * located
  * @return 0 on success
@@ -206,6 +361,93 @@ void gfxDrawExit(void);
  */
 int gfxDrawUpdateScreen(void);
 
+/**
+ * @brief Retrieves the tessellation cache's statistics, see
+ * gfx_tess_stats_t
+ *
+ * @param stats Reference to the structure the statistics are stored in
+ */
+void gfxDrawTessCacheGetStats(gfx_tess_stats_t *stats);
+
+/**
+ * @brief Resets the tessellation cache's hit, miss, eviction and batch
+ * counters
+ */
+void gfxDrawTessCacheResetStats(void);
+
+/**
+ * @brief Timestep value that makes a time dependent function sample the frame
+ * clock
+ *
+ * Passing GFX_FRAME_CLOCK as the timestep to gfxDrawAnimationDrawFrame() or
+ * gfxUpdateBallPosition() makes the object advance by the frame clock time
+ * that has passed since the object last sampled the clock, see
+ * gfxDrawFrameClockGetMs(). Any other value, including 0, is taken as an
+ * explicit timestep in milliseconds.
+ */
+#define GFX_FRAME_CLOCK UINT_MAX
+
+/**
+ * @brief Returns the current time of the library's frame clock
+ *
+ * The frame clock is a monotonic clock that is advanced once per presented
+ * frame by gfxDrawUpdateScreen(), by the real time that has passed since the
+ * previous presented frame multiplied by the clock's scale. All objects that
+ * sample the frame clock therefore see the same time for a given frame, no
+ * matter which task they are updated from. The clock does not advance while
+ * it is paused, see gfxDrawFrameClockPause().
+ *
+ * @return Milliseconds of frame clock time passed since the first presented
+ * frame
+ */
+unsigned gfxDrawFrameClockGetMs(void);
+
+/**
+ * @brief Returns the frame clock time that passed during the last presented
+ * frame
+ *
+ * @return Milliseconds the frame clock was advanced by when the last frame
+ * was presented
+ */
+unsigned gfxDrawFrameClockGetDeltaMs(void);
+
+/**
+ * @brief Pauses or resumes the frame clock
+ *
+ * While paused the frame clock is not advanced, freezing all animations and
+ * balls that sample it. Resuming does not make the clock jump by the time
+ * spent paused.
+ *
+ * @param pause 1 to pause the clock, 0 to resume it
+ */
+void gfxDrawFrameClockPause(unsigned char pause);
+
+/**
+ * @brief Returns if the frame clock is currently paused
+ *
+ * @return 1 if paused, 0 otherwise
+ */
+unsigned char gfxDrawFrameClockIsPaused(void);
+
+/**
+ * @brief Sets the rate at which the frame clock runs relative to real time
+ *
+ * A scale of 1.0 lets the frame clock follow real time, 0.5 plays time back at
+ * half speed and 2.0 at double speed.
+ *
+ * @param scale Non-negative time scale factor
+ * @return 0 on success
+ */
+int gfxDrawFrameClockSetScale(float scale);
+
+/**
+ * @brief Returns the frame clock's current time scale, see
+ * gfxDrawFrameClockSetScale()
+ *
+ * @return The time scale factor
+ */
+float gfxDrawFrameClockGetScale(void);
+
 /**
  * @brief Sets the screen to a solid colour
  *
@@ -243,8 +485,9 @@ int gfxDrawEllipse(signed short x, signed short y, signed short rx,
  * @param x X coordinate of the center of the arc
  * @param y Y coordinate of the cente of the arc
  * @param radius Radius of the arc in pixels
- * @param start Starting radius of the arc, 0 degrees is down
- * @param end Ending radius of the arc, 0 degrees is down
+ * @param start Starting angle of the arc in degrees, 0 degrees is right and
+ * angles increase clockwise
+ * @param end Ending angle of the arc in degrees
  * @param colour RGB colour of the arc
  * @return 0 on success
  */
@@ -356,6 +599,37 @@ int gfxDrawLine(signed short x1, signed short y1, signed short x2,
  */
 int gfxDrawPoly(coord_t *points, int n, unsigned int colour);
 
+/**
+ * @brief Draws a filled polygon on the screen
+ *
+ * The polygon is filled using the even-odd rule, as such self-intersecting
+ * polygons are drawn with holes where their outline overlaps itself.
+ *
+ * @param points Points array specifying each point in the polygon
+ * @param n Number of points in the points array, at least three
+ * @param colour RGB colour of the polygon
+ * @return 0 on success
+ */
+int gfxDrawFilledPoly(coord_t *points, int n, unsigned int colour);
+
+/**
+ * @brief Draws a line through a series of points on the screen
+ *
+ * The whole line is drawn as a single mesh with mitered joins between its
+ * segments, which is far cheaper than drawing each segment using
+ * gfxDrawLine(). Note that consecutive calls to gfxDrawLine() where each line
+ * starts at the end of the previous one, and that share a thickness and
+ * colour, are also joined into a single line.
+ *
+ * @param points Points array specifying each point along the line
+ * @param n Number of points in the points array, at least two
+ * @param thickness The thickness of the line
+ * @param colour RGB colour of the line
+ * @return 0 on success
+ */
+int gfxDrawPolyline(coord_t *points, int n, unsigned char thickness,
+                    unsigned int colour);
+
 /**
  * @brief Draws a triangle on the screen
  *
@@ -457,6 +731,22 @@ int gfxDrawGetLoadedImageSize(gfx_image_handle_t img, int *w, int *h);
  */
 int gfxDrawLoadedImage(gfx_image_handle_t img, signed short x, signed short y);
 
+/**
+ * @brief Draws a loaded image to the screen at a given scale
+ *
+ * Unlike gfxDrawSetLoadedImageScale() the scale only applies to this draw.
+ * Images drawn at half their size or smaller are drawn from cached,
+ * filtered downscaled variants of the image, see GFX_IMAGE_MIP_LEVELS.
+ *
+ * @param img Handle to the image to be drawn to the screen
+ * @param x X coordinate of the top left corner of the image
+ * @param y Y coordinate of the top left corner of the image
+ * @param scale Scaling factor relative to the image file's dimensions
+ * @return 0 on success
+ */
+int gfxDrawLoadedImageScaled(gfx_image_handle_t img, signed short x,
+                             signed short y, float scale);
+
 /**
  * @brief Draws an image on the screen
  *
@@ -642,6 +932,9 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromPortionOfImagePaddedSpacing(
 /**
  * @brief Draws a sprite from a spritesheet
  *
+ * The source rect of every sprite is computed once when the spritesheet is
+ * loaded, drawing a sprite is thus a table lookup.
+ *
  * @param spritesheet Spritesheet to be drawn from
  * @param column Column on the sprite sheet where the target sprite is located
  * @param row Row on the sprite sheet where the target sprite is located
@@ -649,8 +942,23 @@ gfx_spritesheet_handle_t gfxDrawLoadSpritesheetFromPortionOfImagePaddedSpacing(
  * @param y Y coordinate where the sprite should be drawn on the screen
  * @return 0 on success
  */
-int gfxDrawSprite(gfx_spritesheet_handle_t spritesheet, char column, char row,
-                  signed short x, signed short y);
+int gfxDrawSprite(gfx_spritesheet_handle_t spritesheet, unsigned column,
+                  unsigned row, signed short x, signed short y);
+
+/**
+ * @brief Draws a sprite from a spritesheet using the sprite's index
+ *
+ * Sprites are indexed row by row, the sprite at a given column and row has
+ * the index row * columns + column.
+ *
+ * @param spritesheet Spritesheet to be drawn from
+ * @param index Index of the target sprite on the sprite sheet
+ * @param x X coordinate where the sprite should be drawn on the screen
+ * @param y Y coordinate where the sprite should be drawn on the screen
+ * @return 0 on success
+ */
+int gfxDrawSpriteIndex(gfx_spritesheet_handle_t spritesheet, unsigned index,
+                       signed short x, signed short y);
 
 /**
  * @brief Gets the width and height of an image
@@ -755,11 +1063,15 @@ void gfxDrawAnimationReset(gfx_sequence_handle_t sequence);
  * passed since they were last rendered. This is tracked incrementally and as
  * such each call to this function should pass in the number of milliseconds that
  * has transpired since the last call to gfxDrawAnimationDrawFrame() so that
- * the sprite frame can be selected appropriately.
+ * the sprite frame can be selected appropriately. Passing GFX_FRAME_CLOCK
+ * instead lets the sequence sample the library's frame clock, see
+ * gfxDrawFrameClockGetMs(), which keeps all sequences in step and honours the
+ * clock's pause and time scale.
  *
  * @param sequence Sequence instance that is to be rendered
  * @param ms_timestep The number of milliseconds that have transpired since the
- * last call to this function for the given animation sequence
+ * last call to this function for the given animation sequence, or
+ * GFX_FRAME_CLOCK
  * @param x The X axis location, in pixels, refernced from the top left of the
  * sprite frame
  * @param y The Y axis location, in pixels, refernced from the top left of the
@@ -769,6 +1081,35 @@ void gfxDrawAnimationReset(gfx_sequence_handle_t sequence);
 int gfxDrawAnimationDrawFrame(gfx_sequence_handle_t sequence,
                               unsigned ms_timestep, int x, int y);
 
+/**
+ * @brief Sets a budget for the memory accounted by gfxUtilMemStatsGet()
+ *
+ * When a presented frame leaves more memory accounted than the budget, the
+ * textures and downscaled variants of loaded images are evicted, least
+ * recently drawn first, until the budget is met. Evicted data is recreated
+ * when the image is next drawn. Images drawn in the presented frame are not
+ * evicted, such that the budget may be exceeded by what a single frame
+ * needs.
+ *
+ * @param bytes The budget in bytes, 0 for no budget
+ */
+void gfxDrawSetMemoryBudget(size_t bytes);
+
+/**
+ * @brief Returns the budget set using gfxDrawSetMemoryBudget()
+ *
+ * @return The budget in bytes, 0 if no budget is set
+ */
+size_t gfxDrawGetMemoryBudget(void);
+
+/**
+ * @brief Returns how many times the caches of an image were evicted to meet
+ * the memory budget
+ *
+ * @return Number of evictions
+ */
+unsigned long gfxDrawGetMemoryEvictions(void);
+
 /**
  * @brief Sets the global draw position offset's X axis value
  *
@@ -0,0 +1,455 @@
+/**
+ * @file gfx_draw_internal.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Draw jobs and geometry shared between the modules that queue and
+ * draw jobs, not part of the library's API
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_DRAW_INTERNAL_H__
+#define __GFX_DRAW_INTERNAL_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <pthread.h>
+
+#include "gfx_draw.h"
+#include "gfx_utils.h"
+
+#define ONE_BYTE 8
+#define TWO_BYTES 16
+#define THREE_BYTES 24
+#define MAX_8_BIT 255
+#define ALPHA_SOLID MAX_8_BIT
+#define FIRST_BYTE 0x000000ff
+#define SECOND_BYTE 0x0000ff00
+#define THIRD_BYTE 0x00ff0000
+#define FOURTH_BYTE 0xff000000
+#define RED_PORTION(COLOUR) (COLOUR & 0xFF0000) >> TWO_BYTES
+#define GREEN_PORTION(COLOUR) (COLOUR & 0x00FF00) >> ONE_BYTE
+#define BLUE_PORTION(COLOUR) (COLOUR & 0x0000FF)
+#define ZERO_ALPHA 0
+
+#define PRINT_SDL_ERROR(msg, ...)                                              \
+    PRINT_ERROR("[SDL Error] %s\n" #msg, (char *)SDL_GetError(),           \
+                ##__VA_ARGS__)
+
+#define TESS_TOLERANCE 0.25 // Max pixels a segment may stray from the curve
+#define TESS_PI 3.14159265358979323846
+
+#define NS_IN_SECOND 1000000000.0
+#define MS_IN_SECOND 1000.0
+#define NS_IN_MS 1000000.0
+
+#if (configFPS_LIMIT == 1)
+#ifdef configFPS_LIMIT_RATE
+#define FRAMELIMIT configFPS_LIMIT_RATE
+#else
+#define FRAMELIMIT 50
+#endif //configFPS_LIMIT_RATE
+#define FRAMELIMIT_PERIOD 1000.0 / FRAMELIMIT
+#endif //configFPS_LIMIT
+
+typedef enum {
+    DRAW_NONE = 0,
+    DRAW_CLEAR,
+    DRAW_ARC,
+    DRAW_ELLIPSE,
+    DRAW_TEXT,
+    DRAW_RECT,
+    DRAW_FILLED_RECT,
+    DRAW_CIRCLE,
+    DRAW_LINE,
+    DRAW_POLYLINE,
+    DRAW_POLY,
+    DRAW_FILLED_POLY,
+    DRAW_TRIANGLE,
+    DRAW_IMAGE,
+    DRAW_LOADED_IMAGE,
+    DRAW_LOADED_IMAGE_CROP,
+    DRAW_SCALED_IMAGE,
+    DRAW_ARROW,
+    DRAW_SPRITE_BATCH,
+    DRAW_TILEMAP,
+    DRAW_PATH,
+    DRAW_CHART,
+    DRAW_MESH,
+    DRAW_JOB_TYPE_COUNT,
+} draw_job_type_t;
+
+typedef struct loaded_image loaded_image_t;
+typedef struct tilemap tilemap_t;
+typedef struct path path_t;
+typedef struct chart chart_t;
+
+typedef struct spritesheet {
+    loaded_image_t *image;
+    unsigned x;
+    unsigned y;
+    unsigned width;
+    unsigned height;
+    unsigned sprite_width;
+    unsigned sprite_height;
+    unsigned sprite_cols;
+    unsigned sprite_rows;
+    unsigned padding_x;
+    unsigned padding_y;
+    SDL_Rect *cells; // Source rect of each sprite, indexed row * cols + col
+} spritesheet_t;
+
+typedef struct spritesheet_sequence {
+    char *name;
+    unsigned start_row;
+    unsigned start_col;
+    enum sprite_sequence_direction direction;
+    unsigned frames;
+    SDL_Rect *rects; // Source rect of each frame in playback order
+    struct spritesheet_sequence *next;
+} spritesheet_sequence_t;
+
+typedef struct animated_image {
+    spritesheet_t *spritesheet;
+    spritesheet_sequence_t *sequences;
+} animated_image_t;
+
+typedef struct loaded_image_crop {
+    loaded_image_t *image;
+    int x;
+    int y;
+    int c_x;
+    int c_y;
+    int c_w;
+    int c_h;
+} loaded_image_crop_t;
+
+// Untextured triangles of consecutive shape and line jobs, or a cached mesh
+struct geometry_batch {
+    SDL_Vertex *verts;
+    int *indices;
+    unsigned int n_verts;
+    unsigned int n_indices;
+    unsigned int verts_size;
+    unsigned int indices_size;
+};
+
+typedef struct clear_data {
+    unsigned int colour;
+} clear_data_t;
+
+typedef struct arc_data {
+    signed short x;
+    signed short y;
+    signed short radius;
+    signed short start;
+    signed short end;
+    unsigned int colour;
+} arc_data_t;
+
+typedef struct ellipse_data {
+    signed short x;
+    signed short y;
+    signed short rx;
+    signed short ry;
+    unsigned int colour;
+} ellipse_data_t;
+
+typedef struct rect_data {
+    signed short x;
+    signed short y;
+    signed short w;
+    signed short h;
+    unsigned int colour;
+} rect_data_t;
+
+typedef struct circle_data {
+    signed short x;
+    signed short y;
+    signed short radius;
+    unsigned int colour;
+} circle_data_t;
+
+typedef struct line_data {
+    signed short x1;
+    signed short y1;
+    signed short x2;
+    signed short y2;
+    unsigned char thickness;
+    unsigned int colour;
+} line_data_t;
+
+typedef struct poly_data {
+    Sint16 *x; // Stored after the job's data, see INIT_JOB_EXTRA
+    Sint16 *y;
+    unsigned int n;
+    unsigned char thickness; // Polylines only
+    unsigned int colour;
+} poly_data_t;
+
+typedef struct triangle_data {
+    coord_t points[3];
+    unsigned int colour;
+} triangle_data_t;
+
+typedef struct image_data {
+    char *filename;
+    SDL_Texture *tex;
+    signed short x;
+    signed short y;
+} image_data_t;
+
+typedef struct loaded_image_data {
+    loaded_image_t *img;
+    signed short x;
+    signed short y;
+    float scale;
+} loaded_image_data_t;
+
+typedef struct scaled_image_data {
+    image_data_t image;
+    float scale;
+} scaled_image_data_t;
+
+typedef struct text_data {
+    char *str;
+    signed short x;
+    signed short y;
+    unsigned int colour;
+    TTF_Font *font;
+} text_data_t;
+
+typedef struct sprite_batch_data {
+    loaded_image_t *image;
+    SDL_Rect *rects; // Source and destination rect pairs
+    unsigned n;
+} sprite_batch_data_t;
+
+typedef struct tilemap_data {
+    tilemap_t *map;
+    int x;
+    int y;
+    unsigned char release; // Free the map instead of drawing it
+} tilemap_data_t;
+
+typedef struct path_data {
+    path_t *path;
+    int x;
+    int y;
+    unsigned char fill; // Fill the path instead of stroking it
+    unsigned char thickness;
+    enum gfx_path_fill_rule rule;
+    unsigned int colour;
+    unsigned char release; // Free the path instead of drawing it
+} path_data_t;
+
+typedef struct chart_data {
+    chart_t *chart;
+    int x;
+    int y;
+    unsigned int colour;
+    unsigned char release; // Free the chart instead of drawing it
+} chart_data_t;
+
+// Path meshes received by a viewer, see gfxDrawViewerRun()
+typedef struct mesh_data {
+    struct geometry_batch mesh; // Stored after the job's data
+    int x;
+    int y;
+    unsigned int colour;
+} mesh_data_t;
+
+typedef struct arrow_data {
+    signed short x1;
+    signed short y1;
+    signed short x2;
+    signed short y2;
+    signed short head_length;
+    unsigned char thickness;
+    unsigned int colour;
+} arrow_data_t;
+
+union data_u {
+    clear_data_t clear;
+    arc_data_t arc;
+    ellipse_data_t ellipse;
+    rect_data_t rect;
+    circle_data_t circle;
+    line_data_t line;
+    poly_data_t poly;
+    triangle_data_t triangle;
+    image_data_t image;
+    loaded_image_data_t loaded_image;
+    loaded_image_crop_t loaded_image_crop;
+    scaled_image_data_t scaled_image;
+    text_data_t text;
+    arrow_data_t arrow;
+    sprite_batch_data_t sprite_batch;
+    tilemap_data_t tilemap;
+    path_data_t path;
+    chart_data_t chart;
+    mesh_data_t mesh;
+};
+
+typedef struct draw_job {
+    draw_job_type_t type;
+    union data_u *data;
+    unsigned int pick_id; // See gfxDrawSetPickID()
+    unsigned int bytes; // Accounted as GFX_MEM_JOBS
+
+    struct draw_job *next;
+} draw_job_t;
+
+// EXTRA bytes are allocated directly after the job's data
+#define INIT_JOB_EXTRA(JOB, TYPE, EXTRA)                                       \
+    draw_job_t *JOB = gfxDrawCreateJob(TYPE, EXTRA);                        \
+    if (!JOB)                                                              \
+        return -1;
+
+#define INIT_JOB(JOB, TYPE) INIT_JOB_EXTRA(JOB, TYPE, 0)
+
+// Records of a frame sent to a viewer other than draw jobs
+enum remote_record_type {
+    REMOTE_FRAME = DRAW_JOB_TYPE_COUNT, // remote_frame, starts each frame
+    REMOTE_RESET, // Viewer forgets all images
+    REMOTE_IMAGE_DEFINE, // remote_image followed by the image's filename
+    REMOTE_IMAGE_RELEASE, // remote_image
+};
+
+// A frame is a sequence of records. Draw jobs are sent as their data followed
+// by what its pointers point to, so the emulator and viewer must be built
+// from the same sources.
+struct remote_record {
+    uint32_t type; // draw_job_type_t or enum remote_record_type
+    uint32_t size; // Of the payload, padded to REMOTE_RECORD_ALIGN
+    int32_t x_offset; // Global offsets draw jobs are drawn with
+    int32_t y_offset;
+};
+
+#define REMOTE_RECORD_ALIGN 8
+#define REMOTE_RECORD_SIZE(SIZE)                                               \
+    (sizeof(struct remote_record) +                                        \
+     (((SIZE) + REMOTE_RECORD_ALIGN - 1) & ~(REMOTE_RECORD_ALIGN - 1)))
+
+struct remote_frame {
+    uint32_t hud; // See gfxDrawHUDShow()
+};
+
+struct remote_image {
+    uint32_t id;
+    float scale;
+};
+
+struct remote_text {
+    int64_t font_size; // Followed by the font's name and the string
+};
+
+struct remote_mesh {
+    uint32_t n_verts; // Followed by as many positions and the indices
+    uint32_t n_indices;
+};
+
+// gfx_draw.c
+
+extern SDL_Renderer *renderer;
+extern unsigned renderer_generation; // Incremented for each new renderer
+extern const char *draw_job_names[DRAW_JOB_TYPE_COUNT];
+
+extern pthread_mutex_t ttf_lock;
+extern gfx_lock_stats_t ttf_lock_stats;
+
+// Allocates a job tagged with the calling thread's pick ID, NULL on failure
+draw_job_t *gfxDrawCreateJob(draw_job_type_t type, size_t extra);
+
+void gfxDrawPushJob(draw_job_t *job);
+void gfxDrawDiscardJob(draw_job_t *job);
+int gfxDrawReplayJob(draw_job_t *job, int x_offset, int y_offset);
+
+unsigned int gfxDrawTessSegments(float radius, float span);
+int gfxDrawReserveMesh(struct geometry_batch *mesh, unsigned int n_verts,
+                       unsigned int n_indices);
+
+unsigned int gfxDrawUniquePoints(SDL_FPoint *points, unsigned int n,
+                                 unsigned char closed);
+int gfxDrawStrokePoints(struct geometry_batch *mesh, const SDL_FPoint *points,
+                        unsigned int n, unsigned char closed,
+                        unsigned char thickness, SDL_Color c);
+
+SDL_Texture *gfxDrawTrackTexture(SDL_Texture *tex);
+void gfxDrawDestroyTexture(SDL_Texture *tex);
+
+void vGetLoadedImage(loaded_image_t *img);
+void vPutLoadedImage(gfx_image_handle_t img);
+// Creates the image's texture on first use, GL thread only
+SDL_Texture *gfxDrawGetImageTexture(loaded_image_t *img);
+// Incremented each time the image is hot-reloaded
+unsigned int gfxDrawGetImageVersion(loaded_image_t *img);
+
+float gfxDrawTimespecDiffMs(struct timespec *start, struct timespec *stop);
+
+// gfx_path.c
+
+struct geometry_batch *gfxPathLockMesh(path_data_t *data);
+void gfxPathUnlockMesh(path_t *path);
+
+// Extent of the path's points, -1 if it has none
+int gfxPathGetBounds(path_t *path, SDL_FPoint *min, SDL_FPoint *max);
+
+void gfxPathFree(path_t *path);
+
+// gfx_chart.c
+
+int gfxChartRender(chart_t *chart, int x, int y, unsigned int colour);
+void gfxChartGetSize(chart_t *chart, unsigned int *width,
+                     unsigned int *height);
+void gfxChartFree(chart_t *chart);
+
+// gfx_hud.c
+
+void gfxHUDRender(void);
+// Adds the time since the previous presented frame to the frame time graph
+void gfxHUDRecordFrame(void);
+void gfxHUDResetJobs(void);
+void gfxHUDCountJob(unsigned int type);
+void gfxHUDForgetTexture(void);
+void gfxHUDFree(void);
+
+// gfx_tilemap.c
+
+int gfxTilemapRender(tilemap_t *map, int x, int y);
+void gfxTilemapGetSize(tilemap_t *map, unsigned int *width,
+                       unsigned int *height);
+void gfxTilemapFree(tilemap_t *map);
+
+// gfx_pick.c
+
+void gfxPickAdd(const SDL_Rect *bounds, unsigned int id);
+void gfxPickPresentFrame(void);
+
+// gfx_remote.c
+
+// Applies a frame's records, drawing its jobs only if it is to be shown
+int gfxRemoteViewerDecodeFrame(unsigned char *frame, size_t size,
+                               unsigned char draw);
+// Frees the images of the emulator the viewer was connected to
+void gfxRemoteViewerFreeImages(void);
+
+#endif // __GFX_DRAW_INTERNAL_H__
@@ -46,6 +46,14 @@
  * @{
  */
 
+/**
+ * The SDL scancode of the key that toggles the performance HUD, see
+ * gfxDrawHUDToggle()
+ */
+#ifndef HUD_TOGGLE_SCANCODE
+#define HUD_TOGGLE_SCANCODE SDL_SCANCODE_F3
+#endif //HUD_TOGGLE_SCANCODE
+
 /**
  * @brief Initializes the GFX Event backend
  *
@@ -93,6 +101,21 @@ signed char gfxEventGetMouseRight(void);
  */
 signed char gfxEventGetMouseMiddle(void);
 
+/**
+ * @brief Returns the ID of the topmost UI element at a position, as it was
+ * last presented on the screen
+ *
+ * Elements are identified by the pick ID their draw jobs were tagged with, see
+ * gfxDrawSetPickID(). Passing the mouse's coordinates returns the element
+ * the mouse is over.
+ *
+ * @param x X coordinate, in pixels, of the position
+ * @param y Y coordinate, in pixels, of the position
+ * @return The topmost element's pick ID, GFX_PICK_NONE if there is no
+ * element at the position
+ */
+unsigned int gfxEventPick(signed short x, signed short y);
+
 /**
  * @name Event fetching flags
  *
@@ -121,6 +121,27 @@ void gfxFontExit(void);
  */
 TTF_Font *gfxFontGetCurFont(void);
 
+/**
+ * @brief Retrieves a reference to the SDL2 TTF font with the given name and
+ * size, loading the font if it is not yet loaded. Like gfxFontGetCurFont(),
+ * each call must be matched by a call to gfxFontPutFont().
+ *
+ * @param font_name Name of the font's file within the fonts directory
+ * @param size Size of the font
+ * @return A reference to the SDL2 TTF font, NULL if it could not be loaded
+ */
+TTF_Font *gfxFontGetFont(char *font_name, ssize_t size);
+
+/**
+ * @brief Looks up the name and size of a referenced SDL2 TTF font
+ *
+ * @param font SDL2 TTF font reference, retrieved via gfxFontGetCurFont()
+ * @param size Reference to where the font's size is stored
+ * @return The font's name, which must be free'd by the caller, NULL if the
+ * font is not known
+ */
+char *gfxFontGetFontName(const TTF_Font *font, ssize_t *size);
+
 /**
  * @brief Finds the gfx_font object associated with the loaded SDL2 TFF font,
  * decreasing the reference count to the object with each call, once an object's
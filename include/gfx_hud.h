@@ -0,0 +1,66 @@
+/**
+ * @file gfx_hud.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief On-screen performance HUD
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_HUD_H__
+#define __GFX_HUD_H__
+
+/**
+ * @defgroup gfx_hud GFX HUD API
+ *
+ * @brief Shows frame timing, queued draw jobs, memory use and task load on
+ * top of the drawn frame
+ *
+ * The HUD is drawn as part of @ref gfx_draw, this header is included by
+ * gfx_draw.h.
+ *
+ * @{
+ */
+
+/**
+ * @brief Shows or hides the on-screen performance HUD
+ *
+ * The HUD is drawn by gfxDrawUpdateScreen() on top of all other draw jobs and
+ * shows the FPS, a frame time graph, the number of draw jobs handled in the
+ * last frame and their types, the memory used by loaded image textures and,
+ * while the task profiler is running (see gfxFUtilProfilerStart()), the
+ * busiest tasks' CPU share. The HUD can also be toggled using the key
+ * HUD_TOGGLE_SCANCODE, see @ref gfx_event.
+ *
+ * @param show 1 to show the HUD, 0 to hide it
+ */
+void gfxDrawHUDShow(unsigned char show);
+
+/**
+ * @brief Toggles the on-screen performance HUD, see gfxDrawHUDShow()
+ */
+void gfxDrawHUDToggle(void);
+
+/**
+ * @brief Returns if the on-screen performance HUD is currently shown
+ *
+ * @return 1 if the HUD is shown, 0 otherwise
+ */
+unsigned char gfxDrawHUDIsShown(void);
+
+/** @} */
+#endif // __GFX_HUD_H__
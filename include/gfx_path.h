@@ -0,0 +1,198 @@
+/**
+ * @file gfx_path.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Vector paths built from line, curve and arc segments that are
+ * stroked or filled by the draw thread
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_PATH_H__
+#define __GFX_PATH_H__
+
+/**
+ * @defgroup gfx_path GFX Path API
+ *
+ * @brief Builds vector paths and queues them to be stroked or filled
+ *
+ * Paths are drawn through the same job queue as the rest of @ref gfx_draw,
+ * this header is included by gfx_draw.h.
+ *
+ * @{
+ */
+
+/**
+ * @brief Handle used to reference a vector path, an invalid path will have a
+ * NULL handle
+ *
+ * A path is a set of contours built from line, curve and arc segments, that
+ * can be stroked or filled, see gfxDrawPathStroke() and gfxDrawPathFill().
+ */
+typedef void *gfx_path_handle_t;
+
+/**
+ * @brief Defines which regions enclosed by a path's contours are filled
+ */
+enum gfx_path_fill_rule {
+    GFX_PATH_FILL_NON_ZERO, /**< Regions the contours wind around */
+    GFX_PATH_FILL_EVEN_ODD, /**< Regions inside an odd number of contours */
+};
+
+/**
+ * @brief Creates an empty vector path
+ *
+ * Segments are flattened into line segments as they are added to the path,
+ * curves being subdivided until they are within a quarter of a pixel of the
+ * true curve. The first time the path is stroked or filled the flattened
+ * contours are tessellated into a mesh which is kept until the path changes,
+ * such that redrawing an unchanged path costs a single geometry submission.
+ *
+ * @return A handle to the created path, NULL otherwise
+ */
+gfx_path_handle_t gfxDrawPathCreate(void);
+
+/**
+ * @brief Deletes a path
+ *
+ * The path's meshes are released by gfxDrawUpdateScreen() once all
+ * previously queued draws of the path have been handled.
+ *
+ * @param path The path to be deleted
+ * @return 0 on success
+ */
+int gfxDrawPathDelete(gfx_path_handle_t path);
+
+/**
+ * @brief Removes all contours from a path
+ *
+ * @param path The path to be cleared
+ * @return 0 on success
+ */
+int gfxDrawPathClear(gfx_path_handle_t path);
+
+/**
+ * @brief Starts a new contour on a path
+ *
+ * @param path The path to which the contour is added
+ * @param x X coordinate of the contour's first point
+ * @param y Y coordinate of the contour's first point
+ * @return 0 on success
+ */
+int gfxDrawPathMoveTo(gfx_path_handle_t path, float x, float y);
+
+/**
+ * @brief Adds a straight line from the path's current point
+ *
+ * Segments added without a current contour, or after the current contour was
+ * closed, start a new contour at the current point.
+ *
+ * @param path The path to which the line is added
+ * @param x X coordinate of the line's end point
+ * @param y Y coordinate of the line's end point
+ * @return 0 on success
+ */
+int gfxDrawPathLineTo(gfx_path_handle_t path, float x, float y);
+
+/**
+ * @brief Adds a quadratic Bezier curve from the path's current point
+ *
+ * @param path The path to which the curve is added
+ * @param cx X coordinate of the curve's control point
+ * @param cy Y coordinate of the curve's control point
+ * @param x X coordinate of the curve's end point
+ * @param y Y coordinate of the curve's end point
+ * @return 0 on success
+ */
+int gfxDrawPathQuadTo(gfx_path_handle_t path, float cx, float cy, float x,
+                      float y);
+
+/**
+ * @brief Adds a cubic Bezier curve from the path's current point
+ *
+ * @param path The path to which the curve is added
+ * @param c1x X coordinate of the curve's first control point
+ * @param c1y Y coordinate of the curve's first control point
+ * @param c2x X coordinate of the curve's second control point
+ * @param c2y Y coordinate of the curve's second control point
+ * @param x X coordinate of the curve's end point
+ * @param y Y coordinate of the curve's end point
+ * @return 0 on success
+ */
+int gfxDrawPathCubicTo(gfx_path_handle_t path, float c1x, float c1y,
+                       float c2x, float c2y, float x, float y);
+
+/**
+ * @brief Adds a circular arc to a path
+ *
+ * Angles are given in degrees, 0 pointing right and increasing clockwise.
+ * The arc is swept clockwise from the start angle to the end angle, or
+ * anticlockwise when the end angle is smaller. If the path has a current
+ * contour, it is joined to the start of the arc by a straight line.
+ *
+ * @param path The path to which the arc is added
+ * @param cx X coordinate of the arc's centre
+ * @param cy Y coordinate of the arc's centre
+ * @param radius Radius of the arc
+ * @param start Angle at which the arc starts
+ * @param end Angle at which the arc ends
+ * @return 0 on success
+ */
+int gfxDrawPathArc(gfx_path_handle_t path, float cx, float cy, float radius,
+                   float start, float end);
+
+/**
+ * @brief Closes the path's current contour back to its first point
+ *
+ * @param path The path whose contour is closed
+ * @return 0 on success
+ */
+int gfxDrawPathClose(gfx_path_handle_t path);
+
+/**
+ * @brief Draws the outline of a path
+ *
+ * Open contours are stroked from their first to their last point, closed
+ * contours are joined back to their first point.
+ *
+ * @param path The path to be stroked
+ * @param x The X axis offset, in pixels, at which the path is drawn
+ * @param y The Y axis offset, in pixels, at which the path is drawn
+ * @param thickness The thickness of the outline
+ * @param colour RGB colour of the outline
+ * @return 0 on success
+ */
+int gfxDrawPathStroke(gfx_path_handle_t path, int x, int y,
+                      unsigned char thickness, unsigned int colour);
+
+/**
+ * @brief Draws the area enclosed by a path
+ *
+ * All contours of the path are treated as closed when filling.
+ *
+ * @param path The path to be filled
+ * @param x The X axis offset, in pixels, at which the path is drawn
+ * @param y The Y axis offset, in pixels, at which the path is drawn
+ * @param rule Rule deciding which enclosed regions are filled
+ * @param colour RGB colour of the filled area
+ * @return 0 on success
+ */
+int gfxDrawPathFill(gfx_path_handle_t path, int x, int y,
+                    enum gfx_path_fill_rule rule, unsigned int colour);
+
+/** @} */
+#endif // __GFX_PATH_H__
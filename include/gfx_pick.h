@@ -0,0 +1,86 @@
+/**
+ * @file gfx_pick.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Hit-testing of the draw jobs in the most recently presented frame
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_PICK_H__
+#define __GFX_PICK_H__
+
+/**
+ * @defgroup gfx_pick GFX Pick API
+ *
+ * @brief Finds which tagged draw job is topmost at a pixel
+ *
+ * Draw jobs are tagged as they are queued through @ref gfx_draw, this header
+ * is included by gfx_draw.h.
+ *
+ * @{
+ */
+
+/**
+ * @brief Pick ID of draw jobs that are not considered when picking, see
+ * gfxDrawSetPickID()
+ */
+#define GFX_PICK_NONE 0
+
+/**
+ * @brief Width and height, in pixels, of the grid cells that the bounding
+ * boxes of tagged draw jobs are sorted into for picking
+ */
+#ifndef GFX_PICK_CELL_SIZE
+#define GFX_PICK_CELL_SIZE 32
+#endif // GFX_PICK_CELL_SIZE
+
+/**
+ * @brief Sets the pick ID that subsequent draw jobs of the calling thread are
+ * tagged with
+ *
+ * The bounding boxes of tagged jobs are collected into a grid each frame.
+ * Once the frame has been presented, gfxDrawPickPresented() and
+ * gfxEventPick() return which ID is topmost at a given pixel, such that UI
+ * elements can be hit-tested without looping over them. Screen clears and
+ * images drawn by filename are not collected.
+ *
+ * @param id ID to tag the jobs with, GFX_PICK_NONE to stop tagging jobs
+ */
+void gfxDrawSetPickID(unsigned int id);
+
+/**
+ * @brief Returns the pick ID that the calling thread's draw jobs are tagged
+ * with
+ *
+ * @return The pick ID set using gfxDrawSetPickID()
+ */
+unsigned int gfxDrawGetPickID(void);
+
+/**
+ * @brief Returns the ID of the topmost tagged draw job covering a pixel in
+ * the most recently presented frame
+ *
+ * @param x X coordinate of the pixel
+ * @param y Y coordinate of the pixel
+ * @return The topmost job's pick ID, GFX_PICK_NONE if no tagged job covers
+ * the pixel
+ */
+unsigned int gfxDrawPickPresented(signed short x, signed short y);
+
+/** @} */
+#endif // __GFX_PICK_H__
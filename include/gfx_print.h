@@ -50,16 +50,16 @@
  * @name Safe print configuration default values
  *
  * Allows for the configuration of each print messages length and the number
- * of print messages that FreeRTOS can buffer
+ * of print messages that can be buffered. Messages are formatted directly
+ * into one of the SAFE_PRINT_INPUT_BUFFER_COUNT input slots and written out
+ * from there by the print task, all pending messages being written with a
+ * single write per output stream.
  *
  * @{
  */
-#ifndef SAFE_PRINT_QUEUE_LEN
-#define SAFE_PRINT_QUEUE_LEN 20
-#endif // SAFE_PRINT_QUEUE_LEN
 #ifndef SAFE_PRINT_MAX_MSG_LEN
 #define SAFE_PRINT_MAX_MSG_LEN 256
-#endif // SAFE_PRINT_QUEUE_LEN
+#endif // SAFE_PRINT_MAX_MSG_LEN
 #ifndef SAFE_PRINT_STACK_SIZE
 #define SAFE_PRINT_STACK_SIZE (SAFE_PRINT_MAX_MSG_LEN * 2)
 #endif // SAFE_PRINT_STACK_SIZE
@@ -67,17 +67,149 @@
 #define SAFE_PRINT_PRIORITY tskIDLE_PRIORITY
 #endif // SAFE_PRINT_PRIORITY
 #ifndef SAFE_PRINT_INPUT_BUFFER_COUNT
-#define SAFE_PRINT_INPUT_BUFFER_COUNT 10
+#define SAFE_PRINT_INPUT_BUFFER_COUNT 16 // Must be a power of two
 #endif // SAFE_PRINT_INPUT_BUFFER_COUNT
 //Uncomment to embed print debug ID's into messages
 // #define SAFE_PRINT_DEBUG
 /** @} */
 
+/**
+ * @name Print levels
+ *
+ * Messages printed through PRINT_ERROR(), PRINT_WARNING(), PRINT_INFO() and
+ * PRINT_DEBUG() carry one of these levels. Levels above
+ * SAFE_PRINT_COMPILE_LEVEL are removed at compile time, levels above the
+ * runtime level set with gfxSafePrintSetLevel() are skipped before any
+ * formatting is done.
+ *
+ * Errors are written to stderr directly by the calling thread, as they were
+ * before levels were introduced. They are neither rate limited nor buffered,
+ * such that they are not lost when the program exits right after printing
+ * them, and PRINT_ERROR() may be used from threads that are not FreeRTOS
+ * tasks. The other levels go through the print task.
+ *
+ * @{
+ */
+#define SAFE_PRINT_LEVEL_NONE 0
+#define SAFE_PRINT_LEVEL_ERROR 1
+#define SAFE_PRINT_LEVEL_WARNING 2
+#define SAFE_PRINT_LEVEL_INFO 3
+#define SAFE_PRINT_LEVEL_DEBUG 4
+/** @} */
+
+/**
+ * @name Print level and rate limit configuration default values
+ *
+ * Each PRINT_WARNING(), PRINT_INFO() and PRINT_DEBUG() call site owns a
+ * token bucket holding up to SAFE_PRINT_RATE_BURST messages that is refilled
+ * at SAFE_PRINT_RATE_PER_SEC messages per second. Messages printed from a
+ * call site whose bucket is empty are suppressed and counted, the count being
+ * reported with the next message from that site that is printed. A rate of 0
+ * disables rate limiting.
+ *
+ * @{
+ */
+#ifndef SAFE_PRINT_COMPILE_LEVEL
+#define SAFE_PRINT_COMPILE_LEVEL SAFE_PRINT_LEVEL_INFO
+#endif // SAFE_PRINT_COMPILE_LEVEL
+#ifndef SAFE_PRINT_DEFAULT_LEVEL
+#define SAFE_PRINT_DEFAULT_LEVEL SAFE_PRINT_COMPILE_LEVEL
+#endif // SAFE_PRINT_DEFAULT_LEVEL
+#ifndef SAFE_PRINT_RATE_BURST
+#define SAFE_PRINT_RATE_BURST 10
+#endif // SAFE_PRINT_RATE_BURST
+#ifndef SAFE_PRINT_RATE_PER_SEC
+#define SAFE_PRINT_RATE_PER_SEC 5
+#endif // SAFE_PRINT_RATE_PER_SEC
+/** @} */
+
+/**
+ * @brief Rate limiting state of a single print call site, instantiated
+ * statically by the PRINT_XXX macros
+ */
+typedef struct safe_print_site {
+    unsigned char lock;
+    unsigned char initialized;
+    unsigned long tokens; /**< Available messages, in thousandths */
+    unsigned long last_refill_ms;
+    unsigned long suppressed;
+} safe_print_site_t;
+
+/**
+ * @brief Current runtime print level, see gfxSafePrintSetLevel()
+ */
+extern int safe_print_level;
+
+/**
+ * @brief Prints a message of a given level from a rate limited call site
+ *
+ * @param level One of the SAFE_PRINT_LEVEL_XXX levels
+ * @param tag String literal prepended to the message, eg. "[ERROR]"
+ * @param msg Formatting string literal of the message
+ */
+#define PRINT_LEVEL(level, tag, msg, ...)                                      \
+    do {                                                                   \
+        if ((level) <= __atomic_load_n(&safe_print_level,              \
+                                       __ATOMIC_RELAXED)) {            \
+            static safe_print_site_t _print_site;                      \
+            long _suppressed = gfxSafePrintSiteAllow(&_print_site);    \
+            if (_suppressed == 0)                                      \
+                fprints(stderr, tag " " msg "    @-> %s:%d, %s\n",   \
+                        ##__VA_ARGS__, __FILE__, __LINE__, __func__);  \
+            else if (_suppressed > 0)                                  \
+                fprints(stderr,                                        \
+                        tag " " msg "    @-> %s:%d, %s"              \
+                        " (%ld suppressed)\n",                        \
+                        ##__VA_ARGS__, __FILE__, __LINE__, __func__,   \
+                        _suppressed);                                  \
+        }                                                              \
+    } while (0)
+
+#if SAFE_PRINT_COMPILE_LEVEL >= SAFE_PRINT_LEVEL_ERROR
 #define PRINT_ERROR(msg, ...)                                                  \
-    fprintf(stderr, "[ERROR] " msg, ##__VA_ARGS__);                        \
-    fprintf(stderr, "    @-> %s:%d, %s\n", __FILE__, __LINE__, __func__)
+    do {                                                                   \
+        if (SAFE_PRINT_LEVEL_ERROR <=                                      \
+            __atomic_load_n(&safe_print_level, __ATOMIC_RELAXED))          \
+            fprintf(stderr, "[ERROR] " msg "    @-> %s:%d, %s\n",          \
+                    ##__VA_ARGS__, __FILE__, __LINE__, __func__);          \
+    } while (0)
+#else
+#define PRINT_ERROR(msg, ...) do { } while (0)
+#endif // SAFE_PRINT_LEVEL_ERROR
+#if SAFE_PRINT_COMPILE_LEVEL >= SAFE_PRINT_LEVEL_WARNING
+#define PRINT_WARNING(msg, ...)                                                \
+    PRINT_LEVEL(SAFE_PRINT_LEVEL_WARNING, "[WARNING]", msg, ##__VA_ARGS__)
+#else
+#define PRINT_WARNING(msg, ...) do { } while (0)
+#endif // SAFE_PRINT_LEVEL_WARNING
+#if SAFE_PRINT_COMPILE_LEVEL >= SAFE_PRINT_LEVEL_INFO
+#define PRINT_INFO(msg, ...)                                                   \
+    PRINT_LEVEL(SAFE_PRINT_LEVEL_INFO, "[INFO]", msg, ##__VA_ARGS__)
+#else
+#define PRINT_INFO(msg, ...) do { } while (0)
+#endif // SAFE_PRINT_LEVEL_INFO
+#if SAFE_PRINT_COMPILE_LEVEL >= SAFE_PRINT_LEVEL_DEBUG
+#define PRINT_DEBUG(msg, ...)                                                  \
+    PRINT_LEVEL(SAFE_PRINT_LEVEL_DEBUG, "[DEBUG]", msg, ##__VA_ARGS__)
+#else
+#define PRINT_DEBUG(msg, ...) do { } while (0)
+#endif // SAFE_PRINT_LEVEL_DEBUG
+
 #define PRINT_TASK_ERROR(task) PRINT_ERROR("Failed to print task ##task");
 
+/**
+ * @brief Statistics kept by the safe print module, retrieved using
+ * gfxSafePrintGetStats()
+ */
+typedef struct gfx_print_stats {
+    unsigned long printed; /**< Messages written to their stream */
+    unsigned long dropped; /**< Messages dropped as all input slots were
+                                in use */
+    unsigned long truncated; /**< Messages cut to SAFE_PRINT_MAX_MSG_LEN */
+    unsigned long writes; /**< Write system calls made by the print task */
+    unsigned long suppressed; /**< Messages suppressed by rate limiting */
+} gfx_print_stats_t;
+
 /**
  * @brief Prints a formatted string to the specifed IO stream
  *
@@ -105,6 +237,46 @@ int gfxSafePrintInit(void);
  */
 void gfxSafePrintExit(void);
 
+/**
+ * @brief Sets the runtime print level, messages with a level above the
+ * runtime level are skipped without being formatted
+ *
+ * Levels above SAFE_PRINT_COMPILE_LEVEL have been compiled out and cannot be
+ * enabled at runtime.
+ *
+ * @param level One of the SAFE_PRINT_LEVEL_XXX levels
+ */
+void gfxSafePrintSetLevel(int level);
+
+/**
+ * @brief Retrieves the current runtime print level
+ *
+ * @return The current SAFE_PRINT_LEVEL_XXX runtime level
+ */
+int gfxSafePrintGetLevel(void);
+
+/**
+ * @brief Checks a call site's token bucket, used by PRINT_LEVEL()
+ *
+ * @param site Reference to the call site's rate limiting state
+ * @return -1 if the message is to be suppressed, otherwise the number of
+ * messages from the site that were suppressed since it last printed
+ */
+long gfxSafePrintSiteAllow(safe_print_site_t *site);
+
+/**
+ * @brief Retrieves a copy of the print module's statistics
+ *
+ * @param stats Reference to the structure where the statistics should be
+ * stored
+ */
+void gfxSafePrintGetStats(gfx_print_stats_t *stats);
+
+/**
+ * @brief Resets all of the print module's statistics to zero
+ */
+void gfxSafePrintResetStats(void);
+
 /** @} */
 
 #endif // __GFX_PRINT_H__
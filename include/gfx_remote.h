@@ -0,0 +1,181 @@
+/**
+ * @file gfx_remote.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Shared memory frame channel between the emulator and a viewer
+ * process
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_REMOTE_H__
+#define __GFX_REMOTE_H__
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * @defgroup gfx_remote GFX Remote API
+ *
+ * @brief Passes frames from the emulator to a viewer process on the same host
+ *
+ * The emulator listens on a Unix socket. For each viewer that connects it
+ * creates a ring buffer in shared memory and passes it to the viewer over
+ * the socket. Frames are then copied into the ring by the emulator and read
+ * in place by the viewer, the socket only carries a wake-up byte per frame
+ * and tells either side when the other has gone away. A viewer can thus be
+ * restarted at any time, the emulator never blocks on it.
+ *
+ * The ring has a single producer and a single consumer. Frames that do not
+ * fit into the ring, as the viewer fell behind, are dropped.
+ *
+ * Small messages, such as input events, can be sent back from the viewer to
+ * the emulator over the socket.
+ *
+ * @{
+ */
+
+/**
+ * @brief Default size, in bytes, of the ring buffer created for each viewer
+ */
+#ifndef GFX_REMOTE_RING_SIZE
+#define GFX_REMOTE_RING_SIZE (4 * 1024 * 1024)
+#endif // GFX_REMOTE_RING_SIZE
+
+/**
+ * @brief A handle to either end of a frame channel
+ */
+typedef void *gfx_remote_handle_t;
+
+/**
+ * @brief Outcome of gfxRemoteSendFrame()
+ */
+enum gfx_remote_status {
+    GFX_REMOTE_SENT, /**< The frame was queued for the viewer */
+    GFX_REMOTE_DROPPED, /**< The ring was too full, the frame was dropped */
+    GFX_REMOTE_NO_VIEWER, /**< No viewer is connected */
+};
+
+/**
+ * @brief Creates the emulator's end of a channel, listening on a Unix socket
+ *
+ * A stale socket file at the given path is removed.
+ *
+ * @param socket_path Path of the Unix socket
+ * @param ring_size Size, in bytes, of the ring created for each viewer,
+ * rounded up to the next power of two
+ * @return Handle to the channel, NULL on failure
+ */
+gfx_remote_handle_t gfxRemoteListen(const char *socket_path, size_t ring_size);
+
+/**
+ * @brief Accepts a waiting viewer and notices a viewer that went away
+ *
+ * Never blocks, meant to be called once per frame before the frame is
+ * encoded.
+ *
+ * @param remote Handle returned by gfxRemoteListen()
+ * @return 1 if a new viewer was connected, which has none of the state sent
+ * to a previous viewer, 0 if not, -1 on error
+ */
+int gfxRemoteAccept(gfx_remote_handle_t remote);
+
+/**
+ * @brief Copies a frame into the ring of the connected viewer
+ *
+ * @param remote Handle returned by gfxRemoteListen()
+ * @param frame Frame to be sent
+ * @param size Size of the frame in bytes
+ * @return Whether the frame was sent, see gfx_remote_status
+ */
+enum gfx_remote_status gfxRemoteSendFrame(gfx_remote_handle_t remote,
+        const void *frame, size_t size);
+
+/**
+ * @brief Receives a message sent by the viewer using gfxRemoteSendMessage()
+ *
+ * Never blocks.
+ *
+ * @param remote Handle returned by gfxRemoteListen()
+ * @param msg Buffer the message is stored in
+ * @param size Size of the buffer, longer messages are truncated
+ * @return Length of the message, 0 if there is none, -1 on error
+ */
+ssize_t gfxRemoteReceiveMessage(gfx_remote_handle_t remote, void *msg,
+                                size_t size);
+
+/**
+ * @brief Creates the viewer's end of a channel by connecting to an emulator
+ *
+ * @param socket_path Path of the Unix socket the emulator listens on
+ * @return Handle to the channel, NULL if no emulator could be connected to
+ */
+gfx_remote_handle_t gfxRemoteConnect(const char *socket_path);
+
+/**
+ * @brief Waits for the next frame
+ *
+ * The frame is read in place and stays valid until it is released using
+ * gfxRemoteReleaseFrame().
+ *
+ * @param remote Handle returned by gfxRemoteConnect()
+ * @param frame Reference to where a pointer to the frame is stored
+ * @param size Reference to where the size of the frame is stored
+ * @param timeout_ms Milliseconds to wait for a frame, -1 to wait forever
+ * @return 1 if a frame was received, 0 on timeout, -1 if the emulator went
+ * away
+ */
+int gfxRemoteReceiveFrame(gfx_remote_handle_t remote, void **frame,
+                          size_t *size, int timeout_ms);
+
+/**
+ * @brief Sends a message to the emulator
+ *
+ * The message is dropped if the emulator has not read the previous ones.
+ *
+ * @param remote Handle returned by gfxRemoteConnect()
+ * @param msg Message to be sent
+ * @param size Length of the message
+ * @return 0 on success, -1 if the message was dropped
+ */
+int gfxRemoteSendMessage(gfx_remote_handle_t remote, const void *msg,
+                         size_t size);
+
+/**
+ * @brief Checks if another frame is queued behind the received frame
+ *
+ * @param remote Handle returned by gfxRemoteConnect()
+ * @return 1 if another frame is queued, 0 otherwise
+ */
+unsigned char gfxRemoteFramePending(gfx_remote_handle_t remote);
+
+/**
+ * @brief Returns the space of the received frame to the emulator
+ *
+ * @param remote Handle returned by gfxRemoteConnect()
+ */
+void gfxRemoteReleaseFrame(gfx_remote_handle_t remote);
+
+/**
+ * @brief Closes either end of a channel
+ *
+ * @param remote Handle to be closed
+ */
+void gfxRemoteClose(gfx_remote_handle_t remote);
+
+/** @} */
+#endif // __GFX_REMOTE_H__
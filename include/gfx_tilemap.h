@@ -0,0 +1,157 @@
+/**
+ * @file gfx_tilemap.h
+ * @author Alex Hoffman
+ * @date 18 October 2026
+ * @brief Grids of spritesheet cells drawn from cached chunks
+ *
+ * @verbatim
+ ----------------------------------------------------------------------
+ Copyright (C) Alexander Hoffman, 2019
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ----------------------------------------------------------------------
+ @endverbatim
+ */
+
+#ifndef __GFX_TILEMAP_H__
+#define __GFX_TILEMAP_H__
+
+/**
+ * @defgroup gfx_tilemap GFX Tilemap API
+ *
+ * @brief Draws large grids of spritesheet cells
+ *
+ * Tilemaps are drawn through the same job queue as the rest of
+ * @ref gfx_draw, this header is included by gfx_draw.h once the spritesheet
+ * handle is declared.
+ *
+ * @{
+ */
+
+/**
+ * @brief Handle used to reference a tilemap, an invalid tilemap will have a
+ * NULL handle
+ *
+ * A tilemap is a 2D grid of spritesheet cell indices that is drawn as a
+ * whole, see gfxDrawTilemapDraw().
+ */
+typedef void *gfx_tilemap_handle_t;
+
+/**
+ * @brief Tile index of a tilemap tile that has no sprite
+ */
+#define GFX_TILEMAP_EMPTY 0xFFFFFFFF
+
+/**
+ * @brief Width and height, in tiles, of the chunks a tilemap is pre-rendered
+ * in
+ */
+#ifndef GFX_TILEMAP_CHUNK_TILES
+#define GFX_TILEMAP_CHUNK_TILES 16
+#endif // GFX_TILEMAP_CHUNK_TILES
+
+/**
+ * @brief Maximum number of animated tiles that can be registered on a
+ * tilemap, see gfxDrawTilemapAnimateTile()
+ */
+#ifndef GFX_TILEMAP_MAX_ANIMATIONS
+#define GFX_TILEMAP_MAX_ANIMATIONS 16
+#endif // GFX_TILEMAP_MAX_ANIMATIONS
+
+/**
+ * @brief Creates a tilemap drawn from the cells of a spritesheet
+ *
+ * Each tile of the map holds the index of a spritesheet cell, see
+ * gfxDrawSpriteIndex(). The map is split into chunks of
+ * GFX_TILEMAP_CHUNK_TILES x GFX_TILEMAP_CHUNK_TILES tiles which are rendered
+ * once into cached textures. Drawing the map then only copies the chunks that
+ * are visible on screen, chunks are only rendered again once one of their
+ * tiles changes. All tiles are initially GFX_TILEMAP_EMPTY.
+ *
+ * @param spritesheet Spritesheet containing the tiles' sprites
+ * @param cols Width of the map, in tiles
+ * @param rows Height of the map, in tiles
+ * @return A handle to the created tilemap, NULL otherwise
+ */
+gfx_tilemap_handle_t gfxDrawTilemapCreate(gfx_spritesheet_handle_t spritesheet,
+                                          unsigned cols, unsigned rows);
+
+/**
+ * @brief Deletes a tilemap
+ *
+ * The tilemap's cached chunks are released by gfxDrawUpdateScreen() once all
+ * previously queued draws of the map have been handled. The handle must not be
+ * used after this call.
+ *
+ * @param tilemap The tilemap to be deleted
+ * @return 0 on success
+ */
+int gfxDrawTilemapDelete(gfx_tilemap_handle_t tilemap);
+
+/**
+ * @brief Sets the sprite shown by a tile of a tilemap
+ *
+ * Only the chunk containing the tile is rendered again on the next draw.
+ *
+ * @param tilemap The tilemap holding the tile
+ * @param col Column of the tile
+ * @param row Row of the tile
+ * @param index Spritesheet cell index to be shown, or GFX_TILEMAP_EMPTY
+ * @return 0 on success
+ */
+int gfxDrawTilemapSetTile(gfx_tilemap_handle_t tilemap, unsigned col,
+                          unsigned row, unsigned index);
+
+/**
+ * @brief Returns the sprite shown by a tile of a tilemap
+ *
+ * @param tilemap The tilemap holding the tile
+ * @param col Column of the tile
+ * @param row Row of the tile
+ * @return The tile's spritesheet cell index, GFX_TILEMAP_EMPTY if the tile is
+ * empty or invalid
+ */
+unsigned gfxDrawTilemapGetTile(gfx_tilemap_handle_t tilemap, unsigned col,
+                               unsigned row);
+
+/**
+ * @brief Animates all tiles of a tilemap showing a given sprite
+ *
+ * Tiles set to the index cycle through the cells index to
+ * index + frames - 1, advancing every frame_period_ms of frame clock time.
+ * Animated tiles are not part of the cached chunks and are instead drawn on
+ * top of them every frame.
+ *
+ * @param tilemap The tilemap whose tiles are to be animated
+ * @param index Spritesheet cell index of the animation's first frame
+ * @param frames Number of consecutive cells that make up the animation
+ * @param frame_period_ms The number of milliseconds that should transpire
+ * between sprite frames
+ * @return 0 on success
+ */
+int gfxDrawTilemapAnimateTile(gfx_tilemap_handle_t tilemap, unsigned index,
+                              unsigned frames, unsigned frame_period_ms);
+
+/**
+ * @brief Draws a tilemap
+ *
+ * Only the chunks of the map that are visible on the screen are drawn,
+ * scrolling the map is done by changing its location.
+ *
+ * @param tilemap The tilemap to be drawn
+ * @param x The X axis location, in pixels, of the map's top left corner
+ * @param y The Y axis location, in pixels, of the map's top left corner
+ * @return 0 on success
+ */
+int gfxDrawTilemapDraw(gfx_tilemap_handle_t tilemap, int x, int y);
+
+/** @} */
+#endif // __GFX_TILEMAP_H__
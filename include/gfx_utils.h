@@ -24,6 +24,7 @@
 #ifndef __GFX_UTILS_H__
 #define __GFX_UTILS_H__
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -31,15 +32,250 @@
  * @brief Checks if the calling thread is the thread that currently holds the
  * GL context
  *
+ * The check is a thread local and an atomic load, it takes no lock and makes
+ * no system call.
+ *
  * @return 0 if the current thread does hold the GL context, -1 otherwise.
  */
 int gfxUtilIsCurGLThread(void);
 
 /**
  * @brief The calling thread is registered as holding the current GL context
+ *
+ * Any thread that previously held the GL context no longer passes
+ * gfxUtilIsCurGLThread().
  */
 void gfxUtilSetGLThread(void);
 
+/**
+ * @name Lock profiling
+ *
+ * When GFX_LOCK_PROFILING is set to 1 the library's internal locks record
+ * how often they were acquired, how often an acquisition found the lock
+ * already held and histograms of the time spent waiting for and holding each
+ * lock. The results can be printed with gfxUtilLockStatsReport(). When
+ * disabled the lock macros compile to the plain pthread and FreeRTOS calls.
+ *
+ * Histogram bucket 0 counts durations below 1us, bucket n counts durations
+ * of [2^(n-1), 2^n) us and the last bucket all longer durations.
+ *
+ * @{
+ */
+#ifndef GFX_LOCK_PROFILING
+#define GFX_LOCK_PROFILING 0
+#endif // GFX_LOCK_PROFILING
+
+#define GFX_LOCK_HIST_BUCKETS 16
+
+/**
+ * @brief Statistics recorded for a single profiled lock
+ */
+typedef struct gfx_lock_stats {
+    const char *name; /**< Name shown in the report */
+    unsigned long acquisitions; /**< Successful acquisitions */
+    unsigned long contended; /**< Acquisitions that found the lock held */
+    unsigned long failed; /**< Acquisitions that timed out */
+    unsigned long long wait_ns; /**< Total time spent waiting */
+    unsigned long long max_wait_ns; /**< Longest wait */
+    unsigned long long hold_ns; /**< Total time the lock was held */
+    unsigned long long max_hold_ns; /**< Longest hold */
+    unsigned long wait_hist[GFX_LOCK_HIST_BUCKETS];
+    unsigned long hold_hist[GFX_LOCK_HIST_BUCKETS];
+
+    unsigned long long acquired_at;
+    unsigned char registered;
+    struct gfx_lock_stats *next;
+} gfx_lock_stats_t;
+
+#if (GFX_LOCK_PROFILING == 1)
+#define GFX_LOCK_STATS(STATS, NAME) gfx_lock_stats_t STATS = { .name = NAME }
+#define GFX_MUTEX_LOCK(MUTEX, STATS) gfxUtilProfMutexLock(MUTEX, &STATS)
+#define GFX_MUTEX_UNLOCK(MUTEX, STATS) gfxUtilProfMutexUnlock(MUTEX, &STATS)
+#define GFX_SEMAPHORE_TAKE(SEM, TICKS, STATS)                                  \
+    gfxUtilProfSemaphoreTake(SEM, TICKS, &STATS)
+#define GFX_SEMAPHORE_GIVE(SEM, STATS) gfxUtilProfSemaphoreGive(SEM, &STATS)
+#else
+#define GFX_LOCK_STATS(STATS, NAME) extern gfx_lock_stats_t STATS
+#define GFX_MUTEX_LOCK(MUTEX, STATS) pthread_mutex_lock(MUTEX)
+#define GFX_MUTEX_UNLOCK(MUTEX, STATS) pthread_mutex_unlock(MUTEX)
+#define GFX_SEMAPHORE_TAKE(SEM, TICKS, STATS) xSemaphoreTake(SEM, TICKS)
+#define GFX_SEMAPHORE_GIVE(SEM, STATS) xSemaphoreGive(SEM)
+#endif // GFX_LOCK_PROFILING
+/** @} */
+
+/**
+ * @brief Locks a pthread mutex, recording its statistics, use GFX_MUTEX_LOCK
+ *
+ * @param mutex Mutex to be locked
+ * @param stats Statistics of the mutex
+ * @return Return value of pthread_mutex_lock()
+ */
+int gfxUtilProfMutexLock(pthread_mutex_t *mutex, gfx_lock_stats_t *stats);
+
+/**
+ * @brief Unlocks a pthread mutex, recording its statistics, use
+ * GFX_MUTEX_UNLOCK
+ *
+ * @param mutex Mutex to be unlocked
+ * @param stats Statistics of the mutex
+ * @return Return value of pthread_mutex_unlock()
+ */
+int gfxUtilProfMutexUnlock(pthread_mutex_t *mutex, gfx_lock_stats_t *stats);
+
+/**
+ * @brief Takes a FreeRTOS semaphore, recording its statistics, use
+ * GFX_SEMAPHORE_TAKE
+ *
+ * @param sem SemaphoreHandle_t of the semaphore to be taken
+ * @param ticks Ticks to wait for the semaphore
+ * @param stats Statistics of the semaphore
+ * @return pdTRUE if the semaphore was taken, otherwise pdFALSE
+ */
+long gfxUtilProfSemaphoreTake(void *sem, unsigned long ticks,
+                              gfx_lock_stats_t *stats);
+
+/**
+ * @brief Gives a FreeRTOS semaphore, recording its statistics, use
+ * GFX_SEMAPHORE_GIVE
+ *
+ * @param sem SemaphoreHandle_t of the semaphore to be given
+ * @param stats Statistics of the semaphore
+ * @return Return value of xSemaphoreGive()
+ */
+long gfxUtilProfSemaphoreGive(void *sem, gfx_lock_stats_t *stats);
+
+/**
+ * @brief Prints the statistics of all profiled locks that have been used
+ *
+ * @param file Open file to which the report should be written
+ */
+void gfxUtilLockStatsReport(FILE *file);
+
+/**
+ * @brief Resets the statistics of all profiled locks
+ */
+void gfxUtilLockStatsReset(void);
+
+/**
+ * @name Memory accounting
+ *
+ * The library accounts for the memory held by the resources it creates, by
+ * category. Texture sizes are derived from their pixel format and
+ * dimensions, textures that are created and destroyed within a single draw
+ * are not accounted for. Fonts are accounted for by the size of their font
+ * file.
+ *
+ * @{
+ */
+
+/**
+ * @brief Categories of accounted memory
+ */
+enum gfx_mem_category {
+    GFX_MEM_TEXTURES, /**< Textures kept across frames */
+    GFX_MEM_SURFACES, /**< Surfaces retained by loaded images */
+    GFX_MEM_FONTS, /**< Opened fonts */
+    GFX_MEM_SAMPLES, /**< Loaded sound samples */
+    GFX_MEM_JOBS, /**< Queued draw jobs */
+    GFX_MEM_CATEGORY_COUNT,
+};
+
+/**
+ * @brief Snapshot of the accounted memory
+ */
+typedef struct gfx_mem_stats {
+    size_t bytes[GFX_MEM_CATEGORY_COUNT]; /**< Bytes currently held */
+    size_t peak[GFX_MEM_CATEGORY_COUNT]; /**< Most bytes ever held */
+    size_t total; /**< Bytes currently held across all categories */
+} gfx_mem_stats_t;
+
+/**
+ * @brief Accounts for memory that was acquired
+ *
+ * @param category Category of the memory
+ * @param bytes Number of bytes acquired
+ */
+void gfxUtilMemAdd(enum gfx_mem_category category, size_t bytes);
+
+/**
+ * @brief Accounts for memory that was released
+ *
+ * @param category Category of the memory
+ * @param bytes Number of bytes released
+ */
+void gfxUtilMemSub(enum gfx_mem_category category, size_t bytes);
+
+/**
+ * @brief Retrieves the bytes currently held across all categories
+ *
+ * @return Number of accounted bytes
+ */
+size_t gfxUtilMemTotal(void);
+
+/**
+ * @brief Retrieves a snapshot of the accounted memory
+ *
+ * @param stats Reference to where the snapshot is stored
+ */
+void gfxUtilMemStatsGet(gfx_mem_stats_t *stats);
+
+/**
+ * @brief Prints the accounted memory of each category
+ *
+ * @param file Open file to which the report should be written
+ */
+void gfxUtilMemStatsReport(FILE *file);
+/** @} */
+
+/**
+ * @name Startup profiling
+ *
+ * The library times the phases of its initialisation, such as SDL and font
+ * initialisation, window creation and resource indexing. Applications can
+ * time their own initialisation alongside. Phases may be recorded from any
+ * thread, the report lists the thread that recorded each phase such that
+ * phases that ran in parallel can be told apart.
+ *
+ * @{
+ */
+
+/**
+ * @brief Maximum number of phases that are recorded, further phases are not
+ * timed
+ */
+#ifndef GFX_INIT_PHASES_MAX
+#define GFX_INIT_PHASES_MAX 32
+#endif // GFX_INIT_PHASES_MAX
+
+/**
+ * @brief Starts timing a phase of the initialisation
+ *
+ * @param name Name of the phase, must stay valid until the report is printed
+ * @return The phase to be passed to gfxUtilInitPhaseEnd(), -1 if
+ * GFX_INIT_PHASES_MAX phases were already recorded
+ */
+int gfxUtilInitPhaseBegin(const char *name);
+
+/**
+ * @brief Stops timing a phase of the initialisation
+ *
+ * @param phase Phase returned by gfxUtilInitPhaseBegin()
+ */
+void gfxUtilInitPhaseEnd(int phase);
+
+/**
+ * @brief Prints the start and duration of each recorded phase, relative to
+ * the start of the first phase
+ *
+ * Besides the phases the report gives the wall clock time from the start of
+ * the first to the end of the last phase and the sum of all phase durations,
+ * the difference being the time saved by running phases in parallel.
+ *
+ * @param file Open file to which the report should be written
+ */
+void gfxUtilInitReport(FILE *file);
+/** @} */
+
 /**
  * @brief Prepends a path string to a filename
  *
@@ -58,6 +294,15 @@ char *gfxUtilPrependPath(const char *path, char *file);
  */
 char *gfxUtilGetBinFolderPath(char *bin_path);
 
+/**
+ * @brief Searches the resource directory and indexes the files within
+ *
+ * Done once, on the first call to this function or to any of the functions
+ * finding resources. Can be called from a worker thread to take the search
+ * off the thread that later looks up resources.
+ */
+void gfxUtilIndexResources(void);
+
 /**
  * @brief Returns the lopcation of the resource directory
  *
@@ -79,35 +324,123 @@ FILE *gfxUtilFindResource(char *resource_name, const char *mode);
  * @brief Similar to gfxUtilFindResource() only returning the file's path instead
  * of the opened FILE's reference.
  *
- * The found filename is stored in a statically allocated buffer and can be
- * overwritten by subsequent calls to the functions
+ * Resources are looked up in the index built by gfxUtilIndexResources(), the
+ * returned path stays valid for the lifetime of the program and the function
+ * can be called from any thread.
  *
  * @param resource_name Name of the file to be found
- * @return Reference to the statically allocated filename, else NULL
+ * @return Reference to the found path, else NULL
  */
 char *gfxUtilFindResourcePath(char *resource_name);
 
+/**
+ * @name Resource watching
+ *
+ * An opt-in watcher that is told by the kernel (inotify) when files in the
+ * resource directory are written or moved into place, and passes each
+ * changed file to the registered listeners. The gfx_draw, gfx_font and
+ * gfx_sound backends register listeners that reload the images, fonts and
+ * samples loaded from a changed file into their existing handles.
+ *
+ * Listeners are called from the watching thread. Files are matched by file
+ * name, as when they are looked up using gfxUtilFindResourcePath().
+ *
+ * @{
+ */
+
+/**
+ * @brief Maximum number of listeners that can be added using
+ * gfxUtilAddResourceListener()
+ */
+#ifndef GFX_RESOURCE_LISTENERS_MAX
+#define GFX_RESOURCE_LISTENERS_MAX 8
+#endif // GFX_RESOURCE_LISTENERS_MAX
+
+/**
+ * @brief Adds a function to be called for each changed resource file
+ *
+ * @param changed Function called with the file name and the path of the
+ * changed file
+ * @return 0 on success, -1 if GFX_RESOURCE_LISTENERS_MAX listeners were
+ * already added
+ */
+int gfxUtilAddResourceListener(void (*changed)(const char *name,
+                               const char *path));
+
+/**
+ * @brief Starts watching the resource directory and its sub-directories
+ *
+ * @return 0 on success
+ */
+int gfxUtilWatchResources(void);
+
+/**
+ * @brief Stops watching the resource directory
+ */
+void gfxUtilUnwatchResources(void);
+/** @} */
+
 /**
  * @brief A handle to a ring buffer object, created using gfxRbufInit()
+ *
+ * Ring buffers hold a power of two number of fixed size items and come in two
+ * lock-free variants. Buffers created with gfxRbufInit() and
+ * gfxRbufInitStatic() can be used by any number of producers and consumers,
+ * buffers created with gfxRbufInitSPSC() and gfxRbufInitSPSCStatic() are
+ * cheaper but must only ever be used by a single producer and a single
+ * consumer.
+ *
+ * Items can either be copied in and out using gfxRbufPut() and gfxRbufGet(),
+ * or filled and consumed in place. In place filling is done by claiming a
+ * slot with gfxRbufGetBuffer() and publishing it with gfxRbufPutBuffer().
+ * In place consumption is done with gfxRbufPeekBuffer() and
+ * gfxRbufReleaseBuffer() and is limited to a single consumer.
+ *
+ * Runs of slots can be handled in place using gfxRbufReserve() and
+ * gfxRbufCommit() on the producer side and gfxRbufPeek() and gfxRbufRelease()
+ * on the consumer side. These hand out the slots as at most two contiguous
+ * spans, the run being split in two where it wraps around the end of the
+ * buffer.
  */
 typedef void *rbuf_handle_t;
 
 /**
- * @brief Initialized a ring buffer object with a certain number of objects
- * of a given size
+ * @brief A run of contiguous ring buffer slots
+ */
+typedef struct rbuf_span {
+    void *data; /**< Reference to the first slot of the span */
+    size_t count; /**< Number of slots in the span */
+} rbuf_span_t;
+
+/**
+ * @brief Slots reserved by a producer using gfxRbufReserve()
+ */
+typedef struct rbuf_reservation {
+    rbuf_span_t spans[2]; /**< Reserved slots, the second span is only used
+                               if the run wraps around */
+    size_t count; /**< Number of slots still reserved */
+    size_t pos; /**< Internal position of the first reserved slot */
+} rbuf_reservation_t;
+
+/**
+ * @brief Initialized a multi-producer multi-consumer ring buffer object with
+ * a certain number of objects of a given size
  *
  * @param item_size The size, in bytes, of each ring buffer item
- * @param item_count The maximum number of items to be stored in the ring buffer
+ * @param item_count The maximum number of items to be stored in the ring
+ * buffer, rounded up to the next power of two of at least two
  * @return A handle to the created ring buffer, else NULL
  */
 rbuf_handle_t gfxRbufInit(size_t item_size, size_t item_count);
 
 /**
- * @brief Initialized a ring buffer object with a certain number of objects
- * of a given size into a statically allocated buffer
+ * @brief Initialized a multi-producer multi-consumer ring buffer object with
+ * a certain number of objects of a given size into a statically allocated
+ * buffer
  *
  * @param item_size The size, in bytes, of each ring buffer item
- * @param item_count The maximum number of items to be stored in the ring buffer
+ * @param item_count The maximum number of items to be stored in the ring
+ * buffer, must be a power of two of at least two
  * @param buffer Reference to the statically allocated memory region that is
  * to be used for storing the ring buffer
  * @return A handle to the created ring buffer, else NULL
@@ -115,27 +448,55 @@ rbuf_handle_t gfxRbufInit(size_t item_size, size_t item_count);
 rbuf_handle_t gfxRbufInitStatic(size_t item_size, size_t item_count, void *buffer);
 
 /**
- * @brief Frees a ring buffer
+ * @brief Initialized a single-producer single-consumer ring buffer object
+ * with a certain number of objects of a given size
+ *
+ * @param item_size The size, in bytes, of each ring buffer item
+ * @param item_count The maximum number of items to be stored in the ring
+ * buffer, rounded up to the next power of two
+ * @return A handle to the created ring buffer, else NULL
+ */
+rbuf_handle_t gfxRbufInitSPSC(size_t item_size, size_t item_count);
+
+/**
+ * @brief Initialized a single-producer single-consumer ring buffer object
+ * with a certain number of objects of a given size into a statically
+ * allocated buffer
+ *
+ * @param item_size The size, in bytes, of each ring buffer item
+ * @param item_count The maximum number of items to be stored in the ring
+ * buffer, must be a power of two
+ * @param buffer Reference to the statically allocated memory region that is
+ * to be used for storing the ring buffer
+ * @return A handle to the created ring buffer, else NULL
+ */
+rbuf_handle_t gfxRbufInitSPSCStatic(size_t item_size, size_t item_count,
+                                    void *buffer);
+
+/**
+ * @brief Frees a ring buffer, statically allocated buffers are left untouched
  *
  * @param rbuf Handle to the ring buffer
  */
 void gfxRbufFree(rbuf_handle_t rbuf);
 
 /**
- * @brief Resets the ring buffer to it's initial state
+ * @brief Resets the ring buffer to it's initial state, must not be called
+ * while the ring buffer is in use
  *
  * @param rbuf Handle to the ring buffer
  */
 void gfxRbufReset(rbuf_handle_t rbuf);
 
 /**
- * @brief Used when a reference to the next buffer item is already filled,
- * incrementing the next buffer item should an item need to be retrieved
+ * @brief Publishes a slot that was claimed using gfxRbufGetBuffer() and has
+ * been filled, making it available to consumers
  *
  * @param rbuf Handle to the ring buffer
+ * @param buffer Reference returned by gfxRbufGetBuffer()
  * @return 0 on success
  */
-int gfxRbufPutBuffer(rbuf_handle_t rbuf);
+int gfxRbufPutBuffer(rbuf_handle_t rbuf, void *buffer);
 
 /**
  * @brief Fills the next available buffer slot, if a slot is free
@@ -150,6 +511,10 @@ int gfxRbufPut(rbuf_handle_t rbuf, void *data);
  * @brief Fills the next available buffer, overwriting data if the ring buffer
  * is full
  *
+ * Overwriting is done by discarding the oldest items, the caller thus also
+ * acts as a consumer. On single-producer single-consumer buffers this is only
+ * safe when the producer and consumer are the same thread.
+ *
  * @param rbuf Handle to the ring buffer
  * @param data Reference to the data to be copied into the buffer
  * @return 0 on success
@@ -157,26 +522,127 @@ int gfxRbufPut(rbuf_handle_t rbuf, void *data);
 int gfxRbufFPut(rbuf_handle_t rbuf, void *data);
 
 /**
- * @brief Returns a reference to the data of the next ring buffer entry
+ * @brief Copies up to count items into the ring buffer
  *
- * Because only a reference is returned the contents of the buffer entry
- * cannot be guarenteed
+ * @param rbuf Handle to the ring buffer
+ * @param data Reference to an array of count items
+ * @param count Number of items to be copied
+ * @return Number of items that were copied into the ring buffer
+ */
+size_t gfxRbufPutBatch(rbuf_handle_t rbuf, void *data, size_t count);
+
+/**
+ * @brief Claims the next free slot so that it can be filled in place
+ *
+ * The slot is not visible to consumers until it is published using
+ * gfxRbufPutBuffer(). Single-producer single-consumer buffers allow only one
+ * claimed slot at a time.
  *
  * @param rbuf Handle to the ring buffer
- * @return A reference to the next item in the buffer's data
+ * @return A reference to the claimed slot, NULL if the buffer is full
  */
 void *gfxRbufGetBuffer(rbuf_handle_t rbuf);
 
+/**
+ * @brief Returns a reference to a stored item without removing it from the
+ * ring buffer, allowing the consumer to process items in place
+ *
+ * Only published items are returned, a slot that has been claimed but not yet
+ * published ends the stored items. In place consumption requires that the
+ * ring buffer has a single consumer.
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param offset Position of the item relative to the oldest stored item, 0
+ * being the oldest item
+ * @return A reference to the item's data, NULL if fewer than offset + 1 items
+ * are stored
+ */
+void *gfxRbufPeekBuffer(rbuf_handle_t rbuf, size_t offset);
+
+/**
+ * @brief Removes the oldest items from the ring buffer once they have been
+ * consumed in place using gfxRbufPeekBuffer(), same as gfxRbufRelease()
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param count Number of items to be released
+ * @return 0 on success
+ */
+int gfxRbufReleaseBuffer(rbuf_handle_t rbuf, size_t count);
+
+/**
+ * @brief Reserves up to count free slots so that they can be filled in place
+ *
+ * Reserved slots are not visible to consumers until they are committed using
+ * gfxRbufCommit(). On multi-producer multi-consumer buffers every reserved
+ * slot must eventually be committed, as consumers wait on the slots in
+ * order. Single-producer single-consumer buffers allow only one reservation
+ * at a time and uncommitted slots are simply handed out again by the next
+ * reservation.
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param count Maximum number of slots to be reserved
+ * @param reservation Reference to where the reserved spans are stored
+ * @return Number of slots that were reserved
+ */
+size_t gfxRbufReserve(rbuf_handle_t rbuf, size_t count,
+                      rbuf_reservation_t *reservation);
+
+/**
+ * @brief Publishes the first count slots of a reservation to consumers
+ *
+ * The reservation is updated to hold the remaining slots, allowing a
+ * reservation to be committed in several steps.
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param reservation Reservation obtained from gfxRbufReserve()
+ * @param count Number of slots to be committed
+ * @return 0 on success
+ */
+int gfxRbufCommit(rbuf_handle_t rbuf, rbuf_reservation_t *reservation,
+                  size_t count);
+
+/**
+ * @brief Returns up to count of the oldest stored items without removing
+ * them from the ring buffer, requires that the buffer has a single consumer
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param count Maximum number of items to be returned
+ * @param spans Array of two spans where the items are returned, the second
+ * span is only used if the items wrap around
+ * @return Total number of items in the returned spans
+ */
+size_t gfxRbufPeek(rbuf_handle_t rbuf, size_t count, rbuf_span_t spans[2]);
+
+/**
+ * @brief Removes the oldest count items from the ring buffer after they have
+ * been consumed in place using gfxRbufPeek() or gfxRbufPeekBuffer()
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param count Number of items to be released
+ * @return 0 on success
+ */
+int gfxRbufRelease(rbuf_handle_t rbuf, size_t count);
+
 /**
  * @brief Returns a copy of the next buffer item's data
  *
  * @param rbuf Handle to the ring buffer
  * @param data A reference to the allocated memory region into which the data
- * should be copied
+ * should be copied, NULL to discard the item
  * @return 0 on success
  */
 int gfxRbufGet(rbuf_handle_t rbuf, void *data);
 
+/**
+ * @brief Copies up to count items out of the ring buffer
+ *
+ * @param rbuf Handle to the ring buffer
+ * @param data Reference to an array with space for count items
+ * @param count Maximum number of items to be retrieved
+ * @return Number of items that were retrieved
+ */
+size_t gfxRbufGetBatch(rbuf_handle_t rbuf, void *data, size_t count);
+
 /**
  * @brief Checks if the buffer is empty or not
  *